@@ -15,6 +15,7 @@
  */
 
 #include "abstractgraph.h"
+#include "compactedges.h"
 #include "constants.h"
 #include "edge_p.h"
 #include "node_p.h"
@@ -25,7 +26,8 @@ namespace evoplex {
 
 AbstractGraph::AbstractGraph()
     : m_lastNodeId(-1),
-      m_lastEdgeId(-1)
+      m_lastEdgeId(-1),
+      m_topology(std::make_shared<Topology>())
 {
 }
 
@@ -35,7 +37,6 @@ bool AbstractGraph::setup(Trial& trial, AttrsGeneratorPtr edgeGen,
     Q_ASSERT_X(nodes.size() < EVOPLEX_MAX_NODES, "setup", "too many nodes!");
     Q_ASSERT_X(!nodes.empty(), "setup", "set of nodes cannot be empty!");
     m_nodes = nodes;
-    m_numNodesDist = std::uniform_int_distribution<int>(0, numNodes()-1);
     m_lastNodeId = static_cast<int>(m_nodes.size());
     m_edgeAttrsGen = std::move(edgeGen);
     return AbstractPlugin::setup(trial, attrs);
@@ -51,17 +52,143 @@ GraphType AbstractGraph::type() const
     return m_trial->graphType();
 }
 
+void AbstractGraph::freezeTopology()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_compactEdges) {
+        return; // the edges are in the CSR view already
+    }
+    if (m_topology.use_count() > 1) {
+        m_topology = std::make_shared<Topology>();
+    }
+    m_topology->build(m_nodes, isDirected());
+}
+
+void AbstractGraph::clearTopology()
+{
+    if (m_compactEdges) {
+        thawEdges(true);
+    }
+    if (m_topology.use_count() > 1) {
+        m_topology = std::make_shared<Topology>();
+    } else {
+        m_topology->clear();
+    }
+}
+
+void AbstractGraph::compactEdges()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_compactEdges || !m_topology->isValid() || m_edgeAttrsGen) {
+        return;
+    }
+    for (auto const& p : m_edges) {
+        if (!p.second.attrs()->isEmpty()) {
+            return;
+        }
+    }
+
+    // the CSR view holds the whole topology; let's release the edges
+    m_compactEdges = std::make_shared<CompactEdges>(m_topology, m_nodes);
+    m_edges.clearEdges();
+    m_edges.setView(m_compactEdges.get(), -1, true);
+    for (int i = 0; i < numNodes(); ++i) {
+        BaseNode* node = m_nodes.atIndex(i).m_ptr.get();
+        node->m_outEdges.clearEdges();
+        node->m_outEdges.setView(m_compactEdges.get(), i, true);
+        if (isDirected()) {
+            Edges& inEdges = static_cast<DNode*>(node)->m_inEdges;
+            inEdges.clearEdges();
+            inEdges.setView(m_compactEdges.get(), i, false);
+        }
+    }
+    m_lastEdgeId = m_compactEdges->numEdges() - 1;
+}
+
+void AbstractGraph::thawEdges(bool recreate)
+{
+    std::shared_ptr<CompactEdges> compact;
+    compact.swap(m_compactEdges);
+    const int n = compact->topology().numNodes();
+    m_edges.setView(nullptr, -1, true);
+    for (int i = 0; i < n; ++i) {
+        BaseNode* node = compact->node(i).m_ptr.get();
+        node->m_outEdges.setView(nullptr, -1, true);
+        if (isDirected()) {
+            static_cast<DNode*>(node)->m_inEdges.setView(nullptr, -1, true);
+        }
+    }
+    if (!recreate) {
+        return;
+    }
+
+    // the edges keep their ids, and the original direction is the one
+    // of the node which owns the edge
+    const auto numEdges = static_cast<size_t>(compact->numEdges());
+    std::vector<Edge> outEdges(numEdges), inEdges(numEdges);
+    BaseEdge::constructor_key k;
+    for (int i = 0; i < n; ++i) {
+        const Node& origin = compact->node(i);
+        const Topology::Span span = compact->neighbours(i, true);
+        for (int pos = 0; pos < span.size(); ++pos) {
+            if (compact->owns(i, pos)) {
+                const int id = compact->edgeId(i, pos, true);
+                const Node& neighbour = compact->node(span[pos]);
+                Attributes* attrs = new Attributes();
+                const auto idx = static_cast<size_t>(id);
+                outEdges[idx].m_ptr = std::make_shared<BaseEdge>(k, id, origin, neighbour, attrs, true);
+                inEdges[idx].m_ptr = std::make_shared<BaseEdge>(k, id, neighbour, origin, attrs, false);
+                m_edges.insert({id, outEdges[idx]});
+            }
+        }
+    }
+
+    // the neighbours are listed in the same order as in the CSR view
+    for (int i = 0; i < n; ++i) {
+        BaseNode* node = compact->node(i).m_ptr.get();
+        const Topology::Span out = compact->neighbours(i, true);
+        for (int pos = 0; pos < out.size(); ++pos) {
+            const auto idx = static_cast<size_t>(compact->edgeId(i, pos, true));
+            node->m_outEdges.addEdge(compact->owns(i, pos) ? outEdges[idx] : inEdges[idx]);
+        }
+        if (isDirected()) {
+            const Topology::Span in = compact->neighbours(i, false);
+            for (int pos = 0; pos < in.size(); ++pos) {
+                const auto idx = static_cast<size_t>(compact->edgeId(i, pos, false));
+                static_cast<DNode*>(node)->m_inEdges.addEdge(inEdges[idx]);
+            }
+        }
+    }
+}
+
+bool AbstractGraph::reorderEdges(const Node& node, bool out, const std::vector<int>& edgeIds)
+{
+    QMutexLocker locker(&m_mutex);
+    clearTopology();
+    if (out || isUndirected()) {
+        return node.m_ptr->m_outEdges.reorder(edgeIds);
+    }
+    return static_cast<DNode*>(node.m_ptr.get())->m_inEdges.reorder(edgeIds);
+}
+
+void AbstractGraph::syncNodeColumns()
+{
+    m_nodeColumns.sync(m_nodes);
+}
+
 Node AbstractGraph::randNode() const
 {
     if (m_nodes.empty()) {
         return Node();
     }
-    return std::next(m_nodes.cbegin(), prg()->uniform(m_numNodesDist))->second;
+    return m_nodes.atIndex(prg()->uniform(numNodes()-1));
 }
 
 Node AbstractGraph::addNode(Attributes attr, float x, float y)
 {
     QMutexLocker locker(&m_mutex);
+    clearTopology();
+    m_nodeColumns.invalidate(m_nodes);
     ++m_lastNodeId;
     Node node;
     BaseNode::constructor_key k;
@@ -71,13 +198,13 @@ Node AbstractGraph::addNode(Attributes attr, float x, float y)
         node.m_ptr = std::make_shared<UNode>(k, m_lastNodeId, attr, x, y);
     }
     m_nodes.insert({m_lastNodeId, node});
-    m_numNodesDist = std::uniform_int_distribution<int>(0, numNodes()-1);
     return node;
 }
 
 Edge AbstractGraph::addEdge(const Node& origin, const Node& neighbour, Attributes* attrs)
 {
     QMutexLocker locker(&m_mutex);
+    clearTopology();
     ++m_lastEdgeId;
     Edge edgeOut, edgeIn;
     BaseEdge::constructor_key k;
@@ -92,6 +219,10 @@ Edge AbstractGraph::addEdge(const Node& origin, const Node& neighbour, Attribute
 void AbstractGraph::removeAllEdges()
 {
     QMutexLocker locker(&m_mutex);
+    if (m_compactEdges) {
+        thawEdges(false); // no need to recreate them
+    }
+    clearTopology();
     for (auto const& p : m_nodes) {
         p.second.m_ptr->clearInEdges();
         p.second.m_ptr->clearOutEdges();
@@ -102,6 +233,7 @@ void AbstractGraph::removeAllEdges()
 void AbstractGraph::removeAllEdges(const Node& node)
 {
     QMutexLocker locker(&m_mutex);
+    clearTopology();
     if (isUndirected()) {
         for (auto const& p : node.outEdges()) {
             p.second.neighbour().m_ptr->removeInEdge(p.first);
@@ -128,24 +260,25 @@ void AbstractGraph::removeNode(const Node& node)
 {
     removeAllEdges(node);
     QMutexLocker locker(&m_mutex);
+    clearTopology();
+    m_nodeColumns.invalidate(m_nodes);
     m_nodes.erase(node.id());
-    int sz = m_nodes.empty() ? 0 : numNodes()-1;
-    m_numNodesDist = std::uniform_int_distribution<int>(0, sz);
 }
 
 Nodes::iterator AbstractGraph::removeNode(Nodes::iterator it)
 {
     removeAllEdges(it->second);
     QMutexLocker locker(&m_mutex);
+    clearTopology();
+    m_nodeColumns.invalidate(m_nodes);
     it = m_nodes.erase(it);
-    int sz = m_nodes.empty() ? 0 : numNodes()-1;
-    m_numNodesDist = std::uniform_int_distribution<int>(0, sz);
     return it;
 }
 
 void AbstractGraph::removeEdge(const Edge& edge)
 {
     QMutexLocker locker(&m_mutex);
+    clearTopology();
     edge.origin().m_ptr->removeOutEdge(edge.id());
     edge.neighbour().m_ptr->removeInEdge(edge.id());
     m_edges.erase(edge.id());
@@ -154,10 +287,11 @@ void AbstractGraph::removeEdge(const Edge& edge)
 Edges::iterator AbstractGraph::removeEdge(Edges::iterator it)
 {
     QMutexLocker locker(&m_mutex);
-    const Edge& edge = it->second;
+    const Edge edge = it->second; // 'it' is invalid if the edges are recreated
+    clearTopology();
     edge.origin().m_ptr->removeOutEdge(edge.id());
     edge.neighbour().m_ptr->removeInEdge(edge.id());
-    return m_edges.erase(it);
+    return m_edges.eraseEdge(edge.id());
 }
 
 } // evoplex
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include <QtDebug>
+#include <cmath>
+
 #include "abstractmodel.h"
+#include "parallelfor.h"
 #include "trial.h"
 
 namespace evoplex {
@@ -31,4 +35,141 @@ int AbstractModel::step() const
 int AbstractModel::lastStep() const
 { return m_trial->stopAt(); }
 
+void AbstractModel::initUpdates()
+{
+    if (m_updateMode != UpdateMode::Gillespie) {
+        return;
+    }
+
+    Q_ASSERT_X(graph()->topology().isValid(), "AbstractModel",
+               "the Gillespie mode requires a static graph");
+
+    // the nodes might have been changed while paused, so
+    // all the rates are queried again
+    const int numNodes = static_cast<int>(nodes().size());
+    m_rates.reset(numNodes);
+    for (int i = 0; i < numNodes; ++i) {
+        m_rates.setRate(i, nodeRate(i));
+    }
+}
+
+bool AbstractModel::runStep()
+{
+    switch (m_updateMode) {
+    case UpdateMode::Synchronous:
+        return algorithmStep();
+
+    case UpdateMode::RandomSequential: {
+        const int numNodes = static_cast<int>(nodes().size());
+        for (int i = 0; i < numNodes; ++i) {
+            nodeEvent(prg()->uniform(numNodes - 1));
+        }
+        return algorithmStep();
+    }
+
+    case UpdateMode::Gillespie: {
+        const Topology& topology = graph()->topology();
+        const double endTime = step() + 1;
+        while (true) {
+            const double total = m_rates.total();
+            if (total <= 0.0) {
+                // nothing else can happen; stop the simulation
+                m_time = endTime;
+                algorithmStep();
+                return false;
+            }
+
+            // the waiting time is exponentially distributed; as it is
+            // memoryless, the event beyond this step can be discarded
+            const double dt = -std::log(1.0 - prg()->uniform(1.0)) / total;
+            if (m_time + dt >= endTime) {
+                m_time = endTime;
+                break;
+            }
+            m_time += dt;
+
+            const int nodeIdx = m_rates.find(prg()->uniform(total));
+            nodeEvent(nodeIdx);
+            if (!topology.isValid()) {
+                // the neighbours' rates cannot be updated
+                qWarning() << "the graph has changed in the middle of a step,"
+                           << "but the Gillespie mode requires a static graph;"
+                           << "the simulation was stopped.";
+                return false;
+            }
+
+            updateRate(nodeIdx);
+            for (const int n : topology.outNeighbours(nodeIdx)) {
+                updateRate(n);
+            }
+            if (graph()->isDirected()) {
+                for (const int n : topology.inNeighbours(nodeIdx)) {
+                    updateRate(n);
+                }
+            }
+        }
+        return algorithmStep();
+    }
+    }
+    return false;
+}
+
+void AbstractModel::updateRate(int nodeIdx)
+{
+    const double rate = nodeRate(nodeIdx);
+    if (rate != m_rates.rate(nodeIdx)) {
+        m_rates.setRate(nodeIdx, rate);
+    }
+}
+
+// the seed of each chunk is derived from the trial's seed (splitmix64)
+static unsigned int chunkSeed(unsigned int seed, int step, int chunk)
+{
+    quint64 z = (static_cast<quint64>(seed) << 32) ^ static_cast<quint32>(step);
+    z += 0x9E3779B97F4A7C15ULL * (static_cast<quint64>(chunk) + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<unsigned int>(z ^ (z >> 31));
+}
+
+void AbstractModel::parallelFor(int size, const std::function<void(int, PRG*)>& func,
+                                int grainSize) const
+{
+    const unsigned int seed = prg()->seed();
+    const int currStep = step();
+    ParallelFor::run(m_trial->threadPool(), size, grainSize,
+        [&func, seed, currStep](int begin, int end, int chunk) {
+            PRG prg(chunkSeed(seed, currStep, chunk));
+            for (int i = begin; i < end; ++i) {
+                func(i, &prg);
+            }
+        });
+}
+
+void AbstractModel::parallelForNodes(const std::function<void(const Node&, PRG*)>& func,
+                                     int grainSize) const
+{
+    std::vector<const Node*> nodes;
+    nodes.reserve(graph()->nodes().size());
+    for (auto const& p : graph()->nodes()) {
+        nodes.emplace_back(&p.second);
+    }
+    parallelFor(static_cast<int>(nodes.size()),
+        [&func, &nodes](int i, PRG* prg) { func(*nodes[i], prg); }, grainSize);
+}
+
+void AbstractModel::parallelForEdges(const std::function<void(const Edge&, PRG*)>& func,
+                                     int grainSize) const
+{
+    // the handles are copied as the edges of a static graph
+    // are only created when they are accessed (see Edges)
+    std::vector<Edge> edges;
+    edges.reserve(graph()->edges().size());
+    for (auto const& p : graph()->edges()) {
+        edges.emplace_back(p.second);
+    }
+    parallelFor(static_cast<int>(edges.size()),
+        [&func, &edges](int i, PRG* prg) { func(edges[i], prg); }, grainSize);
+}
+
 } // evoplex
@@ -0,0 +1,106 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/attributes.h"
+
+namespace evoplex {
+
+AttributesSchema::AttributesSchema(std::vector<QString> names)
+    : m_names(std::move(names))
+{
+    m_ids.reserve(static_cast<int>(m_names.size()));
+    // iterates backwards to keep the id of the first occurrence
+    for (int id = static_cast<int>(m_names.size()) - 1; id >= 0; --id) {
+        m_ids.insert(m_names[static_cast<size_t>(id)], id);
+    }
+}
+
+const AttributesSchemaPtr& AttributesSchema::emptySchema()
+{
+    static const AttributesSchemaPtr schema = std::make_shared<AttributesSchema>();
+    return schema;
+}
+
+void AttributesSchema::reserve(size_t size)
+{
+    m_names.reserve(size);
+    m_ids.reserve(static_cast<int>(size));
+}
+
+void AttributesSchema::resize(size_t size)
+{
+    while (m_names.size() > size) {
+        const int id = static_cast<int>(m_names.size()) - 1;
+        // a previous occurrence of the name would have a smaller id
+        if (m_ids.value(m_names.back()) == id) {
+            m_ids.remove(m_names.back());
+        }
+        m_names.pop_back();
+    }
+    while (m_names.size() < size) {
+        append(QString());
+    }
+}
+
+void AttributesSchema::rename(size_t id, const QString& name)
+{
+    const int _id = static_cast<int>(id);
+    const QString oldName = m_names.at(id);
+    m_names[id] = name;
+
+    if (m_ids.value(oldName) == _id) {
+        // the next occurrence (if any) is after 'id'
+        m_ids.remove(oldName);
+        for (size_t i = id + 1; i < m_names.size(); ++i) {
+            if (m_names[i] == oldName) {
+                m_ids.insert(oldName, static_cast<int>(i));
+                break;
+            }
+        }
+    }
+
+    auto it = m_ids.find(name);
+    if (it == m_ids.end()) {
+        m_ids.insert(name, _id);
+    } else if (it.value() > _id) {
+        it.value() = _id;
+    }
+}
+
+void AttributesSchema::append(const QString& name)
+{
+    if (!m_ids.contains(name)) {
+        m_ids.insert(name, static_cast<int>(m_names.size()));
+    }
+    m_names.emplace_back(name);
+}
+
+/*******************/
+
+const Attributes::ValuesPtr& Attributes::emptyValues()
+{
+    static const ValuesPtr values = std::make_shared<std::vector<Value>>();
+    return values;
+}
+
+Attributes::Attributes(AttributesSchemaPtr schema)
+    : m_schema(std::move(schema)),
+      m_values(std::make_shared<std::vector<Value>>(static_cast<size_t>(m_schema->size())))
+{
+}
+
+
+} // evoplex
@@ -207,11 +207,21 @@ Value AttrsGenerator::parseRandSeed(QString seedStr)
 
 AttrsGenerator::AttrsGenerator(const AttributesScope& attrsScope, const int size)
     : m_attrsScope(attrsScope),
+      m_schema(createSchema(attrsScope)),
       m_size(size)
 {
     Q_ASSERT_X(m_size > 0, "AttrsGenerator", "number of copies must be >0");
 }
 
+AttributesSchemaPtr AttrsGenerator::createSchema(const AttributesScope& attrsScope)
+{
+    std::vector<QString> names(static_cast<size_t>(attrsScope.size()));
+    for (auto attrRange : attrsScope) {
+        names.at(static_cast<size_t>(attrRange->id())) = attrRange->attrName();
+    }
+    return std::make_shared<AttributesSchema>(names);
+}
+
 /****************************************************/
 /****************************************************/
 
@@ -256,9 +266,9 @@ SetOfAttributes AGSameFuncForAll::create(int size, std::function<void(int)> prog
     SetOfAttributes ret;
     ret.reserve(static_cast<size_t>(size));
     for (int id = 0; id < size; ++id) {
-        Attributes attrs(m_attrsScope.size());
+        Attributes attrs(m_schema);
         for (auto attrRange : m_attrsScope) {
-            attrs.replace(attrRange->id(), attrRange->attrName(), f_value(attrRange));
+            attrs.setValue(attrRange->id(), f_value(attrRange));
         }
         ret.emplace_back(attrs);
         progress(id);
@@ -290,8 +300,7 @@ SetOfAttributes AGDiffFunctions::create(int size, std::function<void(int)> progr
     SetOfAttributes setOfAttrs;
     setOfAttrs.reserve(static_cast<size_t>(size));
     for (int i = 0; i < size; ++i) {
-        Attributes attrs(m_attrsScope.size());
-        setOfAttrs.emplace_back(attrs);
+        setOfAttrs.emplace_back(m_schema);
     }
 
     std::function<Value()> value;
@@ -319,7 +328,7 @@ SetOfAttributes AGDiffFunctions::create(int size, std::function<void(int)> progr
         }
 
         for (Attributes& attrs : setOfAttrs) {
-            attrs.replace(attrRange->id(), attrRange->attrName(), value());
+            attrs.setValue(attrRange->id(), value());
         }
         delete prg;
     }
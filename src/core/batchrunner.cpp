@@ -0,0 +1,199 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QDebug>
+#include <QDir>
+
+#include "batchrunner.h"
+#include "experiment.h"
+#include "project.h"
+
+namespace evoplex {
+
+static QString statusToString(Status s)
+{
+    switch (s) {
+    case Status::Invalid: return "invalid";
+    case Status::Disabled: return "disabled";
+    case Status::Paused: return "paused";
+    case Status::Queued: return "queued";
+    case Status::Running: return "running";
+    case Status::Finished: return "finished";
+    }
+    return "invalid";
+}
+
+BatchRunner::BatchRunner(MainApp* mainApp)
+    : m_mainApp(mainApp),
+      m_project(nullptr),
+      m_lastPrint(0),
+      m_out(stdout),
+      m_skipped(0),
+      m_done(false)
+{
+    connect(&m_timer, SIGNAL(timeout()), SLOT(printProgress()));
+}
+
+bool BatchRunner::load(const QString& projectFile, const QString& outputDir,
+                       const std::set<int>& expIds, QString& error)
+{
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        error = QString("unable to create the output directory: %1").arg(outputDir);
+        qWarning() << error;
+        return false;
+    }
+
+    m_project = m_mainApp->newProject(error);
+    if (!m_project) {
+        return false;
+    }
+    m_project->setFilePath(projectFile);
+
+    int selected = 0;
+    auto editRow = [outputDir, expIds, &selected](const QStringList& header, QStringList& values) {
+        if (!expIds.empty()) {
+            const int col = header.indexOf(GENERAL_ATTR_EXPID);
+            bool ok = false;
+            const int expId = col < 0 ? -1 : values.value(col).toInt(&ok);
+            if (!ok || expIds.find(expId) == expIds.cend()) {
+                return false;
+            }
+        }
+        if (!outputDir.isEmpty()) {
+            const int col = header.indexOf(OUTPUT_DIR);
+            if (col >= 0 && col < values.size()) {
+                values[col] = outputDir;
+            }
+        }
+        ++selected;
+        return true;
+    };
+
+    // warnings are not critical here; the invalid experiments are
+    // reported (and make the runner fail) when we play them, and so
+    // are the rows skipped due to critical errors
+    m_project->importExperiments(projectFile, error, editRow);
+    m_skipped = selected - static_cast<int>(m_project->experiments().size());
+    if (m_project->experiments().empty()) {
+        error += "there are no experiments to run!";
+        qWarning() << error;
+        return false;
+    } else if (m_skipped > 0) {
+        qWarning() << m_skipped << "experiment(s) could not be imported and will not run.";
+    }
+
+    for (auto const& it : m_project->experiments()) {
+        const Experiment* exp = it.second.get();
+        Tracker t;
+        t.totalSteps = 0;
+        t.lastSteps = 0;
+        if (exp->inputs()) {
+            t.totalSteps = static_cast<quint64>(exp->inputs()->general(GENERAL_ATTR_STOPAT).toInt())
+                         * static_cast<quint64>(exp->numTrials());
+        }
+        m_trackers.insert({exp->id(), t});
+    }
+    return true;
+}
+
+void BatchRunner::start(int interval)
+{
+    Q_ASSERT_X(m_project, "BatchRunner", "a project must be loaded first");
+
+    m_elapsed.start();
+    for (auto const& it : m_project->experiments()) {
+        connect(it.second.get(), SIGNAL(statusChanged(Status)),
+                SLOT(checkFinished()), Qt::QueuedConnection);
+        it.second->play();
+    }
+    m_timer.start(interval);
+    QTimer::singleShot(0, this, SLOT(checkFinished()));
+}
+
+bool BatchRunner::isDone(const Experiment* exp) const
+{
+    const Status s = exp->expStatus();
+    return s == Status::Invalid || s == Status::Finished
+            || (s == Status::Disabled && exp->progress() == 360);
+}
+
+quint64 BatchRunner::stepsDone(const Experiment* exp) const
+{
+    const quint64 total = m_trackers.at(exp->id()).totalSteps;
+    if (exp->expStatus() == Status::Finished ||
+            (exp->expStatus() == Status::Disabled && exp->progress() == 360)) {
+        return total;
+    }
+    // the progress is updated by the ExperimentsMgr, so we don't need
+    // to touch the trials (which live in the worker threads) here
+    return static_cast<quint64>(total * (exp->progress() / 360.0));
+}
+
+void BatchRunner::printProgress()
+{
+    const qint64 now = m_elapsed.elapsed();
+    const double secs = qMax<qint64>(now - m_lastPrint, 1) / 1000.0;
+    m_lastPrint = now;
+
+    for (auto const& it : m_project->experiments()) {
+        const Experiment* exp = it.second.get();
+        Tracker& t = m_trackers.at(exp->id());
+        const quint64 steps = stepsDone(exp);
+        const double stepsPerSec = (steps - qMin(steps, t.lastSteps)) / secs;
+        t.lastSteps = steps;
+        m_out << "progress exp=" << exp->id()
+              << " status=" << statusToString(exp->expStatus())
+              << " steps=" << steps << "/" << t.totalSteps
+              << " stepsPerSec=" << QString::number(stepsPerSec, 'f', 1)
+              << endl;
+    }
+}
+
+void BatchRunner::checkFinished()
+{
+    if (m_done) {
+        return;
+    }
+
+    int invalid = 0;
+    for (auto const& it : m_project->experiments()) {
+        if (!isDone(it.second.get())) {
+            return;
+        }
+        if (it.second->expStatus() == Status::Invalid) {
+            ++invalid;
+        }
+    }
+
+    m_done = true;
+    m_timer.stop();
+    printProgress();
+    for (auto const& it : m_project->experiments()) {
+        for (auto const& reason : it.second->stopReasons()) {
+            m_out << "stopped exp=" << it.first
+                  << " trial=" << reason.first
+                  << " reason=\"" << reason.second << "\"" << endl;
+        }
+    }
+    m_out << "finished experiments=" << m_project->experiments().size()
+          << " invalid=" << invalid
+          << " skipped=" << m_skipped
+          << " elapsed=" << m_elapsed.elapsed() << endl;
+    emit (finished(invalid > 0 || m_skipped > 0 ? InvalidExperiment : Success));
+}
+
+} // evoplex
@@ -0,0 +1,110 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <set>
+#include <unordered_map>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTextStream>
+#include <QTimer>
+
+#include "mainapp.h"
+
+namespace evoplex {
+
+class Experiment;
+
+/**
+ * @brief Runs the experiments of a project without the GUI.
+ *
+ * It is meant to be used on headless machines (e.g., HPC nodes), where
+ * Evoplex is started with the '-no-gui' flag. It loads a project file,
+ * plays the selected experiments through the ExperimentsMgr and reports
+ * the progress to the stdout in a machine-readable format:
+ *   "progress exp=<id> status=<status> steps=<done>/<total> stepsPerSec=<n>"
+ * and, at the end, one line for each trial which finished before the
+ * 'stopAt' step (e.g., because it reached a fixed point):
+ *   "stopped exp=<id> trial=<id> reason=\"<reason>\""
+ * followed by:
+ *   "finished experiments=<n> invalid=<n> skipped=<n> elapsed=<msec>"
+ * where 'skipped' is the number of selected rows of the project file
+ * which could not be imported.
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode {
+        Success = 0,
+        InvalidExperiment = 1, //! at least one experiment became invalid or was skipped
+        InvalidArguments = 2   //! the project could not be loaded
+    };
+
+    explicit BatchRunner(MainApp* mainApp);
+
+    /**
+     * @brief Imports the experiments from @p projectFile.
+     * @param outputDir If not empty, it overrides the output directory
+     *                  of all experiments.
+     * @param expIds If not empty, only these experiments are imported.
+     * @return false if no experiment could be imported.
+     */
+    bool load(const QString& projectFile, const QString& outputDir,
+              const std::set<int>& expIds, QString& error);
+
+    /**
+     * @brief Plays all experiments and prints their progress every
+     *        @p interval msec. The finished() signal is emitted when
+     *        all experiments are done.
+     */
+    void start(int interval);
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void printProgress();
+    void checkFinished();
+
+private:
+    struct Tracker {
+        quint64 totalSteps;
+        quint64 lastSteps;
+    };
+
+    MainApp* m_mainApp;
+    ProjectPtr m_project;
+    QTimer m_timer;
+    QElapsedTimer m_elapsed;
+    qint64 m_lastPrint;
+    QTextStream m_out;
+    std::unordered_map<int, Tracker> m_trackers;
+    int m_skipped; // rows which could not be imported
+    bool m_done;
+
+    // true if the experiment will not run anymore
+    bool isDone(const Experiment* exp) const;
+    // estimated number of steps performed by all trials
+    quint64 stepsDone(const Experiment* exp) const;
+};
+
+} // evoplex
+#endif // BATCHRUNNER_H
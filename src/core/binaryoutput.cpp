@@ -0,0 +1,401 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <QTextStream>
+#include <QtDebug>
+
+#include "binaryoutput.h"
+
+namespace evoplex {
+
+static const char BINARY_OUTPUT_MAGIC[] = "EVOPLXBO";
+static const quint32 BINARY_OUTPUT_VERSION = 1;
+static const quint32 BLOCK_MAGIC = 0x4b4c4258; // "XBLK"
+static const quint32 INDEX_MAGIC = 0x58444958; // "XIDX"
+// the size of an entry of the index and of its trailer
+static const qint64 INDEX_ENTRY_SIZE = 24;
+static const qint64 INDEX_TRAILER_SIZE = 16;
+
+static inline qint64 align8(qint64 n)
+{ return (n + 7) & ~qint64(7); }
+
+// qToLittleEndian() does not handle floating-point numbers in older Qt versions
+static inline quint64 doubleToBits(double d)
+{ quint64 bits; memcpy(&bits, &d, sizeof(d)); return bits; }
+
+static inline double bitsToDouble(quint64 bits)
+{ double d; memcpy(&d, &bits, sizeof(d)); return d; }
+
+template<typename T>
+static inline void appendLE(QByteArray& out, T v)
+{
+    uchar buf[sizeof(T)];
+    qToLittleEndian<T>(v, buf);
+    out.append(reinterpret_cast<const char*>(buf), sizeof(T));
+}
+
+static inline void appendPadding(QByteArray& out, const qint64 start)
+{
+    out.append(static_cast<int>(align8(out.size() - start) - (out.size() - start)), '\0');
+}
+
+static bool columnType(const Value& v, BinaryOutput::ColumnType& type)
+{
+    switch (v.type()) {
+    case Value::INT: type = BinaryOutput::Int; return true;
+    case Value::DOUBLE: type = BinaryOutput::Double; return true;
+    case Value::BOOL: type = BinaryOutput::Bool; return true;
+    case Value::CHAR: type = BinaryOutput::Char; return true;
+    default: return false;
+    }
+}
+
+QByteArray BinaryOutput::header(const QStringList& columns)
+{
+    QByteArray out;
+    out.append(BINARY_OUTPUT_MAGIC, 8);
+    appendLE<quint32>(out, BINARY_OUTPUT_VERSION);
+    appendLE<quint32>(out, static_cast<quint32>(columns.size()));
+    for (const QString& col : columns) {
+        const QByteArray name = col.toUtf8();
+        appendLE<quint32>(out, static_cast<quint32>(name.size()));
+        out.append(name);
+    }
+    appendPadding(out, 0);
+    return out;
+}
+
+bool BinaryOutput::appendBlock(QByteArray& out, const qint64 offset,
+        const std::vector<int>& steps, const std::vector<Values>& rows,
+        BlockInfo& info, QString& error)
+{
+    Q_ASSERT_X(steps.size() == rows.size() && !rows.empty(), "BinaryOutput",
+               "each row must have a step");
+    const size_t numCols = rows.front().size();
+
+    // the type of each column; mixed ints and doubles are stored as doubles
+    std::vector<ColumnType> types(numCols);
+    for (size_t col = 0; col < numCols; ++col) {
+        for (size_t row = 0; row < rows.size(); ++row) {
+            ColumnType t;
+            if (rows[row].size() != numCols || !columnType(rows[row][col], t)) {
+                error = "the binary output only supports numeric values.";
+                return false;
+            }
+            if (row == 0 || t == types[col]) {
+                types[col] = t;
+            } else if ((t == Int || t == Double) && (types[col] == Int || types[col] == Double)) {
+                types[col] = Double;
+            } else {
+                error = "the values of a column must have the same type.";
+                return false;
+            }
+        }
+    }
+
+    const int start = out.size();
+    out.reserve(start + static_cast<int>(align8(8 + numCols) + 8 * rows.size() * (numCols + 1)));
+    appendLE<quint32>(out, BLOCK_MAGIC);
+    appendLE<quint32>(out, static_cast<quint32>(rows.size()));
+    for (ColumnType t : types) {
+        out.append(static_cast<char>(t));
+    }
+    appendPadding(out, start);
+
+    for (int step : steps) {
+        appendLE<qint64>(out, step);
+    }
+    for (size_t col = 0; col < numCols; ++col) {
+        for (const Values& row : rows) {
+            const Value& v = row[col];
+            switch (types[col]) {
+            case Double:
+                appendLE<quint64>(out, doubleToBits(v.isInt() ? v.toInt() : v.toDouble()));
+                break;
+            case Bool:
+                appendLE<qint64>(out, v.toBool());
+                break;
+            case Char:
+                appendLE<qint64>(out, v.toChar());
+                break;
+            default:
+                appendLE<qint64>(out, v.toInt());
+            }
+        }
+    }
+
+    info.offset = offset;
+    info.firstStep = steps.front();
+    info.numRows = static_cast<qint64>(rows.size());
+    return true;
+}
+
+QByteArray BinaryOutput::index(const std::vector<BlockInfo>& blocks, const qint64 indexOffset)
+{
+    QByteArray out;
+    out.reserve(static_cast<int>(INDEX_ENTRY_SIZE * blocks.size() + INDEX_TRAILER_SIZE));
+    for (const BlockInfo& b : blocks) {
+        appendLE<qint64>(out, b.offset);
+        appendLE<qint64>(out, b.firstStep);
+        appendLE<qint64>(out, b.numRows);
+    }
+    appendLE<qint64>(out, indexOffset);
+    appendLE<quint32>(out, static_cast<quint32>(blocks.size()));
+    appendLE<quint32>(out, INDEX_MAGIC);
+    return out;
+}
+
+/*******************************************************/
+/*******************************************************/
+
+BinaryOutputReader::BinaryOutputReader()
+    : m_data(nullptr),
+      m_numRows(0),
+      m_dataEnd(0),
+      m_blockHeaderSize(0)
+{
+}
+
+BinaryOutputReader::~BinaryOutputReader()
+{
+    close();
+}
+
+void BinaryOutputReader::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_header.clear();
+    m_blocks.clear();
+    m_firstRows.clear();
+    m_numRows = 0;
+    m_dataEnd = 0;
+}
+
+bool BinaryOutputReader::open(const QString& filePath, QString& error)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QFile::ReadOnly)) {
+        error = "unable to open the binary output.\n" + filePath;
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    m_data = size > 0 ? m_file.map(0, size) : nullptr;
+    qint64 pos = 0;
+    if (!m_data || !readHeader(pos, size, error)) {
+        if (error.isEmpty()) {
+            error = "unable to map the binary output into memory.";
+        }
+        error += "\n" + filePath;
+        close();
+        return false;
+    }
+
+    m_blockHeaderSize = align8(8 + m_header.size());
+    if (!readIndex(size)) {
+        scanBlocks(pos, size);
+    }
+
+    m_firstRows.reserve(m_blocks.size());
+    for (const BinaryOutput::BlockInfo& b : m_blocks) {
+        m_firstRows.emplace_back(m_numRows);
+        m_numRows += b.numRows;
+    }
+    return true;
+}
+
+bool BinaryOutputReader::readHeader(qint64& pos, const qint64 size, QString& error)
+{
+    if (size < 16 || memcmp(m_data, BINARY_OUTPUT_MAGIC, 8) != 0) {
+        error = "it's not a binary output file.";
+        return false;
+    } else if (qFromLittleEndian<quint32>(m_data + 8) != BINARY_OUTPUT_VERSION) {
+        error = "the version of the binary output is not supported.";
+        return false;
+    }
+
+    const quint32 numCols = qFromLittleEndian<quint32>(m_data + 12);
+    pos = 16;
+    for (quint32 i = 0; i < numCols; ++i) {
+        if (pos + 4 > size) {
+            error = "the header of the binary output is truncated.";
+            return false;
+        }
+        const qint64 len = qFromLittleEndian<quint32>(m_data + pos);
+        pos += 4;
+        if (pos + len > size) {
+            error = "the header of the binary output is truncated.";
+            return false;
+        }
+        m_header.append(QString::fromUtf8(reinterpret_cast<const char*>(m_data + pos),
+                                          static_cast<int>(len)));
+        pos += len;
+    }
+    pos = align8(pos);
+    m_dataEnd = pos;
+    return pos <= size;
+}
+
+bool BinaryOutputReader::readIndex(const qint64 size)
+{
+    if (size < m_dataEnd + INDEX_TRAILER_SIZE) {
+        return false;
+    }
+
+    const uchar* trailer = m_data + size - INDEX_TRAILER_SIZE;
+    const qint64 indexOffset = qFromLittleEndian<qint64>(trailer);
+    const qint64 numBlocks = qFromLittleEndian<quint32>(trailer + 8);
+    if (qFromLittleEndian<quint32>(trailer + 12) != INDEX_MAGIC
+            || indexOffset < m_dataEnd
+            || indexOffset + numBlocks * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE != size) {
+        return false;
+    }
+
+    std::vector<BinaryOutput::BlockInfo> blocks;
+    blocks.reserve(static_cast<size_t>(numBlocks));
+    for (const uchar* e = m_data + indexOffset; e < trailer; e += INDEX_ENTRY_SIZE) {
+        BinaryOutput::BlockInfo b;
+        b.offset = qFromLittleEndian<qint64>(e);
+        b.firstStep = qFromLittleEndian<qint64>(e + 8);
+        b.numRows = qFromLittleEndian<qint64>(e + 16);
+        blocks.emplace_back(b);
+    }
+
+    // the blocks must be in the data section, one after another
+    qint64 pos = m_dataEnd;
+    for (const BinaryOutput::BlockInfo& b : blocks) {
+        if (b.offset != pos || b.numRows <= 0) {
+            return false;
+        }
+        pos += m_blockHeaderSize + 8 * b.numRows * (m_header.size() + 1);
+    }
+    if (pos != indexOffset) {
+        return false;
+    }
+
+    m_blocks = std::move(blocks);
+    m_dataEnd = indexOffset;
+    return true;
+}
+
+void BinaryOutputReader::scanBlocks(qint64 pos, const qint64 size)
+{
+    while (pos + m_blockHeaderSize <= size
+           && qFromLittleEndian<quint32>(m_data + pos) == BLOCK_MAGIC) {
+        BinaryOutput::BlockInfo b;
+        b.offset = pos;
+        b.numRows = qFromLittleEndian<quint32>(m_data + pos + 4);
+        const qint64 end = pos + m_blockHeaderSize + 8 * b.numRows * (m_header.size() + 1);
+        if (b.numRows == 0 || end > size) {
+            break; // incomplete
+        }
+        b.firstStep = qFromLittleEndian<qint64>(m_data + pos + m_blockHeaderSize);
+        m_blocks.emplace_back(b);
+        pos = end;
+    }
+    m_dataEnd = pos;
+}
+
+int BinaryOutputReader::blockOfRow(const qint64 row) const
+{
+    Q_ASSERT_X(row >= 0 && row < m_numRows, "BinaryOutputReader", "row out of range");
+    auto it = std::upper_bound(m_firstRows.begin(), m_firstRows.end(), row);
+    return static_cast<int>(it - m_firstRows.begin()) - 1;
+}
+
+qint64 BinaryOutputReader::rowOfStep(const int step) const
+{
+    // the steps are in ascending order
+    auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), step,
+        [](int s, const BinaryOutput::BlockInfo& b) { return s < b.firstStep; });
+    if (it == m_blocks.begin()) {
+        return -1;
+    }
+    const int block = static_cast<int>(it - m_blocks.begin()) - 1;
+    const uchar* steps = this->steps(block);
+    qint64 lo = 0;
+    qint64 hi = m_blocks[block].numRows;
+    while (lo < hi) {
+        const qint64 mid = (lo + hi) / 2;
+        if (qFromLittleEndian<qint64>(steps + 8 * mid) < step) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < m_blocks[block].numRows && qFromLittleEndian<qint64>(steps + 8 * lo) == step) {
+        return m_firstRows[block] + lo;
+    }
+    return -1;
+}
+
+Value BinaryOutputReader::value(const qint64 row, const int col) const
+{
+    const int block = blockOfRow(row);
+    return value(block, row - m_firstRows[block], col);
+}
+
+Value BinaryOutputReader::value(const int block, const qint64 blockRow, const int col) const
+{
+    const uchar* v = column(block, col) + 8 * blockRow;
+    switch (columnType(block, col)) {
+    case BinaryOutput::Double: return Value(bitsToDouble(qFromLittleEndian<quint64>(v)));
+    case BinaryOutput::Bool: return Value(qFromLittleEndian<qint64>(v) != 0);
+    case BinaryOutput::Char: return Value(static_cast<char>(qFromLittleEndian<qint64>(v)));
+    default: return Value(static_cast<int>(qFromLittleEndian<qint64>(v)));
+    }
+}
+
+bool BinaryOutputReader::toCsv(const QString& filePath, QString& error) const
+{
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        error = "unable to write the csv file.\n" + filePath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << m_header.join(",") << "\n";
+    for (int block = 0; block < static_cast<int>(m_blocks.size()); ++block) {
+        for (qint64 row = 0; row < m_blocks[block].numRows; ++row) {
+            for (int col = 0; col < numColumns(); ++col) {
+                if (col > 0) {
+                    out << ",";
+                }
+                out << value(block, row, col).toQString();
+            }
+            out << "\n";
+        }
+    }
+    out.flush();
+
+    if (out.status() != QTextStream::Ok) {
+        error = "unable to write the csv file.\n" + filePath;
+        return false;
+    }
+    return true;
+}
+
+} // evoplex
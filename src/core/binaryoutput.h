@@ -0,0 +1,158 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINARYOUTPUT_H
+#define BINARYOUTPUT_H
+
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QStringList>
+#include <QtEndian>
+
+#include "value.h"
+
+namespace evoplex {
+
+/**
+ * @brief The binary format of the output files.
+ *
+ * It's an alternative to the csv files which is faster to write, smaller
+ * and can be read back without any parsing: the columns have a fixed
+ * width and are stored contiguously in blocks of rows, so the
+ * BinaryOutputReader just maps the file into memory.
+ *
+ * All numbers are little-endian and each section starts at an offset
+ * multiple of 8, i.e., the columns can be read as arrays in place.
+ *
+ *   header: "EVOPLXBO" | quint32 version | quint32 numColumns
+ *           | (quint32 size | utf-8 name) for each column | padding
+ *   block:  quint32 BLOCK_MAGIC | quint32 numRows
+ *           | quint8 type for each column | padding
+ *           | qint64 step for each row | 8-byte value for each column and row
+ *   index:  (qint64 offset | qint64 firstStep | qint64 numRows) for each block
+ *           | qint64 indexOffset | quint32 numBlocks | quint32 INDEX_MAGIC
+ *
+ * The index is only written when the file is closed. If it's missing
+ * (e.g., the trial has been paused), it's rebuilt by walking the blocks.
+ */
+class BinaryOutput
+{
+public:
+    // the type of a column in a block; the values are stored as
+    // qint64 (Int, Bool and Char) or double (Double)
+    enum ColumnType : quint8 { Int = 1, Double = 2, Bool = 3, Char = 4 };
+
+    struct BlockInfo {
+        qint64 offset;
+        qint64 firstStep;
+        qint64 numRows;
+    };
+
+    // Returns the header of a file with the given columns
+    static QByteArray header(const QStringList& columns);
+
+    // Appends a block with the given rows to 'out'
+    // 'offset' is the position of the block in the file
+    // Returns false if the rows have non-numeric values
+    static bool appendBlock(QByteArray& out, const qint64 offset,
+                            const std::vector<int>& steps, const std::vector<Values>& rows,
+                            BlockInfo& info, QString& error);
+
+    // Returns the index of a file with the given blocks
+    static QByteArray index(const std::vector<BlockInfo>& blocks, const qint64 indexOffset);
+};
+
+/**
+ * @brief Reads a binary output file.
+ *
+ * The file is mapped into memory, so opening it only costs reading the
+ * header and the index; the values are read in place, on demand.
+ */
+class BinaryOutputReader
+{
+public:
+    BinaryOutputReader();
+    ~BinaryOutputReader();
+
+    // Returns false if the file is not a valid binary output
+    // The last block is ignored if it's incomplete
+    bool open(const QString& filePath, QString& error);
+    void close();
+
+    inline const QStringList& header() const { return m_header; }
+    inline int numColumns() const { return m_header.size(); }
+    inline qint64 numRows() const { return m_numRows; }
+    inline const std::vector<BinaryOutput::BlockInfo>& blocks() const { return m_blocks; }
+    // the end of the last complete block
+    inline qint64 dataEnd() const { return m_dataEnd; }
+
+    // Returns the row of the given step, or -1 if it's not in the file
+    qint64 rowOfStep(const int step) const;
+    // Returns the step of the given row
+    inline qint64 step(const qint64 row) const;
+    // Returns the value at the given row and column
+    Value value(const qint64 row, const int col) const;
+
+    // direct access to the columns of a block
+    // the steps and values are 8-byte little-endian numbers
+    inline const uchar* steps(const int block) const;
+    inline BinaryOutput::ColumnType columnType(const int block, const int col) const;
+    inline const uchar* column(const int block, const int col) const;
+
+    // Writes the rows in the csv format, i.e., as written by the trials
+    bool toCsv(const QString& filePath, QString& error) const;
+
+private:
+    QFile m_file;
+    const uchar* m_data;
+    QStringList m_header;
+    std::vector<BinaryOutput::BlockInfo> m_blocks;
+    std::vector<qint64> m_firstRows; // the first row of each block
+    qint64 m_numRows;
+    qint64 m_dataEnd;
+    qint64 m_blockHeaderSize; // the same for all blocks
+
+    bool readHeader(qint64& pos, const qint64 size, QString& error);
+    bool readIndex(const qint64 size);
+    void scanBlocks(qint64 pos, const qint64 size);
+    // Returns the block holding the given row
+    int blockOfRow(const qint64 row) const;
+    Value value(const int block, const qint64 blockRow, const int col) const;
+};
+
+/************************************************************************
+   BinaryOutputReader: Inline member functions
+ ************************************************************************/
+
+inline qint64 BinaryOutputReader::step(const qint64 row) const
+{
+    const int block = blockOfRow(row);
+    return qFromLittleEndian<qint64>(steps(block) + 8 * (row - m_firstRows[block]));
+}
+
+inline const uchar* BinaryOutputReader::steps(const int block) const
+{ return m_data + m_blocks[block].offset + m_blockHeaderSize; }
+
+inline BinaryOutput::ColumnType BinaryOutputReader::columnType(const int block, const int col) const
+{ return static_cast<BinaryOutput::ColumnType>(m_data[m_blocks[block].offset + 8 + col]); }
+
+inline const uchar* BinaryOutputReader::column(const int block, const int col) const
+{ return steps(block) + 8 * m_blocks[block].numRows * (col + 1); }
+
+} // evoplex
+#endif // BINARYOUTPUT_H
@@ -0,0 +1,144 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <memory>
+
+#include <QtGlobal>
+
+namespace evoplex {
+
+/**
+ * @brief A bounded multi-producer/multi-consumer FIFO queue.
+ *
+ * It's lock-free: each cell holds a sequence number which tells the
+ * producers and consumers whether the cell is free or full in the
+ * current lap of the ring buffer (Dmitry Vyukov's algorithm).
+ *
+ * The capacity is rounded up to a power of two.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity);
+
+    inline size_t capacity() const { return m_mask + 1; }
+
+    // Returns false if the queue is full
+    bool tryPush(T value);
+    // Returns false if the queue is empty
+    bool tryPop(T& value);
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    const size_t m_mask;
+    // keeps the positions in different cache lines
+    char m_pad0[64];
+    std::atomic<size_t> m_pushPos;
+    char m_pad1[64];
+    std::atomic<size_t> m_popPos;
+    char m_pad2[64];
+
+    static size_t roundUp(size_t n);
+};
+
+/************************************************************************
+   BoundedQueue: Inline member functions
+ ************************************************************************/
+
+template<class T>
+size_t BoundedQueue<T>::roundUp(size_t n)
+{
+    size_t p = 2;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+template<class T>
+BoundedQueue<T>::BoundedQueue(size_t capacity)
+    : m_cells(new Cell[roundUp(capacity)]),
+      m_mask(roundUp(capacity) - 1),
+      m_pushPos(0),
+      m_popPos(0)
+{
+    for (size_t i = 0; i <= m_mask; ++i) {
+        m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<class T>
+bool BoundedQueue<T>::tryPush(T value)
+{
+    Cell* cell;
+    size_t pos = m_pushPos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const size_t seq = cell->seq.load(std::memory_order_acquire);
+        const qint64 diff = static_cast<qint64>(seq) - static_cast<qint64>(pos);
+        if (diff == 0) { // the cell is free; let's claim it
+            if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) { // the cell has not been consumed yet
+            return false;
+        } else { // another producer got it
+            pos = m_pushPos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->data = std::move(value);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+bool BoundedQueue<T>::tryPop(T& value)
+{
+    Cell* cell;
+    size_t pos = m_popPos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        const size_t seq = cell->seq.load(std::memory_order_acquire);
+        const qint64 diff = static_cast<qint64>(seq) - static_cast<qint64>(pos + 1);
+        if (diff == 0) { // the cell is full; let's claim it
+            if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) { // the cell has not been produced yet
+            return false;
+        } else { // another consumer got it
+            pos = m_popPos.load(std::memory_order_relaxed);
+        }
+    }
+    value = std::move(cell->data);
+    // free the cell for the next lap
+    cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+} // evoplex
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,284 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+#include <QtDebug>
+
+#include "checkpoint.h"
+#include "abstractgraph.h"
+#include "abstractmodel.h"
+#include "constants.h"
+#include "experiment.h"
+#include "nodes_p.h"
+#include "trial.h"
+
+namespace evoplex {
+
+// 'EVCP'
+static const quint32 CHECKPOINT_MAGIC = 0x45564350;
+static const quint16 CHECKPOINT_VERSION = 2;
+
+QByteArray Checkpoint::save(const Trial* trial, qint64 outputSize)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+
+    out << CHECKPOINT_MAGIC << CHECKPOINT_VERSION;
+    out << fingerprint(trial->m_exp.get(), trial->id());
+    out << static_cast<qint32>(trial->step()) << outputSize;
+
+    const AbstractGraph* graph = trial->graph();
+    NodesPrivate::writeNodes(graph->nodes(), out);
+
+    // edges are written by id; the order of the neighbours of each
+    // node is written afterwards, as it depends on the edges removed
+    std::vector<Edge> edges; // by value, compact edges are made on access
+    edges.reserve(graph->edges().size());
+    for (auto const& p : graph->edges()) {
+        edges.emplace_back(p.second);
+    }
+    std::sort(edges.begin(), edges.end(),
+              [](const Edge& a, const Edge& b) { return a.id() < b.id(); });
+
+    std::vector<QString> edgeAttrNames;
+    if (!edges.empty()) {
+        edgeAttrNames = edges.front().attrs()->names();
+    }
+    out << static_cast<quint32>(edgeAttrNames.size());
+    for (const QString& name : edgeAttrNames) {
+        out << name;
+    }
+    out << static_cast<quint32>(edges.size());
+    for (const Edge& e : edges) {
+        out << static_cast<qint32>(e.id())
+            << static_cast<qint32>(e.origin().id())
+            << static_cast<qint32>(e.neighbour().id());
+        for (const Value& value : e.attrs()->values()) {
+            out << value;
+        }
+    }
+
+    // the adjacency lists of the nodes, following the nodes' positions
+    auto writeAdjacency = [&out](const Edges& adjacency) {
+        const int degree = static_cast<int>(adjacency.size());
+        out << static_cast<quint32>(degree);
+        for (int pos = 0; pos < degree; ++pos) {
+            out << static_cast<qint32>(adjacency.idAt(pos));
+        }
+    };
+    for (size_t i = 0; i < graph->nodes().size(); ++i) {
+        const Node& node = graph->nodes().atIndex(static_cast<int>(i));
+        writeAdjacency(node.outEdges());
+        if (graph->isDirected()) {
+            writeAdjacency(node.inEdges());
+        }
+    }
+    // the next ids, which are not the max ids if the last ones were removed
+    out << static_cast<qint32>(graph->m_lastNodeId)
+        << static_cast<qint32>(graph->m_lastEdgeId);
+
+    std::ostringstream prgState;
+    prgState << trial->prg()->m_mteng;
+    out << QByteArray::fromStdString(prgState.str());
+
+    const AbstractModel* model = trial->model();
+    out << model->m_time;
+    QByteArray modelState;
+    QDataStream modelOut(&modelState, QIODevice::WriteOnly);
+    modelOut.setVersion(QDataStream::Qt_5_9);
+    model->saveState(modelOut);
+    out << modelState;
+
+    return data;
+}
+
+bool Checkpoint::write(const QString& filePath, const QByteArray& data)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "unable to write the checkpoint." << filePath << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QByteArray Checkpoint::fingerprint(const Experiment* exp, quint16 trialId)
+{
+    // the attributes which do not change the dynamics of the trial
+    // can be changed before resuming it
+    static const std::vector<QString> ignored = {
+        GENERAL_ATTR_STOPAT, GENERAL_ATTR_AUTODELETE,
+        GENERAL_ATTR_CYCLEPERIOD, GENERAL_ATTR_CHECKPOINT };
+
+    const std::vector<QString> names = exp->inputs()->exportAttrNames(true);
+    const std::vector<Value> values = exp->inputs()->exportAttrValues();
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << trialId;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (std::find(ignored.begin(), ignored.end(), names[i]) == ignored.end()) {
+            out << names[i] << values[i];
+        }
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(data);
+    return hash.result();
+}
+
+std::unique_ptr<Checkpoint> Checkpoint::open(const QString& filePath,
+        const QByteArray& fingerprint, QString& error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error += "unable to read the checkpoint file.";
+        return nullptr;
+    }
+    // a single sequential read
+    std::unique_ptr<Checkpoint> cp(new Checkpoint(file.readAll()));
+    file.close();
+
+    quint32 magic;
+    quint16 version;
+    QByteArray fp;
+    qint32 step;
+    cp->m_in >> magic >> version >> fp >> step >> cp->m_outputSize;
+    cp->m_step = step;
+    if (cp->m_in.status() != QDataStream::Ok || magic != CHECKPOINT_MAGIC) {
+        error += "it is not a valid checkpoint file.";
+        return nullptr;
+    } else if (version != CHECKPOINT_VERSION) {
+        error += QString("unsupported checkpoint version (%1).").arg(version);
+        return nullptr;
+    } else if (fp != fingerprint) {
+        error += "the checkpoint was created by an experiment with different inputs.";
+        return nullptr;
+    }
+    return cp;
+}
+
+Checkpoint::Checkpoint(const QByteArray& data)
+    : m_data(data),
+      m_in(m_data),
+      m_step(-1),
+      m_outputSize(0)
+{
+    m_in.setVersion(QDataStream::Qt_5_9);
+}
+
+Nodes Checkpoint::readNodes(const GraphType& graphType, QString& error)
+{
+    return NodesPrivate::readNodes(m_in, graphType, error);
+}
+
+bool Checkpoint::readState(AbstractGraph* graph, PRG* prg, AbstractModel* model, QString& error)
+{
+    quint32 numAttrs;
+    m_in >> numAttrs;
+    std::vector<QString> names(numAttrs);
+    for (QString& name : names) {
+        m_in >> name;
+    }
+    const auto schema = std::make_shared<const AttributesSchema>(names);
+
+    quint32 numEdges;
+    m_in >> numEdges;
+    if (m_in.status() != QDataStream::Ok) {
+        error += "unable to read the edges.";
+        return false;
+    }
+    for (quint32 i = 0; i < numEdges; ++i) {
+        qint32 id, originId, neighbourId;
+        m_in >> id >> originId >> neighbourId;
+        Attributes* attrs = new Attributes(schema);
+        for (quint32 attrId = 0; attrId < numAttrs; ++attrId) {
+            Value value;
+            m_in >> value;
+            attrs->setValue(static_cast<int>(attrId), value);
+        }
+
+        auto origin = graph->m_nodes.find(originId);
+        auto neighbour = graph->m_nodes.find(neighbourId);
+        if (m_in.status() != QDataStream::Ok || origin == graph->m_nodes.end()
+                || neighbour == graph->m_nodes.end()) {
+            delete attrs;
+            error += QString("unable to read the edge at position %1.").arg(i);
+            return false;
+        }
+        // keeps the same edge ids
+        graph->m_lastEdgeId = id - 1;
+        graph->addEdge(origin->second, neighbour->second, attrs);
+    }
+
+    // the neighbours are listed in the same order as before
+    auto readAdjacency = [this, graph](const Node& node, bool out) {
+        quint32 degree;
+        m_in >> degree;
+        if (m_in.status() != QDataStream::Ok || degree > graph->m_edges.size()) {
+            return false;
+        }
+        std::vector<int> edgeIds(degree);
+        for (int& id : edgeIds) {
+            qint32 edgeId;
+            m_in >> edgeId;
+            id = edgeId;
+        }
+        return m_in.status() == QDataStream::Ok && graph->reorderEdges(node, out, edgeIds);
+    };
+    for (size_t i = 0; i < graph->m_nodes.size(); ++i) {
+        const Node& node = graph->m_nodes.atIndex(static_cast<int>(i));
+        if (!readAdjacency(node, true) || (graph->isDirected() && !readAdjacency(node, false))) {
+            error += QString("unable to read the neighbours of the node %1.").arg(node.id());
+            return false;
+        }
+    }
+
+    qint32 lastNodeId, lastEdgeId;
+    m_in >> lastNodeId >> lastEdgeId;
+    if (m_in.status() != QDataStream::Ok) {
+        error += "unable to read the last ids.";
+        return false;
+    }
+    graph->m_lastNodeId = lastNodeId;
+    graph->m_lastEdgeId = lastEdgeId;
+
+    QByteArray prgState;
+    m_in >> prgState;
+    std::istringstream prgIn(prgState.toStdString());
+    prgIn >> prg->m_mteng;
+    if (m_in.status() != QDataStream::Ok || prgIn.fail()) {
+        error += "unable to read the state of the PRG.";
+        return false;
+    }
+
+    QByteArray modelState;
+    m_in >> model->m_time >> modelState;
+    QDataStream modelIn(modelState);
+    modelIn.setVersion(QDataStream::Qt_5_9);
+    if (m_in.status() != QDataStream::Ok || !model->loadState(modelIn)
+            || modelIn.status() != QDataStream::Ok) {
+        error += "unable to read the state of the model.";
+        return false;
+    }
+    return true;
+}
+
+} // evoplex
@@ -0,0 +1,99 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <memory>
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+
+#include "enum.h"
+#include "nodes.h"
+
+namespace evoplex {
+
+class AbstractGraph;
+class AbstractModel;
+class Experiment;
+class PRG;
+class Trial;
+
+/**
+ * @brief A binary snapshot of a trial, which allows resuming it later.
+ *
+ * It holds everything needed to carry on from the same step: the nodes
+ * (ids, coordinates and attributes), the edges (ids, ends and attributes),
+ * the order of the neighbours of each node, the next node and edge ids,
+ * the state of the trial's PRG, the model's own state (if any) and the
+ * size of the trial's output file at that step. The outputs must be
+ * flushed before taking a snapshot, so there are no pending cached rows.
+ *
+ * The file starts with a fingerprint of the experiment's inputs, so a
+ * checkpoint is only resumed by the same experiment and trial.
+ */
+class Checkpoint
+{
+public:
+    // serializes the current state of the trial
+    // it must be called between two steps, when the nodes are in sync
+    static QByteArray save(const Trial* trial, qint64 outputSize);
+
+    // writes 'data' to 'filePath' atomically, i.e., a previous
+    // checkpoint is only replaced if the new one is complete
+    // it is meant to run in a background thread
+    static bool write(const QString& filePath, const QByteArray& data);
+
+    // a hash of the inputs which define the trial's dynamics
+    static QByteArray fingerprint(const Experiment* exp, quint16 trialId);
+
+    // reads the checkpoint in 'filePath' and checks its header
+    // returns nullptr if it cannot be used by this trial
+    static std::unique_ptr<Checkpoint> open(const QString& filePath,
+            const QByteArray& fingerprint, QString& error);
+
+    inline int step() const;
+    inline qint64 outputSize() const;
+
+    // The functions below must be called in this order
+
+    // reads the nodes; returns empty if something goes wrong
+    Nodes readNodes(const GraphType& graphType, QString& error);
+    // reads the edges into the graph and the state of the prg and model
+    bool readState(AbstractGraph* graph, PRG* prg, AbstractModel* model, QString& error);
+
+private:
+    QByteArray m_data;
+    QDataStream m_in;
+    int m_step;
+    qint64 m_outputSize;
+
+    explicit Checkpoint(const QByteArray& data);
+};
+
+/************************************************************************
+   Checkpoint: Inline member functions
+ ************************************************************************/
+
+inline int Checkpoint::step() const
+{ return m_step; }
+
+inline qint64 Checkpoint::outputSize() const
+{ return m_outputSize; }
+
+} // evoplex
+#endif // CHECKPOINT_H
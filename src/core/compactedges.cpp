@@ -0,0 +1,101 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "compactedges.h"
+#include "edge_p.h"
+
+namespace evoplex {
+
+CompactEdges::CompactEdges(std::shared_ptr<Topology> topology, const Nodes& nodes)
+    : m_topology(std::move(topology))
+{
+    Q_ASSERT_X(m_topology->isValid() && m_topology->numNodes() == static_cast<int>(nodes.size()),
+               "CompactEdges", "the CSR view must be built from the nodes");
+
+    const int n = m_topology->numNodes();
+    m_nodes.reserve(static_cast<size_t>(n));
+    m_firstIds.reserve(static_cast<size_t>(n) + 1);
+    m_firstIds.emplace_back(0);
+    for (int i = 0; i < n; ++i) {
+        // unlike the contiguous array, the map does not move its nodes
+        m_nodes.emplace_back(&nodes.at(nodes.atIndex(i).id()));
+        int numOwned = 0;
+        const Topology::Span span = m_topology->outNeighbours(i);
+        for (int pos = 0; pos < span.size(); ++pos) {
+            numOwned += owns(i, pos) ? 1 : 0;
+        }
+        m_firstIds.emplace_back(m_firstIds.back() + numOwned);
+    }
+}
+
+int CompactEdges::edgeId(int nodeIdx, int pos, bool out) const
+{
+    const Topology::Span span = neighbours(nodeIdx, out);
+    const bool owned = m_topology->m_isDirected ? out : span[pos] >= nodeIdx;
+    if (owned) {
+        if (m_topology->m_isDirected) {
+            return m_firstIds[static_cast<size_t>(nodeIdx)] + pos;
+        }
+        int id = m_firstIds[static_cast<size_t>(nodeIdx)];
+        for (int i = 0; i < pos; ++i) {
+            id += owns(nodeIdx, i) ? 1 : 0;
+        }
+        return id;
+    }
+
+    // the edge belongs to the neighbour; if there are parallel edges,
+    // the k-th one listed here is the k-th one listed by the neighbour
+    const int neighbourIdx = span[pos];
+    const int k = static_cast<int>(std::count(span.begin(), span.begin() + pos, neighbourIdx));
+    const Topology::Span nSpan = m_topology->outNeighbours(neighbourIdx);
+    for (int i = 0, seen = 0; i < nSpan.size(); ++i) {
+        if (nSpan[i] == nodeIdx && seen++ == k) {
+            return edgeId(neighbourIdx, i, true);
+        }
+    }
+    qFatal("CompactEdges: the CSR view is not symmetric!");
+    return -1;
+}
+
+Edge CompactEdges::edge(int nodeIdx, int pos, bool out) const
+{
+    BaseEdge::constructor_key k;
+    const int neighbourIdx = neighbours(nodeIdx, out)[pos];
+    return Edge(std::make_shared<BaseEdge>(k, edgeId(nodeIdx, pos, out),
+                                           node(nodeIdx), node(neighbourIdx)));
+}
+
+bool CompactEdges::find(int edgeId, int& nodeIdx, int& pos) const
+{
+    if (edgeId < 0 || edgeId >= numEdges()) {
+        return false;
+    }
+    // the last node whose first id is not greater than 'edgeId'
+    auto it = std::upper_bound(m_firstIds.cbegin(), m_firstIds.cend(), edgeId);
+    nodeIdx = static_cast<int>(it - m_firstIds.cbegin()) - 1;
+    int rank = edgeId - m_firstIds[static_cast<size_t>(nodeIdx)];
+    const Topology::Span span = m_topology->outNeighbours(nodeIdx);
+    for (pos = 0; pos < span.size(); ++pos) {
+        if (owns(nodeIdx, pos) && rank-- == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // evoplex
@@ -0,0 +1,95 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMPACT_EDGES_H
+#define COMPACT_EDGES_H
+
+#include <memory>
+#include <vector>
+
+#include "edge.h"
+#include "nodes.h"
+#include "topology.h"
+
+namespace evoplex {
+
+/**
+ * @brief The edges of a static graph whose edges have no attributes.
+ * The edges are not stored one by one: the adjacency lists of the nodes
+ * are the spans of the frozen CSR topology (i.e., two ints per edge), and
+ * an Edge is only created when it is accessed through the Edges views.
+ *
+ * The edges are numbered following the CSR view. In a directed graph,
+ * the id of an edge is its position in the out-neighbours. In an
+ * undirected graph, each edge is in the spans of both nodes and it belongs
+ * to the node at the lowest position, so only the neighbours at the same
+ * or at a higher position are numbered.
+ */
+class CompactEdges
+{
+public:
+    // the topology must be valid and built from 'nodes'
+    explicit CompactEdges(std::shared_ptr<Topology> topology, const Nodes& nodes);
+
+    inline int numEdges() const;
+    inline const Topology& topology() const;
+    inline const Node& node(int nodeIdx) const;
+
+    // the span of out (or in) neighbours of the node at 'nodeIdx'
+    inline Topology::Span neighbours(int nodeIdx, bool out) const;
+
+    // the id of the edge at 'pos' in the span of the node at 'nodeIdx'
+    int edgeId(int nodeIdx, int pos, bool out) const;
+
+    // creates the edge at 'pos' in the span of the node at 'nodeIdx';
+    // the node is its origin
+    Edge edge(int nodeIdx, int pos, bool out) const;
+
+    // gets the position of the edge 'edgeId' in the out-neighbours of the
+    // node which owns it; returns false if there is no such edge
+    bool find(int edgeId, int& nodeIdx, int& pos) const;
+
+    // true if the edge at 'pos' in the out-neighbours of the node
+    // at 'nodeIdx' belongs to it; always true in directed graphs
+    inline bool owns(int nodeIdx, int pos) const;
+
+private:
+    std::shared_ptr<Topology> m_topology; // might be shared by other trials
+    std::vector<const Node*> m_nodes; // in the order of Nodes::atIndex()
+    std::vector<int> m_firstIds; // the id of the first edge of each node
+};
+
+/************************************************************************
+   CompactEdges: Inline member functions
+ ************************************************************************/
+
+inline int CompactEdges::numEdges() const
+{ return m_firstIds.back(); }
+
+inline const Topology& CompactEdges::topology() const
+{ return *m_topology; }
+
+inline const Node& CompactEdges::node(int nodeIdx) const
+{ return *m_nodes[static_cast<size_t>(nodeIdx)]; }
+
+inline Topology::Span CompactEdges::neighbours(int nodeIdx, bool out) const
+{ return out ? m_topology->outNeighbours(nodeIdx) : m_topology->inNeighbours(nodeIdx); }
+
+inline bool CompactEdges::owns(int nodeIdx, int pos) const
+{ return m_topology->m_isDirected || m_topology->outNeighbours(nodeIdx)[pos] >= nodeIdx; }
+
+} // evoplex
+#endif // COMPACT_EDGES_H
@@ -14,7 +14,12 @@
  * limitations under the License.
  */
 
+#include <new>
+#include <stdexcept>
+
 #include "include/edge.h"
+#include "include/edges.h"
+#include "compactedges.h"
 #include "edge_p.h"
 
 namespace evoplex {
@@ -25,7 +30,8 @@ BaseEdge::BaseEdge(const constructor_key&, int id, const Node& origin,
       m_origin(origin),
       m_neighbour(neighbour),
       m_attrs(attrs),
-      m_ownsAttrs(ownsAttrs)
+      m_ownsAttrs(ownsAttrs),
+      m_index(-1)
 {
 }
 
@@ -72,4 +78,246 @@ void Edge::setAttr(const int id, const Value& value)
 void Edge::addAttr(QString name, Value value)
 { m_ptr->addAttr(name, value); }
 
+/*******************/
+
+/*******************/
+
+Edges::const_iterator::const_iterator()
+    : m_edges(nullptr),
+      m_pos(0),
+      m_current(nullptr)
+{}
+
+Edges::const_iterator::const_iterator(std::unordered_map<int, Edge>::const_iterator it)
+    : m_it(it),
+      m_edges(nullptr),
+      m_pos(0),
+      m_current(nullptr)
+{}
+
+Edges::const_iterator::const_iterator(const Edges* edges, int pos)
+    : m_edges(edges),
+      m_pos(pos),
+      m_current(nullptr)
+{}
+
+Edges::const_iterator::const_iterator(const const_iterator& other)
+    : m_it(other.m_it),
+      m_edges(other.m_edges),
+      m_pos(other.m_pos),
+      m_current(nullptr)
+{}
+
+Edges::const_iterator& Edges::const_iterator::operator=(const const_iterator& other)
+{
+    if (this != &other) {
+        release();
+        m_it = other.m_it;
+        m_edges = other.m_edges;
+        m_pos = other.m_pos;
+    }
+    return *this;
+}
+
+Edges::const_iterator::~const_iterator()
+{ release(); }
+
+void Edges::const_iterator::release() const
+{
+    if (m_current) {
+        m_current->~value_type();
+        m_current = nullptr;
+    }
+}
+
+Edges::const_iterator::reference Edges::const_iterator::operator*() const
+{
+    if (!m_edges) {
+        return *m_it;
+    }
+    if (!m_current) {
+        const CompactEdges* compact = m_edges->m_compact;
+        Edge edge;
+        if (m_edges->m_nodeIdx < 0) {
+            // the graph's edges are listed by id
+            int nodeIdx, pos;
+            compact->find(m_pos, nodeIdx, pos);
+            edge = compact->edge(nodeIdx, pos, true);
+        } else {
+            edge = compact->edge(m_edges->m_nodeIdx, m_pos, m_edges->m_isOut);
+        }
+        m_current = new (&m_buf) value_type(edge.id(), edge);
+    }
+    return *m_current;
+}
+
+Edges::const_iterator::pointer Edges::const_iterator::operator->() const
+{ return &operator*(); }
+
+Edges::const_iterator& Edges::const_iterator::operator++()
+{
+    release();
+    if (m_edges) {
+        ++m_pos;
+    } else {
+        ++m_it;
+    }
+    return *this;
+}
+
+Edges::const_iterator Edges::const_iterator::operator++(int)
+{
+    const_iterator it(*this);
+    ++(*this);
+    return it;
+}
+
+bool Edges::const_iterator::operator==(const const_iterator& other) const
+{ return m_edges == other.m_edges && (m_edges ? m_pos == other.m_pos : m_it == other.m_it); }
+
+bool Edges::const_iterator::operator!=(const const_iterator& other) const
+{ return !(*this == other); }
+
+/*******************/
+
+Edges::Edges()
+    : m_compact(nullptr),
+      m_nodeIdx(-1),
+      m_isOut(true)
+{}
+
+Edge Edges::at(int edgeId) const
+{
+    if (!m_compact) {
+        return std::unordered_map<int, Edge>::at(edgeId);
+    }
+    int nodeIdx, pos;
+    if (m_nodeIdx < 0) {
+        if (m_compact->find(edgeId, nodeIdx, pos)) {
+            return m_compact->edge(nodeIdx, pos, true);
+        }
+    } else {
+        for (pos = 0; pos < static_cast<int>(size()); ++pos) {
+            if (m_compact->edgeId(m_nodeIdx, pos, m_isOut) == edgeId) {
+                return m_compact->edge(m_nodeIdx, pos, m_isOut);
+            }
+        }
+    }
+    throw std::out_of_range("Edges::at: there is no such edge");
+}
+
+Edges::const_iterator Edges::begin() const
+{ return m_compact ? const_iterator(this, 0) : const_iterator(std::unordered_map<int, Edge>::cbegin()); }
+
+Edges::const_iterator Edges::cbegin() const
+{ return begin(); }
+
+Edges::const_iterator Edges::end() const
+{
+    return m_compact ? const_iterator(this, static_cast<int>(size()))
+                     : const_iterator(std::unordered_map<int, Edge>::cend());
+}
+
+Edges::const_iterator Edges::cend() const
+{ return end(); }
+
+bool Edges::empty() const
+{ return size() == 0; }
+
+size_t Edges::size() const
+{
+    if (!m_compact) {
+        return std::unordered_map<int, Edge>::size();
+    }
+    return static_cast<size_t>(m_nodeIdx < 0 ? m_compact->numEdges()
+                                             : m_compact->neighbours(m_nodeIdx, m_isOut).size());
+}
+
+void Edges::addEdge(const Edge& edge)
+{
+    Q_ASSERT_X(!m_compact, "Edges", "a view of the CSR topology cannot be changed");
+    // a self-loop in an undirected graph is added twice (in and out)
+    if (std::unordered_map<int, Edge>::insert({edge.id(), edge}).second) {
+        edge.m_ptr->m_index = static_cast<int>(m_dense.size());
+        m_dense.emplace_back(edge);
+    }
+}
+
+void Edges::removeEdge(int edgeId)
+{
+    Q_ASSERT_X(!m_compact, "Edges", "a view of the CSR topology cannot be changed");
+    auto it = find(edgeId);
+    if (it == std::unordered_map<int, Edge>::end()) {
+        return;
+    }
+    // swap-remove
+    const auto idx = static_cast<size_t>(it->second.m_ptr->m_index);
+    if (idx + 1 < m_dense.size()) {
+        m_dense[idx] = m_dense.back();
+        m_dense[idx].m_ptr->m_index = static_cast<int>(idx);
+    }
+    m_dense.pop_back();
+    std::unordered_map<int, Edge>::erase(it);
+}
+
+void Edges::clearEdges()
+{
+    Q_ASSERT_X(!m_compact, "Edges", "a view of the CSR topology cannot be changed");
+    std::unordered_map<int, Edge>::clear();
+    m_dense.clear();
+}
+
+Edges::const_iterator Edges::eraseEdge(int edgeId)
+{
+    auto it = find(edgeId);
+    if (it == std::unordered_map<int, Edge>::end()) {
+        return end();
+    }
+    return const_iterator(std::unordered_map<int, Edge>::erase(it));
+}
+
+void Edges::setView(const CompactEdges* compact, int nodeIdx, bool out)
+{
+    Q_ASSERT_X((std::unordered_map<int, Edge>::empty()), "Edges", "the container must be empty");
+    m_compact = compact;
+    m_nodeIdx = nodeIdx;
+    m_isOut = out;
+}
+
+int Edges::idAt(int pos) const
+{
+    if (!m_compact) {
+        return m_dense[static_cast<size_t>(pos)].id();
+    }
+    return m_nodeIdx < 0 ? pos : m_compact->edgeId(m_nodeIdx, pos, m_isOut);
+}
+
+const Node& Edges::neighbourAt(int pos) const
+{
+    if (!m_compact) {
+        return m_dense[static_cast<size_t>(pos)].neighbour();
+    }
+    Q_ASSERT_X(m_nodeIdx >= 0, "Edges", "the graph's edges do not have a neighbour");
+    return m_compact->node(m_compact->neighbours(m_nodeIdx, m_isOut)[pos]);
+}
+
+bool Edges::reorder(const std::vector<int>& edgeIds)
+{
+    if (edgeIds.size() != m_dense.size()) {
+        return false;
+    }
+    for (const Edge& e : m_dense) {
+        e.m_ptr->m_index = -1;
+    }
+    for (size_t i = 0; i < edgeIds.size(); ++i) {
+        auto it = find(edgeIds[i]);
+        if (it == std::unordered_map<int, Edge>::end() || it->second.m_ptr->m_index != -1) {
+            return false;
+        }
+        it->second.m_ptr->m_index = static_cast<int>(i);
+        m_dense[i] = it->second;
+    }
+    return true;
+}
+
 } // evoplex
@@ -35,7 +35,11 @@ using EdgePtr = std::shared_ptr<BaseEdge>;
 class BaseEdge
 {
     friend class AbstractGraph;
+    friend class CompactEdges;
+    friend class Edges;
     friend class TestEdge;
+    friend class TestNode;
+    friend class TestTopology;
 
 private:
     struct constructor_key { /* this is a private key accessible only to friends */ };
@@ -78,6 +82,7 @@ private:
     const Node& m_neighbour;
     Attributes* m_attrs;
     const bool m_ownsAttrs;
+    int m_index; // position in the adjacency list of the node
 };
 
 /************************************************************************
@@ -15,6 +15,7 @@
  */
 
 #include <QDebug>
+#include <QFile>
 
 #include "experiment.h"
 #include "nodes.h"
@@ -33,11 +34,21 @@ Experiment::Experiment(MainApp* mainApp, const int id, ProjectWPtr project)
       m_graphType(GraphType::Invalid),
       m_numTrials(0),
       m_autoDeleteTrials(true),
+      m_cyclePeriod(0),
+      m_checkpointSteps(0),
+      m_binaryOutput(false),
+      m_saveSteps(0),
       m_stopAt(-1),
       m_pauseAt(-1),
       m_progress(0),
       m_delay(0),
-      m_expStatus(Status::Invalid)
+      m_expStatus(Status::Invalid),
+      m_nodesCreated(false),
+      m_topologyCreated(false),
+      m_pendingInits(0),
+      m_outstandingTrials(0),
+      m_trialFootprint(0),
+      m_memoryProbes(0)
 {
     Q_ASSERT_X(project.lock(), "Experiment", "an experiment must belong to a valid project");
 }
@@ -63,10 +74,16 @@ void Experiment::invalidate()
 void Experiment::deleteTrials()
 {
     for (auto& trial : m_trials) {
+        m_mainApp->expMgr()->trialDeleted(trial.second);
         delete trial.second;
     }
     m_trials.clear();
+    m_trialFootprint.fetchAndStoreRelaxed(0);
     m_clonableNodes.clear();
+    m_sharedTopology.reset();
+    m_nodesCreated = false;
+    m_topologyCreated = false;
+    m_pendingInits.fetchAndStoreRelaxed(0);
 }
 
 bool Experiment::setInputs(ExpInputsPtr inputs, QString& error)
@@ -102,6 +119,10 @@ bool Experiment::setInputs(ExpInputsPtr inputs, QString& error)
     }
 
     m_autoDeleteTrials = m_inputs->general(GENERAL_ATTR_AUTODELETE).toBool();
+    m_cyclePeriod = m_inputs->general(GENERAL_ATTR_CYCLEPERIOD).toInt();
+    m_checkpointSteps = m_inputs->general(GENERAL_ATTR_CHECKPOINT).toInt();
+    m_binaryOutput = m_inputs->general(OUTPUT_FORMAT).toQString() == "binary";
+    m_saveSteps = m_inputs->general(OUTPUT_SAVESTEPS).toInt();
     setStopAt(m_inputs->general(GENERAL_ATTR_STOPAT).toInt());
     setPauseAt(m_stopAt);
 
@@ -148,7 +169,12 @@ bool Experiment::reset(QString* error)
     } else if (m_expStatus == Status::Running || m_expStatus == Status::Queued) {
         erroMsg = "Tried to reset a running experiment.\n"
                   "Please, pause it and try again.";
-    } else if (m_expStatus == Status::Disabled) {
+    }
+
+    // a disabled experiment might resume from the last checkpoints;
+    // otherwise, the user wants to start it over
+    const bool restart = m_expStatus != Status::Disabled;
+    if (!restart && erroMsg.isEmpty()) {
         enable(erroMsg);
     }
 
@@ -164,12 +190,26 @@ bool Experiment::reset(QString* error)
     for (auto const& o : m_outputs) {
         o->flushAll();
     }
+    if (m_aggregator) {
+        m_aggregator->clear();
+    }
 
     deleteTrials();
+    {
+        QMutexLocker reasonsLocker(&m_stopReasonsMutex);
+        m_stopReasons.clear();
+    }
+    if (restart && !m_filePathPrefix.isEmpty()) {
+        for (quint16 trialId = 0; trialId < m_numTrials; ++trialId) {
+            QFile::remove(m_filePathPrefix + QString("%1.ckpt").arg(trialId));
+        }
+    }
+
     m_trials.reserve(static_cast<size_t>(m_numTrials));
     for (quint16 trialId = 0; trialId < m_numTrials; ++trialId) {
         m_trials.insert({trialId, new Trial(trialId, shared_from_this())});
     }
+    m_pendingInits.storeRelease(m_numTrials);
 
     m_expStatus = Status::Paused;
     emit (statusChanged(m_expStatus));
@@ -191,6 +231,10 @@ void Experiment::enable(QString& error)
     }
 
     if (m_inputs->fileCaches().empty()) {
+        if (m_checkpointSteps > 0) {
+            qWarning() << "the checkpoints are saved next to the output files,"
+                       << "but there are no file outputs. Experiment:" << m_id;
+        }
         return; // nothing to do
     }
 
@@ -206,6 +250,37 @@ void Experiment::enable(QString& error)
     }
     m_fileHeader.chop(1);
     m_fileHeader += "\n";
+
+    m_aggregator.reset();
+    if (m_inputs->general(OUTPUT_AVGTRIALS).toBool()) {
+        const QString path = QString("%1/%2_e%3_avg.csv")
+                .arg(m_inputs->general(OUTPUT_DIR).toQString(), project->name())
+                .arg(m_id);
+        m_aggregator.reset(new TrialsAggregator(path, m_fileHeader.trimmed().split(",")));
+    }
+
+    // the outputs kept in memory would be lost
+    if (m_checkpointSteps > 0 && (m_aggregator || m_inputs->general(OUTPUT_SAVESTEPS).toInt() > 0)) {
+        qWarning() << "the trials cannot be resumed from a checkpoint when their outputs"
+                   << "are averaged or only the last steps are saved. Experiment:" << m_id;
+    }
+}
+
+void Experiment::checkpoint()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_filePathPrefix.isEmpty()) {
+        qWarning() << "unable to save a checkpoint without file outputs. Experiment:" << m_id;
+        return;
+    }
+
+    for (auto const& t : m_trials) {
+        if (t.second->status() == Status::Running) {
+            t.second->requestCheckpoint();
+        } else if (t.second->status() == Status::Paused) {
+            t.second->saveCheckpoint();
+        }
+    }
 }
 
 const Trial* Experiment::trial(quint16 trialId) const
@@ -232,8 +307,19 @@ void Experiment::updateProgressValue()
     }
 }
 
+std::map<quint16, QString> Experiment::stopReasons() const
+{
+    QMutexLocker locker(&m_stopReasonsMutex);
+    return m_stopReasons;
+}
+
 void Experiment::trialFinished(Trial* trial)
 {
+    if (trial->status() == Status::Finished && !trial->stopReason().isEmpty()) {
+        QMutexLocker reasonsLocker(&m_stopReasonsMutex);
+        m_stopReasons[trial->id()] = trial->stopReason();
+    }
+
     QMutexLocker locker(&m_mutex);
     if (m_expStatus != Status::Invalid && trial->status() == Status::Invalid) {
         m_expStatus = Status::Invalid;
@@ -266,6 +352,10 @@ void Experiment::expFinished()
 
     if (allTrialsFinished) {
         m_expStatus = Status::Finished;
+        QString error;
+        if (m_aggregator && !m_aggregator->save(error)) {
+            qWarning() << error;
+        }
         if (m_autoDeleteTrials) {
             locker.unlock();
             disable(); // sets to Status::Disabled
@@ -313,23 +403,47 @@ void Experiment::playNext()
     play();
 }
 
-Nodes Experiment::cloneCachedNodes(const int trialId)
+Nodes Experiment::initialNodes()
 {
+    if (m_numTrials < 2) {
+        return createNodes();
+    }
+
+    QMutexLocker locker(&m_nodesLatch);
+    if (!m_nodesCreated) {
+        m_nodesCreated = true;
+        m_clonableNodes = createNodes();
+    }
+    locker.unlock();
+
+    // from now on, 'm_clonableNodes' is read-only until all trials
+    // have been initialized; so, it's safe to clone it concurrently
     if (m_clonableNodes.empty()) {
         return Nodes();
     }
+    return NodesPrivate::clone(m_clonableNodes);
+}
 
-    // if it's not the last trial, just take a copy of the nodes
-    for (auto const& it : m_trials) {
-        if (it.first != trialId && it.second->status() == Status::Disabled) {
-            return NodesPrivate::clone(m_clonableNodes);
-        }
+SharedTopologyPtr Experiment::sharedTopology(const std::function<SharedTopologyPtr()>& create)
+{
+    QMutexLocker locker(&m_topologyLatch);
+    if (!m_topologyCreated) {
+        m_topologyCreated = true;
+        m_sharedTopology = create();
     }
+    return m_sharedTopology;
+}
 
-    // it's the last trial, let's use the cloned nodes
-    Nodes nodes = m_clonableNodes;
-    Nodes().swap(m_clonableNodes);
-    return nodes;
+void Experiment::trialInitialized(Trial* trial, bool ok)
+{
+    m_mainApp->expMgr()->trialInitialized(trial, ok);
+
+    if (m_pendingInits.fetchAndSubOrdered(1) == 1) {
+        QMutexLocker nodesLocker(&m_nodesLatch);
+        Nodes().swap(m_clonableNodes);
+        QMutexLocker topologyLocker(&m_topologyLatch);
+        m_sharedTopology.reset();
+    }
 }
 
 AttrsGeneratorPtr Experiment::edgeAttrsGen(bool& ok) const
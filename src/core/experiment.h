@@ -17,11 +17,15 @@
 #ifndef EXPERIMENT_H
 #define EXPERIMENT_H
 
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <QAtomicInt>
 #include <QMutex>
 
 #include "attrsgenerator.h"
@@ -33,6 +37,8 @@
 #include "output.h"
 #include "graphplugin.h"
 #include "modelplugin.h"
+#include "sharedtopology.h"
+#include "trialsaggregator.h"
 
 namespace evoplex {
 
@@ -52,6 +58,9 @@ class Experiment : public QObject, public std::enable_shared_from_this<Experimen
 
     friend class ExperimentsMgr;
     friend class Project;
+    friend class TestCheckpoint;
+    friend class TestCompactEdges;
+    friend class TestParallelFor;
     friend class Trial;
 
 public:
@@ -97,9 +106,38 @@ public:
     inline bool autoDeleteTrials() const;
     inline void setAutoDeleteTrials(bool b);
 
+    // a trial finishes when the state repeats within this number of steps
+    // 0 means that the cycle detection is disabled
+    inline int cyclePeriod() const;
+
+    // each trial saves a checkpoint every n steps (next to its output file)
+    // 0 means that the checkpoints are only taken on demand
+    inline int checkpointSteps() const;
+
+    // true if the output files are in the binary format (see BinaryOutput)
+    inline bool binaryOutput() const;
+
+    // n>0 if only the last n steps of each trial are saved; they are
+    // written when the trial finishes; 0 means all steps
+    inline int saveSteps() const;
+
+    // merges the outputs of all trials if they are averaged, i.e., the
+    // trials do not write their own files; nullptr otherwise
+    inline const TrialsAggregator* aggregator() const;
+
+    // saves a checkpoint of all trials asap; the running trials save it
+    // after the current step, and the paused ones save it straight away
+    // it requires file outputs, which is where the checkpoints are saved
+    void checkpoint();
+
     const Trial* trial(quint16 trialId) const;
     inline const Trials& trials();
 
+    // the reasons why the trials finished before the 'stopAt' step
+    // (e.g., they reached a fixed point), by trial id; it is kept
+    // until the experiment is reset, even if the trials are deleted
+    std::map<quint16, QString> stopReasons() const;
+
     inline int id() const;
     inline ProjectPtr project() const;
     inline int numTrials() const;
@@ -149,18 +187,26 @@ private:
     GraphType m_graphType;
     int m_numTrials;
     bool m_autoDeleteTrials;
+    int m_cyclePeriod;
+    int m_checkpointSteps;
+    bool m_binaryOutput;
+    int m_saveSteps;
     int m_stopAt;
 
     QString m_fileHeader;   // file header is the same for all trials; let's save it then
     QString m_filePathPrefix;
+    std::unique_ptr<TrialsAggregator> m_aggregator;
     std::unordered_set<OutputPtr> m_outputs;
 
-    int m_pauseAt;
+    // the trials read them while they are initialized/running
+    std::atomic<int> m_pauseAt;
     quint16 m_progress; // current progress value [0, 360]
     quint16 m_delay;
-    Status m_expStatus;
+    std::atomic<Status> m_expStatus;
 
     Trials m_trials;
+    std::map<quint16, QString> m_stopReasons;
+    mutable QMutex m_stopReasonsMutex; // the trials finish concurrently
 
     // The trials are meant to have the same initial population.
     // So, considering that it might be a very expensive operation (eg, I/O),
@@ -169,13 +215,46 @@ private:
     // one trial.
     Nodes m_clonableNodes;
 
+    // Likewise, if the graph is deterministic, the topology created by
+    // the first trial is shared with the others (see SharedTopology).
+    SharedTopologyPtr m_sharedTopology;
+
+    // The trials are initialized concurrently, so the shared stuff above
+    // is created by the first trial which needs it, while the others wait
+    // for it (i.e., one-shot latches). It is released once all trials
+    // have been initialized.
+    QMutex m_nodesLatch;
+    bool m_nodesCreated;
+    QMutex m_topologyLatch;
+    bool m_topologyCreated;
+    QAtomicInt m_pendingInits;
+
+    // number of trials queued or running in the ExperimentsMgr; the
+    // experiment finishes when it drops to zero
+    QAtomicInt m_outstandingTrials;
+
+    // the largest memory footprint (KB) of the trials initialized so far
+    // (0 if unknown) and the number of trials being initialized to find
+    // it out; used by the ExperimentsMgr to keep its memory budget
+    QAtomicInt m_trialFootprint;
+    QAtomicInt m_memoryProbes;
+
     // Parse the edge attrs command and return an AttrsGenerator
     AttrsGeneratorPtr edgeAttrsGen(bool& ok) const;
 
-    // Return a clone of 'm_clonableNodes'. It also clear the 'm_clonableNodes'
-    // if 'trialId' is the last trial being created for this experiment.
-    // This method is NOT thread-safe.
-    Nodes cloneCachedNodes(const int trialId);
+    // Return a clone of the initial population, which is created on the
+    // first call. Return empty if the nodes could not be created.
+    // This method IS thread-safe.
+    Nodes initialNodes();
+
+    // Return the shared topology, which is created by 'create' on the
+    // first call (it might return nullptr if something goes wrong).
+    // This method IS thread-safe.
+    SharedTopologyPtr sharedTopology(const std::function<SharedTopologyPtr()>& create);
+
+    // trigged when a Trial has been initialized (successfully or not)
+    // also runs in a work thread
+    void trialInitialized(Trial* trial, bool ok);
 
     void deleteTrials();
 
@@ -241,6 +320,21 @@ inline bool Experiment::autoDeleteTrials() const
 inline void Experiment::setAutoDeleteTrials(bool b)
 { m_autoDeleteTrials = b; }
 
+inline int Experiment::cyclePeriod() const
+{ return m_cyclePeriod; }
+
+inline int Experiment::checkpointSteps() const
+{ return m_checkpointSteps; }
+
+inline bool Experiment::binaryOutput() const
+{ return m_binaryOutput; }
+
+inline int Experiment::saveSteps() const
+{ return m_saveSteps; }
+
+inline const TrialsAggregator* Experiment::aggregator() const
+{ return m_aggregator.get(); }
+
 inline int Experiment::id() const
 { return m_id; }
 
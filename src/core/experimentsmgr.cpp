@@ -25,7 +25,12 @@
 namespace evoplex {
 
 ExperimentsMgr::ExperimentsMgr()
-    : m_lastThreadPriority(INT32_MAX),
+    : m_outputWriter(qBound(1, QThread::idealThreadCount() / 4, 4)),
+      m_scheduler(&m_threadPool, QThread::idealThreadCount(),
+                  [this](Trial* trial) { return runTrial(trial); },
+                  [this](Trial* trial) { return admitTrial(trial); }),
+      m_runningTrials(0),
+      m_timeSlice(0),
       m_timerProgress(new QTimer(this))
 {
     resetSettingsToDefault();
@@ -33,15 +38,23 @@ ExperimentsMgr::ExperimentsMgr()
     m_threads = m_userPrefs.value("settings/threads", m_threads).toInt();
     m_threads = m_threads > QThread::idealThreadCount() ? QThread::idealThreadCount() : m_threads;
     m_threadPool.setMaxThreadCount(m_threads);
+    m_scheduler.setNumWorkers(m_threads);
     qDebug() << "setting the max number of threads to" << m_threads;
 
+    m_timeSlice.storeRelease(qMax(0, m_userPrefs.value("settings/timeSlice", timeSlice()).toInt()));
+    m_memory.setLimit(m_userPrefs.value("settings/memoryBudget", 0).toLongLong() * 1024);
+
+    bool ok;
+    const QString policy = m_userPrefs.value("settings/schedulingPolicy").toString();
+    m_scheduler.setPolicy(TrialScheduler::policyFromString(policy, ok));
+
     m_timerProgress->setSingleShot(true);
     connect(m_timerProgress, SIGNAL(timeout()), SLOT(updateProgressValues()));
 }
 
 ExperimentsMgr::~ExperimentsMgr()
 {
-    m_threadPool.clear();
+    m_scheduler.shutdown();
     m_threadPool.waitForDone();
     delete m_timerProgress;
 }
@@ -49,6 +62,7 @@ ExperimentsMgr::~ExperimentsMgr()
 void ExperimentsMgr::resetSettingsToDefault()
 {
     m_threads = QThread::idealThreadCount();
+    m_timeSlice.storeRelease(0);
 }
 
 void ExperimentsMgr::updateProgressValues()
@@ -90,97 +104,162 @@ void ExperimentsMgr::_play(ExperimentPtr exp)
     }
 
     // iterate by id to maintain id order
+    std::vector<Trial*> trials;
+    trials.reserve(exp->trials().size());
     for (quint16 id = 0; id < exp->trials().size(); ++id) {
         Trial* trial = exp->trials().at(id);
         if (trial->status() != Status::Disabled) {
             trial->m_status = Status::Queued;
         }
-        m_queuedTrials.emplace_back(trial);
+        trials.emplace_back(trial);
     }
+    exp->m_outstandingTrials.fetchAndAddOrdered(static_cast<int>(trials.size()));
 
     locker.unlock();
-    processQueue();
+    m_scheduler.submit(trials);
 }
 
-void ExperimentsMgr::trialFinished(Trial* trial)
+bool ExperimentsMgr::runTrial(Trial* trial)
 {
-    QMutexLocker locker(&m_mutex);
+    Experiment* exp = trial->m_exp.get();
+
+    // checks if we really need to run this trial
+    // a trial which yielded must run anyway to close its loop
+    if (!trial->m_inLoop && (exp->expStatus() == Status::Invalid ||
+            exp->expStatus() == Status::Finished ||
+            exp->pauseAt() < 0)) { // is paused
+        cancelReservation(trial);
+        trialFinished(trial);
+        return false;
+    }
+
+    // checks if this is the first time we run this experiment
+    if (exp->expStatus() != Status::Running) {
+        QMutexLocker locker(&m_mutex);
+        if (exp->expStatus() == Status::Queued) {
+            exp->setExpStatus(Status::Running);
+            m_running.emplace_back(trial->m_exp);
+            m_queued.remove(trial->m_exp);
+        } else if (exp->expStatus() != Status::Running) {
+            // it has been removed from the queue in the meantime
+            locker.unlock();
+            cancelReservation(trial);
+            trialFinished(trial);
+            return false;
+        }
+    }
 
-    m_runningTrials.remove(trial);
-    if (isTheLastTrial(trial)) {
-        ExperimentPtr exp = trial->m_exp;
+    m_runningTrials.fetchAndAddOrdered(1);
+    const bool yielded = trial->runSlice(m_timeSlice.loadAcquire());
+    m_runningTrials.fetchAndSubOrdered(1);
+    return yielded;
+}
 
-        locker.unlock();
-        exp->expFinished(); // might delete all trials
-        locker.relock();
+bool ExperimentsMgr::admitTrial(Trial* trial)
+{
+    // only the trials which are about to be initialized need more memory
+    if (m_memory.limit() <= 0 || trial->status() != Status::Disabled) {
+        return true;
+    }
 
-        m_running.remove(exp);
-        emit (progressUpdated());
+    Experiment* exp = trial->m_exp.get();
+    if (exp->expStatus() == Status::Invalid || exp->pauseAt() < 0) {
+        return true; // it'll not run anyway
+    }
 
-        if (exp->expStatus() != Status::Invalid && exp->expStatus() != Status::Disabled) {
-            m_idle.emplace_back(exp);
-        }
+    // at least one trial must be running
+    const bool force = m_runningTrials.loadAcquire() == 0 && m_memory.numReservations() == 0;
 
-        if (m_running.empty() && m_queued.empty()) {
-            m_lastThreadPriority = INT32_MAX; // reset priority
-        }
+    // the footprint is unknown until the first trial of the experiment has
+    // been initialized; meanwhile, the other trials wait for it
+    const int footprint = exp->m_trialFootprint.loadAcquire();
+    if (footprint == 0 && exp->m_memoryProbes.loadAcquire() > 0 && !force) {
+        return false;
     }
 
-    locker.unlock();
-    processQueue();
+    if (!m_memory.tryReserve(footprint, force)) {
+        return false;
+    }
+
+    trial->m_memoryKB = footprint;
+    trial->m_memoryProbe = footprint == 0;
+    if (trial->m_memoryProbe) {
+        exp->m_memoryProbes.fetchAndAddOrdered(1);
+    }
+    return true;
 }
 
-bool ExperimentsMgr::isTheLastTrial(const Trial* trial)
+void ExperimentsMgr::cancelReservation(Trial* trial)
 {
-    for (auto const& t : m_runningTrials) {
-        if (t->m_exp == trial->m_exp)
-            return false;
+    if (trial->m_memoryKB < 0 || trial->status() != Status::Disabled) {
+        return;
     }
-    for (auto const& t : m_queuedTrials) {
-        if (t->m_exp == trial->m_exp)
-            return false;
+
+    if (trial->m_memoryProbe) {
+        trial->m_memoryProbe = false;
+        trial->m_exp->m_memoryProbes.fetchAndSubOrdered(1);
     }
-    return true;
+    m_memory.unreserve(trial->m_memoryKB);
+    trial->m_memoryKB = -1;
+    m_scheduler.wakeUp();
 }
 
-void ExperimentsMgr::processQueue()
+void ExperimentsMgr::trialInitialized(Trial* trial, bool ok)
 {
-    QMutexLocker locker(&m_mutex);
-    if (static_cast<int>(m_runningTrials.size()) < m_threads) {
-        Trial* trial = nullptr;
-        while (!trial && !m_queuedTrials.empty()) {
-            trial = m_queuedTrials.front();
-            m_queuedTrials.pop_front();
-        }
+    if (trial->m_memoryKB < 0) {
+        return; // it has not been accounted in the memory budget
+    }
+
+    Experiment* exp = trial->m_exp.get();
+    if (trial->m_memoryProbe) {
+        trial->m_memoryProbe = false;
+        exp->m_memoryProbes.fetchAndSubOrdered(1);
+    }
 
-        if (!trial) {
-            return;
+    if (ok) {
+        const int footprint = static_cast<int>(MemoryBudget::trialFootprint(trial));
+        // keep the largest footprint seen so far
+        int current = exp->m_trialFootprint.loadAcquire();
+        while (footprint > current && !exp->m_trialFootprint.testAndSetOrdered(current, footprint)) {
+            current = exp->m_trialFootprint.loadAcquire();
         }
+        m_memory.commit(trial->m_memoryKB, footprint);
+        trial->m_memoryKB = footprint;
+    } else {
+        m_memory.unreserve(trial->m_memoryKB);
+        trial->m_memoryKB = -1;
+    }
 
-        Experiment* exp = trial->m_exp.get();
+    // the deferred trials might fit now (or have a known footprint)
+    m_scheduler.wakeUp();
+}
 
-        // checks if we really need to run this trial
-        if (!exp || exp->expStatus() == Status::Invalid ||
-                exp->expStatus() == Status::Finished ||
-                exp->pauseAt() < 0) { // is paused
-            locker.unlock();
-            trialFinished(trial);
-            return;
-        }
+void ExperimentsMgr::trialDeleted(Trial* trial)
+{
+    if (trial->m_memoryKB < 0) {
+        return;
+    }
+    m_memory.release(trial->m_memoryKB);
+    trial->m_memoryKB = -1;
+    m_scheduler.wakeUp();
+}
 
-        // checks if this is the first time we run this experiment
-        if (exp->expStatus() != Status::Running) {
-            exp->setExpStatus(Status::Running);
-            m_running.emplace_back(trial->m_exp);
-            m_queued.remove(trial->m_exp);
-        }
+void ExperimentsMgr::trialFinished(Trial* trial)
+{
+    // the trials might be deleted by expFinished()
+    ExperimentPtr exp = trial->m_exp;
+    if (exp->m_outstandingTrials.fetchAndSubOrdered(1) != 1) {
+        return; // it's not the last trial
+    }
+
+    exp->expFinished(); // might delete all trials
 
-        m_runningTrials.emplace_back(trial);
-        // play in the same order of insertion
-        m_threadPool.start(trial, m_lastThreadPriority--);
+    QMutexLocker locker(&m_mutex);
+    m_running.remove(exp);
+    emit (progressUpdated());
 
-        locker.unlock();
-        processQueue();
+    if (exp->expStatus() != Status::Invalid && exp->expStatus() != Status::Disabled) {
+        m_idle.emplace_back(exp);
     }
 }
 
@@ -196,14 +275,8 @@ void ExperimentsMgr::removeFromQueue(const ExperimentPtr& exp)
     QMutexLocker locker(&m_mutex);
     if (exp->expStatus() == Status::Queued) {
         m_queued.remove(exp);
-        auto it = m_queuedTrials.begin();
-        while (it != m_queuedTrials.end()) {
-            if ((*it)->m_exp == exp) {
-                it = m_queuedTrials.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        const int removed = m_scheduler.remove(exp.get());
+        exp->m_outstandingTrials.fetchAndSubOrdered(removed);
         exp->setExpStatus(Status::Paused);
     }
 }
@@ -224,7 +297,7 @@ void ExperimentsMgr::clearQueue()
     m_queued.clear();
 }
 
-void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error)
+void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error, bool savePrefs)
 {
     if (m_threads == newValue) {
         return;
@@ -239,16 +312,11 @@ void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error)
         return;
     }
 
+    // the running trials are not interrupted; if there are more
+    // workers than threads, they quit at the end of their time slice
     QMutexLocker locker(&m_mutex);
-    if (!m_running.empty() || !m_queued.empty()) {
-        QString e("Cannot set the number of threads while running experiments."
-                  " Please, pause all your experiments and try again.");
-        if (error) *error = e;
-        qWarning() << e;
-        return;
-    }
-
     m_threadPool.setMaxThreadCount(newValue);
+    m_scheduler.setNumWorkers(newValue);
     if (newValue != m_threadPool.maxThreadCount()) {
         QString e("Could not set the number of threads to %1.\n"
                   "Assigning the maximum value available: %2.");
@@ -260,7 +328,62 @@ void ExperimentsMgr::setMaxThreadCount(int newValue, QString* error)
              << m_threads << "to" << newValue;
 
     m_threads = newValue;
-    m_userPrefs.setValue("settings/threads", m_threads);
+    if (savePrefs) {
+        m_userPrefs.setValue("settings/threads", m_threads);
+    }
+}
+
+void ExperimentsMgr::setTimeSlice(const int msecs, QString* error, bool savePrefs)
+{
+    if (msecs < 0) {
+        QString e = QString("The time slice is invalid! It should be a"
+                " positive number of msecs (or 0 to disable it).\nTried: %1").arg(msecs);
+        if (error) *error = e;
+        qWarning() << e;
+        return;
+    }
+
+    // it's read by the workers at the start of each slice
+    m_timeSlice.storeRelease(msecs);
+    if (savePrefs) {
+        m_userPrefs.setValue("settings/timeSlice", msecs);
+    }
+}
+
+void ExperimentsMgr::setMemoryBudget(const int mbytes, QString* error, bool savePrefs)
+{
+    if (mbytes < 0) {
+        QString e = QString("The memory budget is invalid! It should be a"
+                " positive number of MB (or 0 for no limit).\nTried: %1").arg(mbytes);
+        if (error) *error = e;
+        qWarning() << e;
+        return;
+    }
+
+    m_memory.setLimit(static_cast<qint64>(mbytes) * 1024);
+    if (savePrefs) {
+        m_userPrefs.setValue("settings/memoryBudget", mbytes);
+    }
+    m_scheduler.wakeUp(); // the budget might be larger now
+}
+
+void ExperimentsMgr::setSchedulingPolicy(TrialScheduler::Policy policy,
+                                         QString* error, bool savePrefs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_running.empty() || !m_queued.empty()) {
+        QString e("Cannot set the scheduling policy while running experiments."
+                  " Please, pause all your experiments and try again.");
+        if (error) *error = e;
+        qWarning() << e;
+        return;
+    }
+
+    m_scheduler.setPolicy(policy);
+    if (savePrefs) {
+        m_userPrefs.setValue("settings/schedulingPolicy",
+                             TrialScheduler::policyToString(policy));
+    }
 }
 
 } // evoplex
@@ -26,6 +26,10 @@
 #include <QSettings>
 #include <QThreadPool>
 
+#include "memorybudget.h"
+#include "outputwriter.h"
+#include "trialscheduler.h"
+
 namespace evoplex {
 
 class Trial;
@@ -45,12 +49,41 @@ public:
     void play(ExperimentPtr exp);
 
     inline int maxThreadsCount() const { return m_threads; }
-    void setMaxThreadCount(const int newValue, QString* error=nullptr);
+    // set the max number of threads; if 'savePrefs' is true, the new
+    // value is also stored in the user preferences
+    void setMaxThreadCount(const int newValue, QString* error=nullptr,
+                           bool savePrefs=true);
+
+    // the max time (msecs) a trial runs before giving way to the other
+    // queued trials; 0 means that a trial runs until it's paused/finished
+    inline int timeSlice() const { return m_timeSlice.loadAcquire(); }
+    // if 'savePrefs' is true, the new value is also stored in the user preferences
+    void setTimeSlice(const int msecs, QString* error=nullptr, bool savePrefs=true);
+
+    // the max amount of memory (MB) the trials might use; the queued trials
+    // are deferred while starting them would exceed it, but at least one
+    // trial is always running; 0 means no limit
+    inline int memoryBudget() const { return static_cast<int>(m_memory.limit() / 1024); }
+    // if 'savePrefs' is true, the new value is also stored in the user preferences
+    void setMemoryBudget(const int mbytes, QString* error=nullptr, bool savePrefs=true);
+
+    // the order in which the queued trials are run
+    inline TrialScheduler::Policy schedulingPolicy() const;
+    // it can only be changed when there are no queued trials; if
+    // 'savePrefs' is true, the new value is also stored in the user preferences
+    void setSchedulingPolicy(TrialScheduler::Policy policy, QString* error=nullptr,
+                             bool savePrefs=true);
 
     // trigged when a Trial ends
     // also runs in a work thread
     void trialFinished(Trial* trial);
 
+    // trigged when a Trial has been initialized (successfully or not)
+    // also runs in a work thread
+    void trialInitialized(Trial* trial, bool ok);
+    // trigged right before a Trial is deleted
+    void trialDeleted(Trial* trial);
+
     void remove(const ExperimentPtr& exp);
     void removeFromQueue(const ExperimentPtr& exp);
     void removeFromIdle(const ExperimentPtr& exp);
@@ -65,27 +98,44 @@ private slots:
     void updateProgressValues();
 
 private:
+    friend class TestParallelFor;
+    friend class Trial;
+
     QThreadPool m_threadPool;
-    QMutex m_mutex;
+    MemoryBudget m_memory;
+    OutputWriter m_outputWriter; // shared by all trials
+    TrialScheduler m_scheduler;
+    QAtomicInt m_runningTrials; // number of trials running a slice
+    QMutex m_mutex; // guards the lists of experiments below
     QSettings m_userPrefs;
     int m_threads;
-    int m_lastThreadPriority;
+    QAtomicInt m_timeSlice; // set by the GUI thread, read by the workers
 
     QTimer* m_timerProgress; // update the progress value of all running experiments
 
-    std::list<Trial*> m_runningTrials;
-    std::list<Trial*> m_queuedTrials;
-
     std::list<ExperimentPtr> m_running;
     std::list<ExperimentPtr> m_queued;
     std::list<ExperimentPtr> m_idle;
 
     void _play(ExperimentPtr exp);
 
-    void processQueue();
+    // called by the scheduler in a work thread
+    // Returns true if the trial yielded and must be requeued
+    bool runTrial(Trial* trial);
 
-    bool isTheLastTrial(const Trial* trial);
+    // called by the scheduler before starting a trial
+    // Returns true if it fits in the memory budget
+    bool admitTrial(Trial* trial);
+    // gives back the memory reserved for a trial which will not be initialized
+    void cancelReservation(Trial* trial);
 };
 
+/************************************************************************
+   ExperimentsMgr: Inline member functions
+ ************************************************************************/
+
+inline TrialScheduler::Policy ExperimentsMgr::schedulingPolicy() const
+{ return m_scheduler.policy(); }
+
 } // evoplex
 #endif // EXPERIMENTMGR_H
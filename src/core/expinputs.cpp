@@ -106,6 +106,31 @@ ExpInputsPtr ExpInputs::parse(const MainApp* mainApp, const QStringList& header,
     parseAttrs(ei.get(), mainApp, header, values, failedAttrs);
     parseFileCache(ei.get(), failedAttrs, errMsg);
 
+    // optional attributes might be missing in older projects
+    auto setDefault = [&ei, mainApp](const QString& attrName, const Value& value) {
+        if (!ei->m_generalAttrs->contains(attrName)) {
+            const int id = mainApp->generalAttrsScope().value(attrName)->id();
+            ei->m_generalAttrs->replace(id, attrName, value);
+        }
+    };
+    setDefault(GENERAL_ATTR_CYCLEPERIOD, 0);
+    setDefault(GENERAL_ATTR_CHECKPOINT, 0);
+    setDefault(OUTPUT_FORMAT, "csv");
+    setDefault(OUTPUT_AVGTRIALS, false);
+    setDefault(OUTPUT_SAVESTEPS, 0);
+
+    // the same for the attributes added in newer versions of the plugins
+    auto setPluginDefaults = [](Attributes* attrs, const Plugin* plugin) {
+        for (auto const& attrRange : plugin->pluginAttrsScope()) {
+            const Value value = plugin->pluginAttrDefault(attrRange->attrName());
+            if (value.isValid() && !attrs->contains(attrRange->attrName())) {
+                attrs->replace(attrRange->id(), attrRange->attrName(), value);
+            }
+        }
+    };
+    setPluginDefaults(ei->m_graphAttrs, graph);
+    setPluginDefaults(ei->m_modelAttrs, model);
+
     // make sure all attributes exist
     auto checkAll = [&failedAttrs](Attributes* attrs, const AttributesScope& attrsScope) {
         for (auto const& attrRange : attrsScope) {
@@ -253,6 +278,27 @@ void ExpInputs::parseFileCache(ExpInputs* ei, QStringList& failedAttrs, QString&
             failedAttrs.append(OUTPUT_HEADER);
         }
 
+        // the binary files only hold numbers; the built-in functions
+        // always give them, but the type of the custom outputs is only
+        // known when the model runs
+        const QString format = ei->m_generalAttrs->value(OUTPUT_FORMAT, Value("csv")).toQString();
+        if (format == "binary") {
+            for (Cache* cache : ei->m_fileCaches) {
+                if (std::dynamic_pointer_cast<CustomOutput>(cache->output())) {
+                    errMsg += "The binary output format only supports numeric outputs. "
+                              "Please, use csv to save custom outputs!\n";
+                    failedAttrs.append(OUTPUT_FORMAT);
+                    break;
+                }
+            }
+        }
+
+        // keep only the last n steps
+        const int saveSteps = ei->m_generalAttrs->value(OUTPUT_SAVESTEPS, Value(0)).toInt();
+        for (Cache* cache : ei->m_fileCaches) {
+            cache->setCapacity(saveSteps);
+        }
+
         QFileInfo outDir(ei->m_generalAttrs->value(OUTPUT_DIR, Value("")).toQString());
         if (!outDir.isDir() || !outDir.isWritable()) {
             errMsg += "The output directory must be valid and writable!\n";
@@ -28,6 +28,8 @@ using ExpInputsPtr = std::unique_ptr<ExpInputs>;
 
 class ExpInputs
 {
+    friend class TestCheckpoint;
+
 public:
     // Read and validate the experiment inputs.
     // We assume that all graph/model attributes start with 'uid_'. It is very
@@ -35,12 +35,14 @@ public:
 
     inline const GraphTypes& validGraphTypes() const;
     inline bool supportsEdgeAttrsGen() const;
+    inline bool isDeterministic() const;
 
 protected:
     explicit GraphPlugin(QPluginLoader* loader, const QString& libPath);
 
 private:
     bool m_supportsEdgeAttrsGen;
+    bool m_isDeterministic;
     std::vector<GraphType> m_validGraphTypes;
 };
 
@@ -54,5 +56,8 @@ inline const GraphPlugin::GraphTypes& GraphPlugin::validGraphTypes() const
 inline bool GraphPlugin::supportsEdgeAttrsGen() const
 { return m_supportsEdgeAttrsGen; }
 
+inline bool GraphPlugin::isDeterministic() const
+{ return m_isDeterministic; }
+
 } //evoplex
 #endif // GRAPHPLUGIN_H
@@ -24,7 +24,9 @@
 #include "attrsgenerator.h"
 #include "edges.h"
 #include "enum.h"
+#include "nodecolumns.h"
 #include "nodes.h"
+#include "topology.h"
 
 namespace evoplex {
 
@@ -53,6 +55,13 @@ public:
  */
 class AbstractGraph : public AbstractGraphInterface
 {
+    friend class Checkpoint;
+    friend class SharedTopology;
+    friend class TestCheckpoint;
+    friend class TestCompactEdges;
+    friend class TestParallelFor;
+    friend class TestSharedTopology;
+    friend class TestUpdateModes;
     friend class Trial;
 
 public:
@@ -89,7 +98,7 @@ public:
      * @param edgeId A valid edge id.
      * @throw std::out_of_range if no such data is present.
      */
-    inline const Edge& edge(int edgeId) const;
+    inline Edge edge(int edgeId) const;
 
     /**
      * @brief Returns the Edge that connects \p originId to \p neighbourId.
@@ -97,7 +106,7 @@ public:
      * @param neighbourId A valid node id.
      * @throw std::out_of_range if no such data is present.
      */
-    inline const Edge& edge(int originId, int neighbourId) const;
+    inline Edge edge(int originId, int neighbourId) const;
 
     /**
      * @brief Gets the nodes.
@@ -127,6 +136,56 @@ public:
      */
     inline int numEdges() const;
 
+    /**
+     * @brief Gets a frozen CSR view of the graph's topology.
+     * The view is built after reset() and it becomes invalid once the graph
+     * is modified; it is rebuilt before the next step, so it is mostly
+     * useful for static graphs.
+     * If the edges have no attributes, the graph keeps only this view after
+     * reset(): the edges are renumbered following it and the Edges become
+     * views of it. They are recreated (keeping their ids) once the graph
+     * is modified.
+     * @see Topology::isValid()
+     */
+    inline const Topology& topology() const;
+
+    /**
+     * @brief Gets the node attribute \p attrId stored in a contiguous array.
+     * The column is created and filled with the nodes' values on the first
+     * call, and it is indexed by the nodes' positions (Nodes::atIndex()).
+     * While a column exists, the attribute should be changed only through it;
+     * the nodes' Attributes are updated by syncNodeColumns().
+     * Adding/removing nodes invalidates the columns obtained before; they
+     * are reloaded once at the end of the step, or by calling this again.
+     * @tparam T bool, char, double or int; it must match the attribute's type.
+     * @return nullptr if the attribute does not exist or if its type is not T.
+     */
+    template<typename T>
+    inline NodeColumn<T>* nodeColumn(int attrId);
+
+    /**
+     * @brief Gets the double-buffered column of the node attribute \p attrId.
+     * It is meant for synchronous updates: at each step, the model reads the
+     * current values and writes the next value of every node with
+     * NodeColumn::setNext() (or NodeColumn::nextData()). The buffers are
+     * swapped in constant time right after AbstractModel::algorithmStep().
+     * @copydetails nodeColumn()
+     */
+    template<typename T>
+    inline NodeColumn<T>* nodeBuffer(int attrId);
+
+    /**
+     * @brief Gets the node columns.
+     */
+    inline const NodeColumns& nodeColumns() const;
+
+    /**
+     * @brief Writes the modified node columns back to the nodes' Attributes.
+     * It is called when the trial pauses, and before custom outputs
+     * or the GUI read the nodes.
+     */
+    void syncNodeColumns();
+
     /**
      * @brief Creates a Node with \p attrs and adds it into the graph.
      * @returns the new Node
@@ -215,11 +274,29 @@ private:
     int m_lastNodeId;
     int m_lastEdgeId;
     QMutex m_mutex;
-
-    std::uniform_int_distribution<int> m_numNodesDist;
+    std::shared_ptr<Topology> m_topology; // might be shared by other trials
+    std::shared_ptr<CompactEdges> m_compactEdges; // not null if the edges are views
+    NodeColumns m_nodeColumns;
+
+    // builds the CSR view of the current topology
+    void freezeTopology();
+    // invalidates the CSR view; a shared view is left untouched
+    // the edges dropped by compactEdges() are recreated first
+    void clearTopology();
+
+    // if the edges have no attributes, drops them and makes the
+    // Edges containers views of the CSR view, which must be valid
+    void compactEdges();
+    // makes the Edges containers plain containers again; the edges are
+    // recreated in the same order only if 'recreate' is true
+    void thawEdges(bool recreate);
 
     bool setup(Trial& trial, AttrsGeneratorPtr edgeGen,
                const Attributes& attrs, Nodes& nodes);
+
+    // sets the order of the node's out (or in) edges, i.e., the order
+    // of its neighbours; returns false if 'edgeIds' are not its edges
+    bool reorderEdges(const Node& node, bool out, const std::vector<int>& edgeIds);
 };
 
 
@@ -239,10 +316,10 @@ inline const Edges& AbstractGraph::edges() const
 inline const Nodes& AbstractGraph::nodes() const
 { return m_nodes; }
 
-inline const Edge& AbstractGraph::edge(int edgeId) const
+inline Edge AbstractGraph::edge(int edgeId) const
 { return m_edges.at(edgeId); }
 
-inline const Edge& AbstractGraph::edge(int originId, int neighbourId) const
+inline Edge AbstractGraph::edge(int originId, int neighbourId) const
 { return m_nodes.at(originId).outEdges().at(neighbourId); }
 
 inline Node AbstractGraph::node(int nodeId) const
@@ -251,6 +328,20 @@ inline Node AbstractGraph::node(int nodeId) const
 inline int AbstractGraph::numEdges() const
 { return static_cast<int>(m_edges.size()); }
 
+inline const Topology& AbstractGraph::topology() const
+{ return *m_topology; }
+
+template<typename T>
+inline NodeColumn<T>* AbstractGraph::nodeColumn(int attrId)
+{ return m_nodeColumns.get<T>(m_nodes, attrId); }
+
+template<typename T>
+inline NodeColumn<T>* AbstractGraph::nodeBuffer(int attrId)
+{ return m_nodeColumns.getBuffered<T>(m_nodes, attrId); }
+
+inline const NodeColumns& AbstractGraph::nodeColumns() const
+{ return m_nodeColumns; }
+
 inline int AbstractGraph::numNodes() const
 { return static_cast<int>(m_nodes.size()); }
 
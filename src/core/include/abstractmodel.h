@@ -17,13 +17,17 @@
 #ifndef ABSTRACT_MODEL_H
 #define ABSTRACT_MODEL_H
 
+#include <functional>
 #include <memory.h>
 #include <vector>
+#include <QDataStream>
 
 #include "abstractplugin.h"
 #include "abstractgraph.h"
 #include "edges.h"
+#include "enum.h"
 #include "nodes.h"
+#include "ratetree.h"
 
 namespace evoplex {
 
@@ -52,6 +56,28 @@ public:
      */
     virtual bool algorithmStep() = 0;
 
+    /**
+     * @brief Gets the rate at which events happen to the node at
+     *        position @p nodeIdx (see Nodes::atIndex()).
+     *
+     * It is only used in the UpdateMode::Gillespie mode, and it must be
+     * non-negative. After each event, the rates of the node and of its
+     * neighbours are queried again, so the rate of a node should only
+     * depend on its own state and on the state of its neighbours.
+     * The default implementation of this function returns 1.0.
+     */
+    virtual double nodeRate(int nodeIdx) const = 0;
+
+    /**
+     * @brief Performs one event (e.g., a state transition) on the node at
+     *        position @p nodeIdx (see Nodes::atIndex()).
+     *
+     * It is only used in the UpdateMode::RandomSequential and
+     * UpdateMode::Gillespie modes.
+     * The default implementation of this function does nothing.
+     */
+    virtual void nodeEvent(int nodeIdx) = 0;
+
     /**
      * @brief It is executed after the algorithmStep() loop ends.
      * The default implementation of this function does nothing.
@@ -69,6 +95,41 @@ public:
      * @return the Value output for each of the \p inputs
      */
     virtual Values customOutputs(const Values& inputs) const = 0;
+
+    /**
+     * @brief Writes back the state kept by the model in its own data
+     *        structures (e.g., a bit-packed lattice) into the node columns.
+     *
+     * It is called only when the nodes are about to be read, i.e., before
+     * the outputs of each step, when the GUI asks for a refresh and when
+     * the trial pauses. So, a model is free to keep the nodes' states
+     * elsewhere in between.
+     * The default implementation of this function does nothing.
+     * @see AbstractGraph::nodeColumn()
+     */
+    virtual void syncNodes() = 0;
+
+    /**
+     * @brief Writes the state kept by the model between steps to \p out.
+     *
+     * It is called when a checkpoint of the trial is taken, right after
+     * syncNodes(). The nodes, edges and the PRG are stored by Evoplex, so
+     * only the state which cannot be rebuilt from them (e.g., counters or
+     * histories) needs to be written here.
+     * The default implementation of this function does nothing.
+     * @see loadState()
+     */
+    virtual void saveState(QDataStream& out) const = 0;
+
+    /**
+     * @brief Reads the state written by saveState() from \p in.
+     *
+     * It is called when a trial is resumed from a checkpoint, after init()
+     * and before beforeLoop().
+     * The default implementation of this function does nothing.
+     * @return true if successful.
+     */
+    virtual bool loadState(QDataStream& in) = 0;
 };
 
 /**
@@ -77,6 +138,9 @@ public:
  */
 class AbstractModel : public AbstractModelInterface
 {
+    friend class Checkpoint;
+    friend class TestCheckpoint;
+    friend class TestUpdateModes;
     friend class Trial;
 
 public:
@@ -115,18 +179,112 @@ public:
     //! @copydoc AbstractGraph::edge(int originId, int neighbourId) const
     inline const Edge& edge(int originId, int neighbourId) const;
 
+    /**
+     * @brief Gets how the nodes are updated at each time step.
+     * @see setUpdateMode()
+     */
+    inline UpdateMode updateMode() const;
+
+    /**
+     * @brief Gets the simulation time.
+     * It is the continuous time of the last event in the
+     * UpdateMode::Gillespie mode, and the current step() otherwise.
+     */
+    inline double time() const;
+
+    //! @copydoc AbstractGraph::nodeColumn
+    template<typename T>
+    inline NodeColumn<T>* nodeColumn(int attrId) const;
+
+    //! @copydoc AbstractGraph::nodeBuffer
+    template<typename T>
+    inline NodeColumn<T>* nodeBuffer(int attrId) const;
+
+    /**
+     * @brief Calls @p func for each node of the graph in parallel.
+     *
+     * The nodes are split into chunks of @p grainSize nodes, which are
+     * processed by the calling thread together with the idle threads of
+     * the pool used to run the experiments. Each chunk gets its own PRG,
+     * seeded with the trial's seed, the current step and the chunk index.
+     * So, the outcome does not depend on the number of threads available.
+     *
+     * @warning @p func runs concurrently; it must not change the graph
+     *          structure and should only write to the node it receives.
+     *          Synchronous models usually store the new states in a
+     *          separate buffer and apply them afterwards.
+     */
+    void parallelForNodes(const std::function<void(const Node&, PRG*)>& func,
+                          int grainSize=4096) const;
+
+    /**
+     * @brief Calls @p func for each edge of the graph in parallel.
+     * @copydetails parallelForNodes
+     */
+    void parallelForEdges(const std::function<void(const Edge&, PRG*)>& func,
+                          int grainSize=4096) const;
+
+    /**
+     * @brief Calls @p func for each index in [0, @p size) in parallel.
+     * @copydetails parallelForNodes
+     */
+    void parallelFor(int size, const std::function<void(int, PRG*)>& func,
+                     int grainSize=4096) const;
+
     // AbstractModelInterface stuff
     // the default implementation of the functions below do nothing
     inline void beforeLoop() override {}
     inline void afterLoop() override {}
     inline Values customOutputs(const Values& inputs) const override
     { Q_UNUSED(inputs); return Values(); }
+    inline void syncNodes() override {}
+    inline double nodeRate(int nodeIdx) const override
+    { Q_UNUSED(nodeIdx); return 1.0; }
+    inline void nodeEvent(int nodeIdx) override { Q_UNUSED(nodeIdx); }
+    inline void saveState(QDataStream& out) const override { Q_UNUSED(out); }
+    inline bool loadState(QDataStream& in) override { Q_UNUSED(in); return true; }
 
 /**@}*/
 
 protected:
     //! constructor
     AbstractModel() = default;
+
+    /**
+     * @brief Sets how the nodes are updated at each time step.
+     *
+     * It is meant to be called in init(), and the modes are:
+     *   - UpdateMode::Synchronous (default): algorithmStep() is called once
+     *     per step and it is responsible for updating all the nodes.
+     *   - UpdateMode::RandomSequential: at each step, nodeEvent() is called
+     *     for N nodes picked at random (with replacement), where N is the
+     *     number of nodes; i.e., one Monte Carlo sweep.
+     *   - UpdateMode::Gillespie: events happen in continuous time. The
+     *     next event happens after an exponentially distributed waiting time
+     *     with the sum of all nodeRate() and is performed by nodeEvent() on
+     *     a node picked with probability proportional to its rate. Each step
+     *     covers one unit of time() and costs O(log N) per event. The
+     *     simulation stops when all rates are zero. It requires a static
+     *     graph (see AbstractGraph::topology()).
+     *
+     * In the asynchronous modes, the nodes see the changes made by previous
+     * events straight away, so the node columns are written directly (i.e.,
+     * without the next buffer), and algorithmStep() is called once at the
+     * end of each step; it may be used to stop the simulation.
+     */
+    inline void setUpdateMode(UpdateMode mode);
+
+private:
+    UpdateMode m_updateMode = UpdateMode::Synchronous;
+    double m_time = 0.0;
+    RateTree m_rates;
+
+    // prepares the update mode to run some steps (e.g., builds the rate tree)
+    void initUpdates();
+    // performs one step according to the update mode
+    bool runStep();
+    // queries the rate of the node at position 'nodeIdx' again
+    void updateRate(int nodeIdx);
 };
 
 /************************************************************************
@@ -148,5 +306,22 @@ inline const Edge& AbstractModel::edge(int edgeId) const
 inline const Edge &AbstractModel::edge(int originId, int neighbourId) const
 { return graph()->edge(originId, neighbourId); }
 
+inline UpdateMode AbstractModel::updateMode() const
+{ return m_updateMode; }
+
+inline double AbstractModel::time() const
+{ return m_updateMode == UpdateMode::Gillespie ? m_time : step(); }
+
+inline void AbstractModel::setUpdateMode(UpdateMode mode)
+{ m_updateMode = mode; }
+
+template<typename T>
+inline NodeColumn<T>* AbstractModel::nodeColumn(int attrId) const
+{ return graph()->nodeColumn<T>(attrId); }
+
+template<typename T>
+inline NodeColumn<T>* AbstractModel::nodeBuffer(int attrId) const
+{ return graph()->nodeBuffer<T>(attrId); }
+
 } // evoplex
 #endif // ABSTRACT_MODEL_H
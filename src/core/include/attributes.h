@@ -17,9 +17,12 @@
 #ifndef ATTRIBUTES_H
 #define ATTRIBUTES_H
 
+#include <QHash>
 #include <QPair>
 #include <QString>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 #include <stdint.h>
@@ -32,10 +35,77 @@ namespace evoplex {
 class Attributes;
 using SetOfAttributes = std::vector<Attributes>;
 
+class AttributesSchema;
+using AttributesSchemaPtr = std::shared_ptr<const AttributesSchema>;
+
+/**
+ * @brief A list of attributes' names.
+ * A schema is usually shared by all the Attributes of the same kind
+ * (e.g., all nodes of a trial), so that each entity holds only its values.
+ * A shared schema is never changed; only the Attributes which own it
+ * alone can change it in place.
+ * Name-to-id lookups are done through a hash table.
+ */
+class AttributesSchema
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param names The attributes' names, in the order of their ids.
+     */
+    explicit AttributesSchema(std::vector<QString> names=std::vector<QString>());
+
+    /**
+     * @brief Gets a shared empty schema.
+     */
+    static const AttributesSchemaPtr& emptySchema();
+
+    /**
+     * @brief Gets the number of attributes in the schema.
+     */
+    inline int size() const;
+
+    /**
+     * @brief Gets the name of all attributes.
+     */
+    inline const std::vector<QString>& names() const;
+
+    /**
+     * @brief Gets the name of the attribute at @p id.
+     * @throw  std::out_of_range if the @p id is not present.
+     */
+    inline const QString& name(int id) const;
+
+    /**
+     * @brief Returns the id of the first attribute called @p name.
+     * @returns -1 if no item matched.
+     */
+    inline int indexOf(const QString& name) const;
+
+private:
+    friend class Attributes;
+
+    std::vector<QString> m_names;
+    QHash<QString, int> m_ids; // id of the first occurrence of each name
+
+    // the functions below keep 'm_ids' in sync with 'm_names'
+    void reserve(size_t size);
+    void resize(size_t size);
+    void rename(size_t id, const QString& name);
+    void append(const QString& name);
+};
+
 /**
  * @brief A container of labeled values.
  * It offers fixed time access to individual elements in
- * any order by id and linear time by name.
+ * any order by id, and by name through the shared AttributesSchema.
+ * Changing the name of an attribute detaches the container from
+ * the shared schema (i.e., copy-on-write). Further changes to the names
+ * are done in place, so filling a container with reserve() and
+ * push_back() takes linear time.
+ * The values are also shared by the copies of a container until one of
+ * them is changed, so copying a container costs no allocation. As with
+ * the schema, the copies can be changed in different threads.
  */
 class Attributes
 {
@@ -44,9 +114,16 @@ public:
      * @brief Constructor.
      * @param size The containers size.
      */
-    Attributes(int size) { resize(size); }
+    Attributes(int size) : m_schema(AttributesSchema::emptySchema()),
+        m_values(emptyValues()) { resize(size); }
+    /**
+     * @brief Constructor.
+     * Creates a container with default values for all attributes in @p schema.
+     * @param schema A valid schema.
+     */
+    explicit Attributes(AttributesSchemaPtr schema);
     //! Constructor.
-    Attributes() {}
+    Attributes() : m_schema(AttributesSchema::emptySchema()), m_values(emptyValues()) {}
 
     //! Destructor.
     ~Attributes() {}
@@ -66,7 +143,9 @@ public:
      * @brief Attempt to preallocate enough memory for specified number
      *         of elements.
      * This function attempts to reserve enough memory for the
-     * container to hold the specified number of elements.  If the
+     * container to hold the specified number of elements, both for
+     * the values and the names; the latter detaches the container from
+     * a shared schema, as it is expected to be followed by push_back().  If the
      * number requested is more than max_size(), length_error is
      * thrown.
      * @param size  Number of elements required.
@@ -120,6 +199,10 @@ public:
      * @brief Gets the name of all attributes.
      */
     inline const std::vector<QString>& names() const;
+    /**
+     * @brief Gets the schema shared by this container.
+     */
+    inline const AttributesSchemaPtr& schema() const;
     /**
      * @brief Gets the name of the attribute at @p id.
      * @throw  std::out_of_range if the @p id is not present.
@@ -152,38 +235,71 @@ public:
     inline void setValue(int id, const Value& value);
 
 private:
-    std::vector<QString> m_names;
-    std::vector<Value> m_values;
+    using ValuesPtr = std::shared_ptr<std::vector<Value>>;
+
+    AttributesSchemaPtr m_schema;
+    ValuesPtr m_values;
+
+    // gets the schema for writing; it is copied first if shared
+    inline AttributesSchema& mutableSchema();
+
+    // gets the values for writing; they are copied first if shared
+    inline std::vector<Value>& mutableValues();
+
+    // a shared empty set of values
+    static const ValuesPtr& emptyValues();
 };
 
 
+/************************************************************************
+   AttributesSchema: Inline member functions
+ ************************************************************************/
+
+inline int AttributesSchema::size() const
+{ return static_cast<int>(m_names.size()); }
+
+inline const std::vector<QString>& AttributesSchema::names() const
+{ return m_names; }
+
+inline const QString& AttributesSchema::name(int id) const
+{ return m_names.at(id); }
+
+inline int AttributesSchema::indexOf(const QString& name) const
+{ return m_ids.value(name, -1); }
+
 /************************************************************************
    Attributes: Inline member functions
  ************************************************************************/
 
 inline void Attributes::resize(int size) {
     size_t s = size < 0 ? 0 : static_cast<size_t>(size);
-    m_names.resize(s);
-    m_values.resize(s);
+    if (s != m_schema->names().size()) {
+        mutableSchema().resize(s);
+    }
+    if (s != m_values->size()) {
+        mutableValues().resize(s);
+    }
 }
 
 inline void Attributes::reserve(int size) {
     size_t s = size < 0 ? 0 : static_cast<size_t>(size);
-    m_names.reserve(s);
-    m_values.reserve(s);
+    if (s > m_schema->names().size()) {
+        mutableSchema().reserve(s);
+    }
+    mutableValues().reserve(s);
 }
 
 inline int Attributes::size() const
-{ return static_cast<int>(m_values.size()); }
+{ return static_cast<int>(m_values->size()); }
 
 inline bool Attributes::isEmpty() const
-{ return m_names.empty(); }
+{ return m_values->empty(); }
 
 inline bool Attributes::empty() const
-{ return m_names.empty(); }
+{ return m_values->empty(); }
 
 inline int Attributes::indexOf(const QString& name) const
-{ return Utils::indexOf(m_names, name); }
+{ return m_schema->indexOf(name); }
 
 inline bool Attributes::contains(const QString& name) const
 { return indexOf(name) > -1; }
@@ -191,37 +307,67 @@ inline bool Attributes::contains(const QString& name) const
 inline void Attributes::replace(int id, QString newName, Value newValue) {
     if (id < 0) throw std::out_of_range("id must be positive!");
     size_t _id = static_cast<size_t>(id);
-    m_names.at(_id) = newName;
-    m_values.at(_id) = newValue;
+    if (_id >= m_values->size()) throw std::out_of_range("id is out of range!");
+    mutableValues()[_id] = newValue;
+    if (m_schema->name(id) != newName) {
+        mutableSchema().rename(_id, newName);
+    }
 }
 
 inline void Attributes::push_back(QString name, Value value) {
-    m_names.emplace_back(name);
-    m_values.emplace_back(value);
-    if (m_names.size() >= INT32_MAX)
+    if (m_values->size() >= INT32_MAX)
         throw std::length_error("too many attributes");
+    mutableSchema().append(name);
+    mutableValues().emplace_back(value);
 }
 
 inline const std::vector<QString>& Attributes::names() const
-{ return m_names; }
+{ return m_schema->names(); }
+
+inline const AttributesSchemaPtr& Attributes::schema() const
+{ return m_schema; }
 
 inline const QString& Attributes::name(int id) const
-{ return m_names.at(id); }
+{ return m_schema->name(id); }
 
 inline const std::vector<Value>& Attributes::values() const
-{ return m_values; }
+{ return *m_values; }
 
 inline const Value& Attributes::value(int id) const
-{ return m_values.at(id); }
+{ return m_values->at(id); }
 
 inline Value Attributes::value(const QString& name, Value defaultValue) const {
     const int idx = indexOf(name);
-    return idx < 0 ? defaultValue : m_values.at(static_cast<size_t>(idx));
+    return idx < 0 ? defaultValue : m_values->at(static_cast<size_t>(idx));
 }
 
 inline void Attributes::setValue(int id, const Value& value) {
     if (id < 0) throw std::out_of_range("id must be positive!");
-    m_values.at(static_cast<size_t>(id)) = value;
+    const size_t _id = static_cast<size_t>(id);
+    if (_id >= m_values->size()) throw std::out_of_range("id is out of range!");
+    mutableValues()[_id] = value;
+}
+
+inline std::vector<Value>& Attributes::mutableValues() {
+    // use_count() is 1 only if no other container can read these values
+    if (m_values.use_count() > 1) {
+        m_values = std::make_shared<std::vector<Value>>(*m_values);
+    } else {
+        // the last reads by a released copy happen before our writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *m_values;
+}
+
+inline AttributesSchema& Attributes::mutableSchema() {
+    // same as the values; the empty schema is always shared
+    if (m_schema.use_count() > 1) {
+        m_schema = std::make_shared<AttributesSchema>(*m_schema);
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    // all schemas are created non-const by make_shared
+    return const_cast<AttributesSchema&>(*m_schema);
 }
 
 } // evoplex
@@ -86,6 +86,12 @@ public:
     static AttrsGeneratorPtr parse(const AttributesScope& attrsScope,
                                    const QString &cmd, QString& error);
 
+    /**
+     * @brief Creates the schema of the attributes in @p attrsScope.
+     * The names are placed according to the attributes' ids.
+     */
+    static AttributesSchemaPtr createSchema(const AttributesScope& attrsScope);
+
     //! Destructor.
     virtual ~AttrsGenerator() = default;
 
@@ -94,6 +100,11 @@ public:
      */
     inline AttributesScope attrsScope() const { return m_attrsScope; }
 
+    /**
+     * @brief Gets the schema shared by all generated attributes.
+     */
+    inline const AttributesSchemaPtr& schema() const { return m_schema; }
+
     /**
      * @brief Gets the source command for the AttrsGenerator object.
      */
@@ -114,6 +125,7 @@ public:
 
 protected:
     const AttributesScope m_attrsScope;
+    const AttributesSchemaPtr m_schema;
     const int m_size;
     QString m_command;
 
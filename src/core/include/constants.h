@@ -29,6 +29,8 @@
 #define EVOPLEX_MAX_TRIALS 1000
 //! maximum number of opened projects at the same time (10^2)
 #define EVOPLEX_MAX_PROJECTS 100
+//! maximum period of the cycles detected in a trial (10^4)
+#define EVOPLEX_MAX_CYCLE_PERIOD 10000
 
 /******************************************************************************
     These constants hold the name of the properties common to any experiment.
@@ -57,15 +59,24 @@
 #define GENERAL_ATTR_GRAPHTYPE "graphType"
 //! a command to AttrsGenerator
 #define GENERAL_ATTR_EDGEATTRS "edgeAttrs"
+//! n>0 to finish a trial when the nodes' state repeats within n steps; 0 otherwise
+//! (optional; meant for deterministic models)
+#define GENERAL_ATTR_CYCLEPERIOD "cyclePeriod"
+//! n>0 to save a checkpoint of each trial every n steps; 0 otherwise (optional)
+#define GENERAL_ATTR_CHECKPOINT "checkpointSteps"
 
 //! path to the directory in which the file will be saved
 #define OUTPUT_DIR "outputDirectory"
-//! 1 to indicate if the output should be done across all trials; 0 otherwise
+//! true to save the mean, variance, min and max of the outputs across all trials
+//! in a single file instead of a file per trial (optional; default: false)
 #define OUTPUT_AVGTRIALS "outputAvgTrials"
 //! valid header
 #define OUTPUT_HEADER "outputHeader"
-//! n=0 to save all steps; n>0 to save the last n steps
+//! n=0 to save all steps; n>0 to save the last n steps (optional; default: 0)
+//! the last n steps of each trial are kept in memory until it finishes
 #define OUTPUT_SAVESTEPS "outputSaveSteps"
+//! the format of the output files: "csv" or "binary" (optional; default: csv)
+#define OUTPUT_FORMAT "outputFormat"
 
 /******************************************************************************
     Plugin stuff
@@ -84,6 +95,10 @@
 #define PLUGIN_ATTR_VERSION "version"
 //! domain of the plugin's attributes
 #define PLUGIN_ATTR_ATTRSSCOPE "pluginAttributesScope"
+//! Optional: the default values of the plugin's attributes, e.g., {"attr": value};
+//! they are used when an attribute is missing (e.g., in projects saved by
+//! an older version of the plugin)
+#define PLUGIN_ATTR_ATTRSDEFAULTS "pluginAttributesDefaults"
 
 // model (only)
 
@@ -102,6 +117,9 @@
 #define PLUGIN_ATTR_VALIDGRAPHTYPES "validGraphTypes"
 //! true if the graph supports edge attributes generator
 #define PLUGIN_ATTR_EDGEATTRSGEN "supportsEdgeAttrsGen"
+//! true if the graph always creates the same edges for the same nodes and
+//! attributes; if so, the topology is created once and shared by all trials
+#define PLUGIN_ATTR_DETERMINISTIC "deterministicTopology"
 
 //! @}
 #endif // CONSTANTS_H
@@ -37,6 +37,7 @@ using EdgePtr = std::shared_ptr<BaseEdge>;
 class Edge
 {
     friend class AbstractGraph;
+    friend class Edges;
     friend class TestEdge;
 
 public:
@@ -17,34 +17,125 @@
 #ifndef EDGES_H
 #define EDGES_H
 
+#include <iterator>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "edge.h"
 
 namespace evoplex {
 
+class CompactEdges;
+
 /**
  * @brief An Edge container.
  * It is an unordered_map with the edge's id as the key.
- * @see Edge
+ * @note In a static graph without edge attributes, the edges are not
+ *       stored one by one; the container is a view of the frozen CSR
+ *       topology and each Edge is created when it is accessed. Thus,
+ *       prefer the Topology's spans to loop over the neighbours.
+ * @see Edge, AbstractGraph::topology()
  * @ingroup PublicAPI
  */
 class Edges : private std::unordered_map<int, Edge>
 {
     friend class AbstractGraph;
+    friend class BaseNode;
+    friend class Checkpoint;
+    friend class CompactEdges;
     friend class DNode;
+    friend class MemoryBudget;
+    friend class Topology;
     friend class UNode;
 
 public:
-    using std::unordered_map<int, Edge>::at;
-    using std::unordered_map<int, Edge>::begin;
-    using std::unordered_map<int, Edge>::cbegin;
-    using std::unordered_map<int, Edge>::end;
-    using std::unordered_map<int, Edge>::cend;
-    using std::unordered_map<int, Edge>::iterator;
-    using std::unordered_map<int, Edge>::const_iterator;
-    using std::unordered_map<int, Edge>::empty;
-    using std::unordered_map<int, Edge>::size;
+    /**
+     * @brief A forward iterator over the pairs <edgeId, Edge>.
+     */
+    class const_iterator
+    {
+        friend class Edges;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const int, Edge>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator();
+        const_iterator(const const_iterator& other);
+        const_iterator& operator=(const const_iterator& other);
+        ~const_iterator();
+
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        std::unordered_map<int, Edge>::const_iterator m_it;
+        const Edges* m_edges; // not null if it iterates over a view
+        int m_pos;
+        // the pair at m_pos of a view, created on demand
+        mutable typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type m_buf;
+        mutable value_type* m_current;
+
+        explicit const_iterator(std::unordered_map<int, Edge>::const_iterator it);
+        explicit const_iterator(const Edges* edges, int pos);
+        void release() const;
+    };
+    using iterator = const_iterator;
+
+    //! constructor
+    Edges();
+
+    /**
+     * @brief Returns the Edge corresponding to @p edgeId.
+     * @throw std::out_of_range if no such data is present.
+     */
+    Edge at(int edgeId) const;
+
+    const_iterator begin() const;
+    const_iterator cbegin() const;
+    const_iterator end() const;
+    const_iterator cend() const;
+
+    bool empty() const;
+    size_t size() const;
+
+private:
+    // The edges of a node (i.e., its adjacency list) are also kept in a
+    // contiguous array, which allows picking a random neighbour in
+    // constant time. It is not used by the graph's list of edges.
+    std::vector<Edge> m_dense;
+
+    // not null if it is a view of the CSR topology (see CompactEdges)
+    const CompactEdges* m_compact;
+    int m_nodeIdx; // the node's position; -1 for the edges of the graph
+    bool m_isOut;
+
+    void addEdge(const Edge& edge);
+    void removeEdge(int edgeId);
+    void clearEdges();
+    // puts the edges in the contiguous array in the order of 'edgeIds',
+    // which must hold each edge once; returns false otherwise
+    bool reorder(const std::vector<int>& edgeIds);
+    // erases the edge from the graph's list of edges
+    const_iterator eraseEdge(int edgeId);
+
+    // makes it a view of the out (or in) neighbours of the node at
+    // 'nodeIdx'; the edges of the graph if 'nodeIdx' is -1
+    // the container must be empty; nullptr goes back to a plain container
+    void setView(const CompactEdges* compact, int nodeIdx, bool out);
+
+    // the id of the edge (or the neighbour) at 'pos' in the contiguous
+    // array or in the node's span; 'pos' must be in [0, size())
+    int idAt(int pos) const;
+    const Node& neighbourAt(int pos) const;
 };
 
 } // evoplex
@@ -48,6 +48,13 @@ enum class Status {
     Finished,  //! all is done
 };
 
+//! how the nodes of a model are updated at each time step
+enum class UpdateMode {
+    Synchronous,      //! AbstractModel::algorithmStep() updates all nodes at once
+    RandomSequential, //! N random nodes, one at a time (N is the number of nodes)
+    Gillespie         //! continuous-time events, picked according to the nodes' rates
+};
+
 enum class PluginType : int {
     Invalid = 0,
     Graph = 1,
@@ -35,8 +35,12 @@ using NodePtr = std::shared_ptr<BaseNode>;
 class Node
 {
     friend class AbstractGraph;
+    friend class AbstractNodeColumn;
+    friend class Nodes;
     friend class NodesPrivate;
+    friend class StateHash;
     friend class TestNodes;
+    friend class TestTopology;
 
 public:
     /**
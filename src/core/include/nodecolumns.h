@@ -0,0 +1,508 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NODE_COLUMNS_H
+#define NODE_COLUMNS_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "nodes.h"
+#include "value.h"
+
+namespace evoplex {
+
+/**
+ * @brief A node attribute stored in a contiguous array.
+ *
+ * The array is indexed by the nodes' positions (i.e., Nodes::atIndex())
+ * and holds the values of the attribute @p attrId of all nodes.
+ * Changes are not seen by the nodes' Attributes until the column is
+ * synchronized (see AbstractGraph::syncNodeColumns()).
+ *
+ * A column might also be double-buffered for synchronous updates: the
+ * model writes the next values of all nodes into a second array while
+ * reading the current ones, and the buffers are swapped at the end of
+ * the step (see AbstractGraph::nodeBuffer()).
+ * @see NodeColumn, AbstractGraph::nodeColumn()
+ */
+class AbstractNodeColumn
+{
+    friend class NodeColumns;
+    friend class StateHash;
+    friend class TestStateHash;
+
+public:
+    //! Destructor.
+    virtual ~AbstractNodeColumn() = default;
+
+    /**
+     * @brief Gets the id of the node attribute stored in this column.
+     */
+    inline int attrId() const;
+
+    /**
+     * @brief Gets the number of elements (i.e., nodes) in the column.
+     */
+    inline int size() const;
+
+    /**
+     * @brief Returns true if the column was changed since the last sync.
+     */
+    inline bool isModified() const;
+
+    /**
+     * @brief Returns true if the column has a buffer for the next values.
+     */
+    inline bool isDoubleBuffered() const;
+
+    /**
+     * @brief Returns true if the writes are folded into the column's hash.
+     * @see NodeColumns::setHashed()
+     */
+    inline bool isHashed() const;
+
+    /**
+     * @brief Gets the type of the values stored in the column.
+     */
+    virtual Value::Type type() const = 0;
+
+    /**
+     * @brief Count frequency of the @p header values in the column.
+     * @see Stats::count()
+     */
+    virtual std::vector<Value> count(const std::vector<Value>& header) const = 0;
+
+protected:
+    const int m_attrId;
+    int m_size;
+    bool m_doubleBuffered;
+    std::atomic<bool> m_modified;
+    std::atomic<bool> m_nextWritten;
+    // the StateHash terms of the values held by the nodes' attributes;
+    // it is updated by store() and computed again after load()
+    mutable quint64 m_storedHash;
+    mutable bool m_storedHashValid;
+    // the StateHash terms of the values in the column; if hashed, set()
+    // and setNext() update it in O(1), and it is only computed again
+    // after load() or after the values were written through a pointer
+    bool m_hashed;
+    std::vector<int> m_nodeIds; // only loaded if hashed
+    mutable std::atomic<quint64> m_hash;
+    mutable std::atomic<bool> m_hashValid;
+    std::atomic<quint64> m_nextDelta; // the change made by the next values
+    std::atomic<bool> m_nextRaw; // the next values were written through a pointer
+
+    explicit AbstractNodeColumn(int attrId);
+
+    // reads the values from the nodes' attributes
+    virtual void load(const Nodes& nodes) = 0;
+    // reads the nodes' ids if hashed, and invalidates the hash
+    void loadNodeIds(const Nodes& nodes);
+    // writes the values back to the nodes' attributes
+    void store(const Nodes& nodes);
+    // the sum of the StateHash terms of the values in the column
+    quint64 hash(const Nodes& nodes) const;
+    // the StateHash term of 'v' as the value of the node at 'nodeIdx'
+    quint64 term(int nodeIdx, const Value& v) const;
+    // folds the change of the value of the node at 'nodeIdx' into 'sum'
+    inline void addTerms(std::atomic<quint64>& sum, int nodeIdx,
+                         const Value& oldValue, const Value& newValue) const;
+    // the same, but for the values held by the nodes' attributes
+    quint64 storedHash(const Nodes& nodes) const;
+    // gets the value of the node at position 'nodeIdx' as a Value
+    virtual Value valueAt(int nodeIdx) const = 0;
+    // returns true if 'v' is exactly the value of the node at 'nodeIdx'
+    virtual bool isStored(int nodeIdx, const Value& v) const = 0;
+    // allocates the buffer of next values
+    virtual void enableNextBuffer() = 0;
+    // makes the next values current if any of them was written
+    virtual void swapBuffers() = 0;
+};
+
+/**
+ * @brief A typed node attribute stored in a contiguous array.
+ * @tparam T bool, char, double or int; it must match the attribute's type.
+ * @see AbstractNodeColumn
+ */
+template<typename T>
+class NodeColumn : public AbstractNodeColumn
+{
+public:
+    //! Constructor.
+    explicit NodeColumn(int attrId);
+
+    /**
+     * @brief Gets the value of the node at position @p nodeIdx.
+     */
+    inline T get(int nodeIdx) const;
+
+    /**
+     * @brief Sets the value of the node at position @p nodeIdx.
+     * If the column is hashed, it also updates the column's hash in O(1).
+     */
+    inline void set(int nodeIdx, T value);
+
+    /**
+     * @brief Gets a pointer to the values for reading.
+     */
+    inline const T* constData() const;
+
+    /**
+     * @brief Gets a pointer to the values for reading and writing.
+     * The column is considered modified after calling this function, and
+     * its hash is computed again in O(n) when it is needed.
+     */
+    inline T* data();
+
+    /**
+     * @brief Sets the next value of the node at position @p nodeIdx.
+     * @warning The column must be double-buffered, and the next value of
+     *          all nodes must be set once before the end of the step.
+     */
+    inline void setNext(int nodeIdx, T value);
+
+    /**
+     * @brief Gets a pointer to the next values for writing.
+     * @copydetails setNext()
+     */
+    inline T* nextData();
+
+    Value::Type type() const override;
+    std::vector<Value> count(const std::vector<Value>& header) const override;
+
+protected:
+    void load(const Nodes& nodes) override;
+    Value valueAt(int nodeIdx) const override;
+    bool isStored(int nodeIdx, const Value& v) const override;
+    void enableNextBuffer() override;
+    void swapBuffers() override;
+
+private:
+    std::unique_ptr<T[]> m_values;
+    std::unique_ptr<T[]> m_next;
+
+    static T fromValue(const Value& v);
+};
+
+/**
+ * @brief The set of node columns of a graph.
+ * @see AbstractGraph::nodeColumn()
+ */
+class NodeColumns
+{
+    friend class StateHash;
+
+public:
+    //! Constructor.
+    NodeColumns() : m_stale(false), m_hashed(false) {}
+
+    /**
+     * @brief Returns true if there is no column.
+     */
+    inline bool empty() const;
+
+    /**
+     * @brief Returns true if nodes were added/removed since the last reload.
+     * While stale, the nodes' Attributes hold the current values.
+     */
+    inline bool isStale() const;
+
+    /**
+     * @brief Gets the column of the attribute @p attrId.
+     * @return nullptr if the attribute is not stored in a column
+     *         or if the columns are stale.
+     */
+    const AbstractNodeColumn* find(int attrId) const;
+
+    /**
+     * @brief Gets the column of the attribute @p attrId of @p nodes.
+     * The column is created if it does not exist, and all columns
+     * are reloaded first if they are stale.
+     * @return nullptr if the attribute does not exist or if its
+     *         type is not T.
+     */
+    template<typename T>
+    NodeColumn<T>* get(const Nodes& nodes, int attrId);
+
+    /**
+     * @brief Gets the double-buffered column of the attribute @p attrId.
+     * @copydetails get()
+     */
+    template<typename T>
+    NodeColumn<T>* getBuffered(const Nodes& nodes, int attrId);
+
+    /**
+     * @brief Folds the writes into the columns' hashes (see StateHash).
+     * It costs O(1) per write, which makes StateHash::value() O(1) in
+     * steps where the columns are only changed by set() and setNext().
+     */
+    void setHashed(const Nodes& nodes, bool hashed);
+
+    /**
+     * @brief Writes the modified columns back to the @p nodes.
+     * It does nothing if the columns are stale.
+     */
+    void sync(const Nodes& nodes);
+
+    /**
+     * @brief Marks the columns as stale before nodes are added/removed.
+     * The modified columns are written back to the @p nodes first, so only
+     * the first call in a row costs O(n). The columns are reloaded once,
+     * at the end of the step or when a column is requested.
+     */
+    void invalidate(const Nodes& nodes);
+
+    /**
+     * @brief Reads all columns from the @p nodes.
+     * It must be called when nodes are added/removed or when the
+     * nodes' attributes are changed without going through the columns.
+     */
+    void reload(const Nodes& nodes);
+
+    /**
+     * @brief Swaps the current and next buffers of the double-buffered
+     *        columns whose next values were written.
+     * It does nothing if the columns are stale, as the next values
+     * were written for the previous set of nodes.
+     */
+    void swapBuffers();
+
+private:
+    std::vector<std::unique_ptr<AbstractNodeColumn>> m_columns;
+    bool m_stale; // nodes were added/removed since the last reload
+    bool m_hashed;
+};
+
+/************************************************************************
+   AbstractNodeColumn: Inline member functions
+ ************************************************************************/
+
+inline int AbstractNodeColumn::attrId() const
+{ return m_attrId; }
+
+inline int AbstractNodeColumn::size() const
+{ return m_size; }
+
+inline bool AbstractNodeColumn::isModified() const
+{ return m_modified.load(std::memory_order_relaxed); }
+
+inline bool AbstractNodeColumn::isDoubleBuffered() const
+{ return m_doubleBuffered; }
+
+inline bool AbstractNodeColumn::isHashed() const
+{ return m_hashed; }
+
+inline void AbstractNodeColumn::addTerms(std::atomic<quint64>& sum, int nodeIdx,
+                                         const Value& oldValue, const Value& newValue) const
+{
+    if (oldValue != newValue) {
+        // unsigned arithmetic wraps around, so it can be undone
+        sum.fetch_add(term(nodeIdx, newValue) - term(nodeIdx, oldValue),
+                      std::memory_order_relaxed);
+    }
+}
+
+/************************************************************************
+   NodeColumn: Inline member functions
+ ************************************************************************/
+
+template<typename T>
+NodeColumn<T>::NodeColumn(int attrId)
+    : AbstractNodeColumn(attrId)
+{
+}
+
+template<typename T>
+inline T NodeColumn<T>::get(int nodeIdx) const
+{ return m_values[static_cast<size_t>(nodeIdx)]; }
+
+template<typename T>
+inline void NodeColumn<T>::set(int nodeIdx, T value)
+{
+    if (m_hashed) {
+        addTerms(m_hash, nodeIdx, Value(m_values[static_cast<size_t>(nodeIdx)]), Value(value));
+    }
+    m_values[static_cast<size_t>(nodeIdx)] = value;
+    m_modified.store(true, std::memory_order_relaxed);
+}
+
+template<typename T>
+inline const T* NodeColumn<T>::constData() const
+{ return m_values.get(); }
+
+template<typename T>
+inline T* NodeColumn<T>::data()
+{
+    m_modified.store(true, std::memory_order_relaxed);
+    m_hashValid.store(false, std::memory_order_relaxed);
+    return m_values.get();
+}
+
+template<typename T>
+inline void NodeColumn<T>::setNext(int nodeIdx, T value)
+{
+    if (m_hashed) {
+        addTerms(m_nextDelta, nodeIdx, Value(m_values[static_cast<size_t>(nodeIdx)]), Value(value));
+    }
+    m_next[static_cast<size_t>(nodeIdx)] = value;
+    m_nextWritten.store(true, std::memory_order_relaxed);
+}
+
+template<typename T>
+inline T* NodeColumn<T>::nextData()
+{
+    m_nextWritten.store(true, std::memory_order_relaxed);
+    m_nextRaw.store(true, std::memory_order_relaxed);
+    return m_next.get();
+}
+
+template<>
+inline bool NodeColumn<bool>::fromValue(const Value& v)
+{ return v.toBool(); }
+
+template<>
+inline char NodeColumn<char>::fromValue(const Value& v)
+{ return v.toChar(); }
+
+template<>
+inline double NodeColumn<double>::fromValue(const Value& v)
+{ return v.toDouble(); }
+
+template<>
+inline int NodeColumn<int>::fromValue(const Value& v)
+{ return v.toInt(); }
+
+template<typename T>
+Value::Type NodeColumn<T>::type() const
+{ return Value(T()).type(); }
+
+template<typename T>
+std::vector<Value> NodeColumn<T>::count(const std::vector<Value>& header) const
+{
+    std::vector<Value> ret(header.size(), 0);
+    const T* values = m_values.get();
+    for (size_t i = 0; i < header.size(); ++i) {
+        if (header[i].type() != type()) {
+            continue;
+        }
+        // a branchless linear scan, which the compiler can vectorise
+        const T key = fromValue(header[i]);
+        int n = 0;
+        for (int j = 0; j < m_size; ++j) {
+            n += values[j] == key;
+        }
+        ret[i] = n;
+    }
+    return ret;
+}
+
+template<typename T>
+void NodeColumn<T>::load(const Nodes& nodes)
+{
+    m_size = static_cast<int>(nodes.size());
+    m_values.reset(new T[nodes.size()]);
+    for (int i = 0; i < m_size; ++i) {
+        m_values[static_cast<size_t>(i)] = fromValue(nodes.atIndex(i).attr(m_attrId));
+    }
+    if (m_doubleBuffered) {
+        m_next.reset(new T[nodes.size()]);
+    }
+    m_modified.store(false, std::memory_order_relaxed);
+    m_nextWritten.store(false, std::memory_order_relaxed);
+    m_storedHashValid = false;
+    loadNodeIds(nodes);
+}
+
+template<typename T>
+Value NodeColumn<T>::valueAt(int nodeIdx) const
+{ return Value(m_values[static_cast<size_t>(nodeIdx)]); }
+
+template<typename T>
+bool NodeColumn<T>::isStored(int nodeIdx, const Value& v) const
+{ return v.type() == type() && fromValue(v) == m_values[static_cast<size_t>(nodeIdx)]; }
+
+template<typename T>
+void NodeColumn<T>::enableNextBuffer()
+{
+    m_doubleBuffered = true;
+    m_next.reset(new T[static_cast<size_t>(m_size)]);
+}
+
+template<typename T>
+void NodeColumn<T>::swapBuffers()
+{
+    if (m_nextWritten.load(std::memory_order_relaxed)) {
+        m_values.swap(m_next);
+        m_nextWritten.store(false, std::memory_order_relaxed);
+        m_modified.store(true, std::memory_order_relaxed);
+        const quint64 delta = m_nextDelta.exchange(0, std::memory_order_relaxed);
+        if (m_nextRaw.exchange(false, std::memory_order_relaxed)) {
+            m_hashValid.store(false, std::memory_order_relaxed);
+        } else {
+            m_hash.fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+}
+
+/************************************************************************
+   NodeColumns: Inline member functions
+ ************************************************************************/
+
+inline bool NodeColumns::empty() const
+{ return m_columns.empty(); }
+
+inline bool NodeColumns::isStale() const
+{ return m_stale; }
+
+template<typename T>
+NodeColumn<T>* NodeColumns::get(const Nodes& nodes, int attrId)
+{
+    if (m_stale) {
+        reload(nodes);
+    }
+
+    for (auto& col : m_columns) {
+        if (col->attrId() == attrId) {
+            return dynamic_cast<NodeColumn<T>*>(col.get());
+        }
+    }
+
+    if (nodes.empty() || attrId < 0 || attrId >= nodes.atIndex(0).attrs().size()
+            || nodes.atIndex(0).attr(attrId).type() != Value(T()).type()) {
+        return nullptr;
+    }
+
+    auto col = new NodeColumn<T>(attrId);
+    static_cast<AbstractNodeColumn*>(col)->m_hashed = m_hashed;
+    static_cast<AbstractNodeColumn*>(col)->load(nodes);
+    m_columns.emplace_back(col);
+    return col;
+}
+
+template<typename T>
+NodeColumn<T>* NodeColumns::getBuffered(const Nodes& nodes, int attrId)
+{
+    NodeColumn<T>* col = get<T>(nodes, attrId);
+    if (col && !col->isDoubleBuffered()) {
+        static_cast<AbstractNodeColumn*>(col)->enableNextBuffer();
+    }
+    return col;
+}
+
+} // evoplex
+#endif // NODE_COLUMNS_H
@@ -18,6 +18,7 @@
 #define NODES_H
 
 #include <unordered_map>
+#include <vector>
 
 #include "node.h"
 
@@ -26,12 +27,15 @@ namespace evoplex {
 /**
  * @brief A Node container.
  * It is an unordered_map with the node's id as the key.
+ * The nodes are also kept in a contiguous array, which allows accessing
+ * them by their position (e.g., to pick a random node in constant time).
  * @see Node
  * @ingroup PublicAPI
  */
 class Nodes : private std::unordered_map<int, Node>
 {
     friend class AbstractGraph;
+    friend class Checkpoint;
     friend class Experiment;
     friend class NodesPrivate;
 
@@ -45,7 +49,40 @@ public:
     using std::unordered_map<int, Node>::const_iterator;
     using std::unordered_map<int, Node>::empty;
     using std::unordered_map<int, Node>::size;
+
+    /**
+     * @brief Gets the Node at the position @p index in [0, size()).
+     * @note The position of a Node might change when another
+     *       Node is removed from the container.
+     */
+    inline const Node& atIndex(int index) const;
+
+    /**
+     * @brief Gets the position of the @p node in the container.
+     * @warning @p node must belong to this container.
+     * @see atIndex()
+     */
+    int indexOf(const Node& node) const;
+
+private:
+    std::vector<Node> m_dense;
+
+    // the methods below hide the std::unordered_map ones, so that we can
+    // keep the contiguous array in sync with the map
+    std::pair<iterator, bool> insert(const value_type& p);
+    size_type erase(int nodeId);
+    iterator erase(const_iterator it);
+    void clear();
+    void reserve(size_type n);
+    void swap(Nodes& other);
 };
 
+/************************************************************************
+   Nodes: Inline member functions
+ ************************************************************************/
+
+inline const Node& Nodes::atIndex(int index) const
+{ return m_dense[static_cast<size_t>(index)]; }
+
 } // evoplex
 #endif // NODES_H
@@ -115,6 +115,8 @@ public:
     { return d(m_mteng); }
 
 private:
+    friend class Checkpoint;
+
     const unsigned int m_seed;
     std::mt19937 m_mteng; //!  Mersenne Twister engine
     std::uniform_real_distribution<double> m_doubleZeroOne;
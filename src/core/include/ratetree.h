@@ -0,0 +1,97 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef RATETREE_H
+#define RATETREE_H
+
+#include <vector>
+
+namespace evoplex {
+
+/**
+ * @brief A sum tree of non-negative rates.
+ *
+ * Each leaf holds the rate of one item (e.g., the node at position i)
+ * and each internal node holds the sum of its children. So, changing a
+ * rate and picking an item with probability proportional to its rate
+ * take O(log n). The parents are always recomputed from their children
+ * (instead of being adjusted by the difference), so rounding errors do
+ * not accumulate.
+ * @ingroup PublicAPI
+ */
+class RateTree
+{
+public:
+    //! constructor
+    explicit RateTree(int size=0);
+
+    /**
+     * @brief Resizes the tree to @p size items, all with rate zero.
+     */
+    void reset(int size);
+
+    /**
+     * @brief Gets the number of items.
+     */
+    inline int size() const;
+
+    /**
+     * @brief Gets the rate of the item @p idx.
+     */
+    inline double rate(int idx) const;
+
+    /**
+     * @brief Gets the sum of all rates.
+     */
+    inline double total() const;
+
+    /**
+     * @brief Sets the @p rate of the item @p idx.
+     * @warning @p rate must be non-negative.
+     */
+    void setRate(int idx, double rate);
+
+    /**
+     * @brief Finds the item whose cumulative range contains @p value.
+     * If @p value is uniformly distributed in [0, total()), the item i
+     * is returned with probability rate(i)/total(). Items with rate zero
+     * are never returned.
+     * @returns -1 if total() is zero.
+     */
+    int find(double value) const;
+
+private:
+    int m_size;
+    int m_leaves; // a power of two >= m_size
+    std::vector<double> m_tree; // 1-based binary heap; leaves start at m_leaves
+};
+
+/************************************************************************
+   RateTree: Inline member functions
+ ************************************************************************/
+
+inline int RateTree::size() const
+{ return m_size; }
+
+inline double RateTree::rate(int idx) const
+{ return m_tree[static_cast<size_t>(m_leaves + idx)]; }
+
+inline double RateTree::total() const
+{ return m_tree[1]; }
+
+} // evoplex
+#endif // RATETREE_H
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "attributes.h"
+#include "nodecolumns.h"
 
 namespace evoplex {
 
@@ -59,6 +60,12 @@ public:
     {
         return count(entity.cbegin(), entity.cend(), attrIdx, values);
     }
+
+    //! @copydoc count()
+    static std::vector<Value> count(const AbstractNodeColumn& column, std::vector<Value> header)
+    {
+        return column.count(header);
+    }
 };
 
 }
@@ -0,0 +1,154 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <vector>
+
+#include "nodes.h"
+
+namespace evoplex {
+
+/**
+ * @brief A frozen, compressed sparse row (CSR) view of the graph's topology.
+ *
+ * Nodes are addressed by their position in the Nodes container
+ * (i.e., Nodes::atIndex()), and the neighbourhood of each node is a
+ * contiguous span of neighbours' positions. It takes 4 bytes per entry
+ * (i.e., ~8 bytes per edge) and makes neighbourhood scans cache-friendly.
+ *
+ * The view is built right after AbstractGraph::reset() and it is
+ * invalidated as soon as the graph changes (e.g., addEdge, removeNode).
+ * If the edges have no attributes, the view is the only copy of the
+ * edges kept by the graph until it changes (see Edges).
+ * @see AbstractGraph::topology()
+ * @ingroup PublicAPI
+ */
+class Topology
+{
+    friend class AbstractGraph;
+    friend class CompactEdges;
+    friend class TestTopology;
+
+public:
+    /**
+     * @brief A contiguous range of neighbours' positions.
+     */
+    class Span
+    {
+    public:
+        inline Span(const int* begin, const int* end);
+        inline const int* begin() const;
+        inline const int* end() const;
+        inline int size() const;
+        inline bool empty() const;
+        inline int operator[](int i) const;
+    private:
+        const int* m_begin;
+        const int* m_end;
+    };
+
+    //! constructor
+    Topology();
+
+    /**
+     * @brief Returns true if the view reflects the current graph.
+     */
+    inline bool isValid() const;
+
+    /**
+     * @brief Gets the number of nodes in the view.
+     */
+    inline int numNodes() const;
+
+    /**
+     * @brief Gets the positions of the out-neighbours of the node at
+     *        position @p nodeIdx.
+     * @note In undirected graphs, it is the same as inNeighbours().
+     */
+    inline Span outNeighbours(int nodeIdx) const;
+
+    /**
+     * @brief Gets the positions of the in-neighbours of the node at
+     *        position @p nodeIdx.
+     * @note In undirected graphs, it is the same as outNeighbours().
+     */
+    inline Span inNeighbours(int nodeIdx) const;
+
+private:
+    bool m_isValid;
+    bool m_isDirected;
+    std::vector<int> m_outOffsets;
+    std::vector<int> m_outNeighbours;
+    std::vector<int> m_inOffsets;
+    std::vector<int> m_inNeighbours;
+
+    void build(const Nodes& nodes, bool isDirected);
+    void clear();
+};
+
+/************************************************************************
+   Topology::Span: Inline member functions
+ ************************************************************************/
+
+inline Topology::Span::Span(const int* begin, const int* end)
+    : m_begin(begin), m_end(end) {}
+
+inline const int* Topology::Span::begin() const
+{ return m_begin; }
+
+inline const int* Topology::Span::end() const
+{ return m_end; }
+
+inline int Topology::Span::size() const
+{ return static_cast<int>(m_end - m_begin); }
+
+inline bool Topology::Span::empty() const
+{ return m_begin == m_end; }
+
+inline int Topology::Span::operator[](int i) const
+{ return m_begin[i]; }
+
+/************************************************************************
+   Topology: Inline member functions
+ ************************************************************************/
+
+inline bool Topology::isValid() const
+{ return m_isValid; }
+
+inline int Topology::numNodes() const
+{ return m_outOffsets.empty() ? 0 : static_cast<int>(m_outOffsets.size()) - 1; }
+
+inline Topology::Span Topology::outNeighbours(int nodeIdx) const
+{
+    const int* data = m_outNeighbours.data();
+    return Span(data + m_outOffsets[static_cast<size_t>(nodeIdx)],
+                data + m_outOffsets[static_cast<size_t>(nodeIdx) + 1]);
+}
+
+inline Topology::Span Topology::inNeighbours(int nodeIdx) const
+{
+    if (!m_isDirected) {
+        return outNeighbours(nodeIdx);
+    }
+    const int* data = m_inNeighbours.data();
+    return Span(data + m_inOffsets[static_cast<size_t>(nodeIdx)],
+                data + m_inOffsets[static_cast<size_t>(nodeIdx) + 1]);
+}
+
+} // evoplex
+#endif // TOPOLOGY_H
@@ -21,6 +21,8 @@
 #include <vector>
 #include <QString>
 
+class QDataStream;
+
 namespace evoplex {
 
 class Value;
@@ -308,6 +310,16 @@ inline quint32 Value::toUInt() const {
     throw throwError();
 }
 
+/**
+ * @brief Writes the Value @p v (type and data) to the stream @p out.
+ */
+QDataStream& operator<<(QDataStream& out, const Value& v);
+
+/**
+ * @brief Reads a Value from the stream @p in into @p v.
+ */
+QDataStream& operator>>(QDataStream& in, Value& v);
+
 } // evoplex
 
 
@@ -47,7 +47,7 @@ const char* MainApp::kPluginExtension = ".so";
 
 MainApp::MainApp()
     : m_expMgr(new ExperimentsMgr()),
-      m_networkMgr(new QNetworkAccessManager())
+      m_networkMgr(nullptr) // created on demand
 {
     qRegisterMetaType<Status>("Status"); // makes it available for signals/slots
     qRegisterMetaType<Function>("Function");
@@ -77,10 +77,14 @@ MainApp::MainApp()
     addAttrScope(id, GENERAL_ATTR_AUTODELETE, "bool");
     addAttrScope(id, GENERAL_ATTR_GRAPHTYPE, "string");
     addAttrScope(id, GENERAL_ATTR_EDGEATTRS, "string");
+    addAttrScope(id, GENERAL_ATTR_CYCLEPERIOD, QString("int[0,%1]").arg(EVOPLEX_MAX_CYCLE_PERIOD));
+    addAttrScope(id, GENERAL_ATTR_CHECKPOINT, QString("int[0,%1]").arg(EVOPLEX_MAX_STEPS));
 
     addAttrScope(id, OUTPUT_DIR, "string");
     addAttrScope(id, OUTPUT_HEADER, "string");
-    // FIXME: addAttrScope(id, OUTPUT_AVGTRIALS, "bool");
+    addAttrScope(id, OUTPUT_FORMAT, "string{csv,binary}");
+    addAttrScope(id, OUTPUT_AVGTRIALS, "bool");
+    addAttrScope(id, OUTPUT_SAVESTEPS, QString("int[0,%1]").arg(EVOPLEX_MAX_STEPS));
 
     QStringList searchPaths;
     searchPaths << qApp->applicationDirPath() + "/lib/evoplex/plugins";
@@ -312,6 +316,10 @@ void MainApp::checkForUpdates()
     QUrl url = m_userPrefs.value("settings/releasesUrl",
             qApp->organizationDomain() + "/data/releases.txt").toUrl();
 
+    if (!m_networkMgr) {
+        m_networkMgr = new QNetworkAccessManager();
+    }
+
     QNetworkReply* reply = m_networkMgr->get(QNetworkRequest((QUrl(url))));
     connect(reply, &QNetworkReply::finished, [this, reply]() {
         finishedCheckingForUpdates(QJsonDocument::fromJson(reply->readAll()).object());
@@ -137,7 +137,7 @@ private:
     int m_stepsToFlush;
     bool m_checkUpdatesAtStart;
 
-    QNetworkAccessManager* m_networkMgr;
+    QNetworkAccessManager* m_networkMgr; // only created in checkForUpdates()
 
     std::map<int, ProjectPtr> m_projects; // opened projects.
 
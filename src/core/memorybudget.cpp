@@ -0,0 +1,158 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#include "memorybudget.h"
+#include "abstractgraph.h"
+#include "edge_p.h"
+#include "node_p.h"
+#include "trial.h"
+
+namespace evoplex {
+
+MemoryBudget::MemoryBudget()
+    : m_limit(0),
+      m_reserved(0),
+      m_numReservations(0),
+      m_resident(0),
+      m_baseline(residentSetSize())
+{
+}
+
+void MemoryBudget::setLimit(qint64 kbytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_limit = qMax<qint64>(0, kbytes);
+}
+
+bool MemoryBudget::tryReserve(qint64 kbytes, bool force)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const qint64 rss = residentSetSize();
+    if (rss > 0 && m_resident == 0 && m_numReservations == 0) {
+        m_baseline = rss;
+    }
+
+    if (!force && m_limit > 0) {
+        qint64 usage = m_resident + m_reserved;
+        double scale = 1.0;
+        if (rss > 0) {
+            // how much the trials actually use, compared to the estimates
+            if (m_resident > 0) {
+                scale = qBound(1.0, (rss - m_baseline) / static_cast<double>(m_resident), 4.0);
+            }
+            usage = rss + static_cast<qint64>(m_reserved * scale);
+        }
+        if (usage + static_cast<qint64>(kbytes * scale) > m_limit) {
+            return false;
+        }
+    }
+
+    m_reserved += kbytes;
+    ++m_numReservations;
+    return true;
+}
+
+int MemoryBudget::numReservations()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_numReservations;
+}
+
+void MemoryBudget::commit(qint64 reservedKB, qint64 actualKB)
+{
+    QMutexLocker locker(&m_mutex);
+    m_reserved -= reservedKB;
+    --m_numReservations;
+    m_resident += actualKB;
+}
+
+void MemoryBudget::unreserve(qint64 kbytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_reserved -= kbytes;
+    --m_numReservations;
+}
+
+void MemoryBudget::release(qint64 kbytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_resident -= kbytes;
+}
+
+qint64 MemoryBudget::trialFootprint(const Trial* trial)
+{
+    const AbstractGraph* graph = trial->graph();
+    if (!graph) {
+        return 0;
+    }
+
+    // a rough approximation of the allocations made by the std containers:
+    // each element of a hash map also holds a pointer and a cached hash
+    const qint64 entry = 2 * sizeof(void*) + sizeof(std::pair<const int, Node>);
+    const qint64 block = 2 * sizeof(void*); // the shared_ptr's control block
+
+    const Nodes& nodes = graph->nodes();
+    qint64 nodeBytes = 0;
+    if (!nodes.empty()) {
+        const qint64 numAttrs = nodes.atIndex(0).attrs().size();
+        // the node columns hold two copies (double-buffered) of each attribute
+        nodeBytes = sizeof(DNode) + block + entry + 3 * numAttrs * sizeof(Value);
+    }
+
+    const Edges& edges = graph->edges();
+    qint64 edgeBytes = 0;
+    if (edges.m_compact) {
+        // the edges are only in the CSR view (in both nodes)
+        edgeBytes = 2 * sizeof(int);
+    } else if (!edges.empty()) {
+        const Attributes* attrs = edges.begin()->second.attrs();
+        const qint64 numAttrs = attrs ? attrs->size() : 0;
+        // each edge is in the graph and in both nodes
+        edgeBytes = sizeof(BaseEdge) + block + 3 * entry
+                  + sizeof(Attributes) + numAttrs * sizeof(Value);
+    }
+
+    const qint64 bytes = static_cast<qint64>(nodes.size()) * nodeBytes
+                       + static_cast<qint64>(edges.size()) * edgeBytes;
+    return bytes / 1024 + 1;
+}
+
+qint64 MemoryBudget::residentSetSize()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    // size resident shared text lib data dt (in pages)
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    bool ok = false;
+    const qint64 pages = fields.size() > 1 ? fields.at(1).toLongLong(&ok) : 0;
+    return ok ? pages * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+#else
+    return -1;
+#endif
+}
+
+} // evoplex
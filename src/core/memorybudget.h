@@ -0,0 +1,83 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QMutex>
+
+namespace evoplex {
+
+class Trial;
+
+/**
+ * @brief Keeps track of the memory used by the trials.
+ *
+ * A trial reserves its expected footprint before being initialized, and
+ * commits the actual one afterwards (i.e., it becomes resident) until it
+ * is deleted. When available (i.e., on Linux), the resident set size of
+ * the process is used to correct the estimates, which do not account for
+ * everything a trial allocates (e.g., the output caches).
+ *
+ * All values are in KB. This class IS thread-safe.
+ */
+class MemoryBudget
+{
+public:
+    MemoryBudget();
+
+    // the max amount of memory the trials might use; 0 means no limit
+    void setLimit(qint64 kbytes);
+    inline qint64 limit() const;
+
+    // Reserves 'kbytes' if it fits in the budget (or if 'force' is true)
+    // Returns true if successful
+    bool tryReserve(qint64 kbytes, bool force);
+    // returns the number of reservations not committed yet
+    int numReservations();
+    // turns a reservation into resident memory
+    void commit(qint64 reservedKB, qint64 actualKB);
+    // cancels a reservation (e.g., the trial could not be initialized)
+    void unreserve(qint64 kbytes);
+    // releases the resident memory of a deleted trial
+    void release(qint64 kbytes);
+
+    // Estimates the memory used by a trial from the number of nodes
+    // and edges and from the number of attributes of each one
+    static qint64 trialFootprint(const Trial* trial);
+
+    // Returns the resident set size of this process or -1 if unknown
+    static qint64 residentSetSize();
+
+private:
+    QMutex m_mutex;
+    qint64 m_limit;
+    qint64 m_reserved;
+    int m_numReservations;
+    qint64 m_resident;
+    qint64 m_baseline; // the RSS when there were no trials
+};
+
+/************************************************************************
+   MemoryBudget: Inline member functions
+ ************************************************************************/
+
+inline qint64 MemoryBudget::limit() const
+{ return m_limit; }
+
+} // evoplex
+#endif // MEMORYBUDGET_H
@@ -15,6 +15,7 @@
  */
 
 #include "include/node.h"
+#include "include/nodes.h"
 #include "node_p.h"
 
 namespace evoplex {
@@ -103,4 +104,59 @@ void Node::setY(float y)
 void Node::setCoords(float x, float y)
 { m_ptr->setCoords(x, y); }
 
+/*******************/
+
+int Nodes::indexOf(const Node& node) const
+{ return node.m_ptr->m_index; }
+
+std::pair<Nodes::iterator, bool> Nodes::insert(const value_type& p)
+{
+    auto r = std::unordered_map<int, Node>::insert(p);
+    if (r.second) {
+        p.second.m_ptr->m_index = static_cast<int>(m_dense.size());
+        m_dense.emplace_back(p.second);
+    }
+    return r;
+}
+
+Nodes::size_type Nodes::erase(int nodeId)
+{
+    auto it = find(nodeId);
+    if (it == cend()) {
+        return 0;
+    }
+    erase(it);
+    return 1;
+}
+
+Nodes::iterator Nodes::erase(const_iterator it)
+{
+    // swap-remove
+    const auto idx = static_cast<size_t>(it->second.m_ptr->m_index);
+    if (idx + 1 < m_dense.size()) {
+        m_dense[idx] = m_dense.back();
+        m_dense[idx].m_ptr->m_index = static_cast<int>(idx);
+    }
+    m_dense.pop_back();
+    return std::unordered_map<int, Node>::erase(it);
+}
+
+void Nodes::clear()
+{
+    std::unordered_map<int, Node>::clear();
+    m_dense.clear();
+}
+
+void Nodes::reserve(size_type n)
+{
+    std::unordered_map<int, Node>::reserve(n);
+    m_dense.reserve(n);
+}
+
+void Nodes::swap(Nodes& other)
+{
+    std::unordered_map<int, Node>::swap(other);
+    m_dense.swap(other.m_dense);
+}
+
 } // evoplex
@@ -22,9 +22,11 @@ namespace evoplex {
 
 BaseNode::BaseNode(const constructor_key&, int id, const Attributes& attrs, float x, float y)
     : m_id(id),
+      m_index(-1),
       m_attrs(attrs),
       m_x(x),
-      m_y(y)
+      m_y(y),
+      m_stateHash(nullptr)
 {
 }
 
@@ -40,8 +42,8 @@ Node BaseNode::randNeighbour(PRG* prg) const
     if (m_outEdges.empty()) {
         return Node();
     }
-    auto i = prg->uniform(outDegree()-1);
-    return std::next(m_outEdges.cbegin(), i)->second.neighbour();
+    auto i = prg->uniform(static_cast<int>(m_outEdges.size())-1);
+    return m_outEdges.neighbourAt(i);
 }
 
 /*******************/
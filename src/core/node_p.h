@@ -22,6 +22,7 @@
 #include "attributes.h"
 #include "edges.h"
 #include "prg.h"
+#include "statehash.h"
 
 namespace evoplex {
 
@@ -38,6 +39,7 @@ class NodeInterface
     friend class Nodes;
     friend class TestNode;
     friend class TestEdge;
+    friend class TestTopology;
 
 public:
     //! Destructor.
@@ -96,7 +98,9 @@ private:
 class BaseNode : public NodeInterface
 {
     friend class AbstractGraph;
+    friend class Nodes;
     friend class NodesPrivate;
+    friend class StateHash;
     friend class TestNode;
     friend class TestEdge;
 
@@ -158,9 +162,11 @@ protected:
 
 private:
     const int m_id;
+    int m_index; // position in the Nodes container
     Attributes m_attrs;
     float m_x;
     float m_y;
+    StateHash* m_stateHash; // not null if the changes must be tracked
 };
 
 /**
@@ -196,6 +202,8 @@ private:
  */
 class DNode : public BaseNode
 {
+    friend class AbstractGraph;
+
 public:
     explicit DNode(const constructor_key& k, int id, const Attributes& attrs, float x, float y);
     explicit DNode(const constructor_key& k, int id, const Attributes& attrs);
@@ -233,7 +241,12 @@ inline Value BaseNode::attr(const QString& name, Value defaultValue) const
 { return m_attrs.value(name, defaultValue); }
 
 inline void BaseNode::setAttr(int id, const Value& value)
-{ m_attrs.setValue(id, value); }
+{
+    if (m_stateHash) {
+        m_stateHash->update(m_id, id, m_attrs.value(id), value);
+    }
+    m_attrs.setValue(id, value);
+}
 
 inline int BaseNode::id() const
 { return m_id; }
@@ -279,19 +292,19 @@ inline void UNode::addInEdge(const Edge& inEdge)
 { addOutEdge(inEdge); }
 
 inline void UNode::addOutEdge(const Edge& outEdge)
-{ m_outEdges.insert({outEdge.id(), outEdge}); }
+{ m_outEdges.addEdge(outEdge); }
 
 inline void UNode::removeInEdge(const int edgeId)
 { removeOutEdge(edgeId); }
 
 inline void UNode::removeOutEdge(const int edgeId)
-{ m_outEdges.erase(edgeId); }
+{ m_outEdges.removeEdge(edgeId); }
 
 inline void UNode::clearInEdges()
 { clearOutEdges(); }
 
 inline void UNode::clearOutEdges()
-{ m_outEdges.clear(); }
+{ m_outEdges.clearEdges(); }
 
 /************************************************************************
    DNode: Inline member functions
@@ -316,22 +329,22 @@ inline int DNode::outDegree() const
 { return static_cast<int>(m_outEdges.size()); }
 
 inline void DNode::addInEdge(const Edge& inEdge)
-{ m_inEdges.insert({inEdge.id(), inEdge}); }
+{ m_inEdges.addEdge(inEdge); }
 
 inline void DNode::addOutEdge(const Edge& outEdge)
-{ m_outEdges.insert({outEdge.id(), outEdge}); }
+{ m_outEdges.addEdge(outEdge); }
 
 inline void DNode::removeInEdge(const int edgeId)
-{ m_inEdges.erase(edgeId); }
+{ m_inEdges.removeEdge(edgeId); }
 
 inline void DNode::removeOutEdge(const int edgeId)
-{ m_outEdges.erase(edgeId); }
+{ m_outEdges.removeEdge(edgeId); }
 
 inline void DNode::clearInEdges()
-{ m_inEdges.clear(); }
+{ m_inEdges.clearEdges(); }
 
 inline void DNode::clearOutEdges()
-{ m_outEdges.clear(); }
+{ m_outEdges.clearEdges(); }
 
 } // evoplex
 #endif // NODE_P_H
@@ -0,0 +1,174 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/nodecolumns.h"
+#include "node_p.h"
+#include "statehash.h"
+
+namespace evoplex {
+
+AbstractNodeColumn::AbstractNodeColumn(int attrId)
+    : m_attrId(attrId),
+      m_size(0),
+      m_doubleBuffered(false),
+      m_modified(false),
+      m_nextWritten(false),
+      m_storedHash(0),
+      m_storedHashValid(false),
+      m_hashed(false),
+      m_hash(0),
+      m_hashValid(false),
+      m_nextDelta(0),
+      m_nextRaw(false)
+{
+}
+
+void AbstractNodeColumn::loadNodeIds(const Nodes& nodes)
+{
+    m_nodeIds.clear();
+    if (m_hashed) {
+        m_nodeIds.reserve(nodes.size());
+        for (int i = 0; i < m_size; ++i) {
+            m_nodeIds.emplace_back(nodes.atIndex(i).id());
+        }
+    }
+    m_hashValid.store(false, std::memory_order_relaxed);
+    m_nextDelta.store(0, std::memory_order_relaxed);
+    m_nextRaw.store(false, std::memory_order_relaxed);
+}
+
+void AbstractNodeColumn::store(const Nodes& nodes)
+{
+    Q_ASSERT_X(m_size == static_cast<int>(nodes.size()), "NodeColumn",
+               "the set of nodes has changed; the column must be reloaded");
+    for (int i = 0; i < m_size; ++i) {
+        // the unchanged values are skipped, so the nodes keep sharing
+        // them with the other trials (see Attributes)
+        const NodePtr& node = nodes.atIndex(i).m_ptr;
+        const Value& stored = node->attr(m_attrId);
+        if (!isStored(i, stored)) {
+            const Value value = valueAt(i);
+            if (m_storedHashValid) {
+                m_storedHash += StateHash::term(node->id(), m_attrId, value)
+                              - StateHash::term(node->id(), m_attrId, stored);
+            }
+            node->setAttr(m_attrId, value);
+        }
+    }
+    m_modified.store(false, std::memory_order_relaxed);
+}
+
+quint64 AbstractNodeColumn::hash(const Nodes& nodes) const
+{
+    if (m_hashed && m_hashValid.load(std::memory_order_relaxed)) {
+        return m_hash.load(std::memory_order_relaxed);
+    }
+    quint64 value = 0;
+    for (int i = 0; i < m_size; ++i) {
+        value += StateHash::term(nodes.atIndex(i).id(), m_attrId, valueAt(i));
+    }
+    if (m_hashed) {
+        m_hash.store(value, std::memory_order_relaxed);
+        m_hashValid.store(true, std::memory_order_relaxed);
+    }
+    return value;
+}
+
+quint64 AbstractNodeColumn::term(int nodeIdx, const Value& v) const
+{
+    return StateHash::term(m_nodeIds[static_cast<size_t>(nodeIdx)], m_attrId, v);
+}
+
+quint64 AbstractNodeColumn::storedHash(const Nodes& nodes) const
+{
+    // the nodes' attributes change only in store(), so it is
+    // computed once after each load()
+    if (!m_storedHashValid) {
+        m_storedHash = 0;
+        for (int i = 0; i < m_size; ++i) {
+            const Node& node = nodes.atIndex(i);
+            m_storedHash += StateHash::term(node.id(), m_attrId, node.attr(m_attrId));
+        }
+        m_storedHashValid = true;
+    }
+    return m_storedHash;
+}
+
+/*******************/
+
+const AbstractNodeColumn* NodeColumns::find(int attrId) const
+{
+    if (m_stale) {
+        return nullptr;
+    }
+    for (auto const& col : m_columns) {
+        if (col->attrId() == attrId) {
+            return col.get();
+        }
+    }
+    return nullptr;
+}
+
+void NodeColumns::setHashed(const Nodes& nodes, bool hashed)
+{
+    m_hashed = hashed;
+    for (auto& col : m_columns) {
+        col->m_hashed = hashed;
+        if (!m_stale) {
+            col->loadNodeIds(nodes);
+        }
+    }
+}
+
+void NodeColumns::sync(const Nodes& nodes)
+{
+    if (m_stale) {
+        return;
+    }
+    for (auto& col : m_columns) {
+        if (col->isModified()) {
+            col->store(nodes);
+        }
+    }
+}
+
+void NodeColumns::invalidate(const Nodes& nodes)
+{
+    sync(nodes);
+    m_stale = true;
+}
+
+void NodeColumns::reload(const Nodes& nodes)
+{
+    for (auto& col : m_columns) {
+        col->load(nodes);
+    }
+    m_stale = false;
+}
+
+void NodeColumns::swapBuffers()
+{
+    if (m_stale) {
+        return;
+    }
+    for (auto& col : m_columns) {
+        if (col->isDoubleBuffered()) {
+            col->swapBuffers();
+        }
+    }
+}
+
+} // evoplex
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <QDataStream>
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
@@ -22,20 +23,151 @@
 
 #include "nodes_p.h"
 #include "attrsgenerator.h"
+#include "constants.h"
 #include "node_p.h"
 
 namespace evoplex {
 
+/**
+ * @brief A contiguous block of nodes of the same type.
+ * The block is released only when all its nodes are gone, i.e., the
+ * nodes removed from a graph are only destroyed along with the others.
+ */
+template<class T>
+class NodesBlock
+{
+public:
+    explicit NodesBlock(size_t capacity)
+        : m_data(static_cast<T*>(::operator new(capacity * sizeof(T)))),
+          m_size(0) {}
+
+    ~NodesBlock()
+    {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_data[i].~T();
+        }
+        ::operator delete(m_data);
+    }
+
+    template<typename... Args>
+    T* emplace(Args&&... args)
+    {
+        T* node = new (m_data + m_size) T(std::forward<Args>(args)...);
+        ++m_size;
+        return node;
+    }
+
+private:
+    T* m_data;
+    size_t m_size;
+};
+
 Nodes NodesPrivate::clone(const Nodes& nodes)
 {
     Nodes ret;
-    ret.reserve(nodes.size());
-    for (auto const& pair : nodes) {
-        ret.insert({pair.first, pair.second.clone()});
+    if (nodes.empty()) {
+        return ret;
+    }
+
+    if (dynamic_cast<const DNode*>(nodes.atIndex(0).m_ptr.get())) {
+        cloneInto<DNode>(nodes, ret);
+    } else {
+        cloneInto<UNode>(nodes, ret);
     }
     return ret;
 }
 
+template<class T>
+void NodesPrivate::cloneInto(const Nodes& nodes, Nodes& ret)
+{
+    // a single allocation for all nodes; each clone holds a reference to
+    // the whole block (aliasing constructor of std::shared_ptr)
+    auto block = std::make_shared<NodesBlock<T>>(nodes.size());
+
+    BaseNode::constructor_key k;
+    ret.reserve(nodes.size());
+    // keep the same order, i.e., the same Nodes::atIndex()
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const BaseNode* node = nodes.atIndex(static_cast<int>(i)).m_ptr.get();
+        Q_ASSERT_X(dynamic_cast<const T*>(node), "clone",
+                   "all nodes must be of the same type");
+        // the attributes' values are shared until they are changed
+        T* c = block->emplace(k, node->id(), node->attrs(), node->x(), node->y());
+        ret.insert({node->id(), Node(NodePtr(block, c))});
+    }
+}
+
+void NodesPrivate::writeNodes(const Nodes& nodes, QDataStream& out)
+{
+    std::vector<QString> names;
+    if (!nodes.empty()) {
+        names = nodes.atIndex(0).attrs().names();
+    }
+    out << static_cast<quint32>(names.size());
+    for (const QString& name : names) {
+        out << name;
+    }
+
+    out << static_cast<quint32>(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes.atIndex(static_cast<int>(i));
+        out << static_cast<qint32>(node.id()) << node.x() << node.y();
+        for (const Value& value : node.attrs().values()) {
+            out << value;
+        }
+    }
+}
+
+Nodes NodesPrivate::readNodes(QDataStream& in, const GraphType& graphType, QString& error)
+{
+    const bool isDirected = graphType == GraphType::Directed;
+    Q_ASSERT_X(isDirected || graphType == GraphType::Undirected,
+               "Nodes", "graph type must be 'directed' or 'undirected'");
+
+    quint32 numAttrs;
+    in >> numAttrs;
+    std::vector<QString> names(numAttrs);
+    for (QString& name : names) {
+        in >> name;
+    }
+    const auto schema = std::make_shared<const AttributesSchema>(names);
+
+    quint32 numNodes;
+    in >> numNodes;
+    if (in.status() != QDataStream::Ok || numNodes > EVOPLEX_MAX_NODES) {
+        error += "unable to read the set of nodes.";
+        return Nodes();
+    }
+
+    BaseNode::constructor_key k;
+    Nodes nodes;
+    nodes.reserve(numNodes);
+    for (quint32 i = 0; i < numNodes; ++i) {
+        qint32 id;
+        float x, y;
+        in >> id >> x >> y;
+        Attributes attrs(schema);
+        for (quint32 attrId = 0; attrId < numAttrs; ++attrId) {
+            Value value;
+            in >> value;
+            attrs.setValue(static_cast<int>(attrId), value);
+        }
+        if (in.status() != QDataStream::Ok) {
+            error += QString("unable to read the node at position %1.").arg(i);
+            return Nodes();
+        }
+
+        Node node;
+        if (isDirected) {
+            node.m_ptr = std::make_shared<DNode>(k, id, attrs, x, y);
+        } else {
+            node.m_ptr = std::make_shared<UNode>(k, id, attrs, x, y);
+        }
+        nodes.insert({id, node});
+    }
+    return nodes;
+}
+
 Nodes NodesPrivate::fromCmd(const QString& cmd, const AttributesScope& attrsScope,
         const GraphType& graphType, QString& error, std::function<void(int)> progress)
 {
@@ -100,11 +232,12 @@ Nodes NodesPrivate::fromFile(const QString& filePath, const AttributesScope& att
     }
 
     // create set of attributes
+    const AttributesSchemaPtr schema = AttrsGenerator::createSchema(attrsScope);
     int row = 0;
     Nodes nodes;
     while (!in.atEnd()) {
         QStringList values = in.readLine().split(",");
-        Node node = readRow(row, header, values, attrsScope, isDirected, error);
+        Node node = readRow(row, header, values, attrsScope, schema, isDirected, error);
         if (node.isNull()) {
             qWarning() << error;
             return Nodes();
@@ -196,7 +329,8 @@ QStringList NodesPrivate::validateHeader(const QString& header,
 }
 
 Node NodesPrivate::readRow(const int row, const QStringList& header, const QStringList& values,
-        const AttributesScope& attrsScope, const bool isDirected, QString& error)
+        const AttributesScope& attrsScope, const AttributesSchemaPtr& schema,
+        const bool isDirected, QString& error)
 {
     if (values.size() != header.size()) {
         error += QString("the row %1 should have % columns!").arg(row).arg(header.size());
@@ -206,7 +340,7 @@ Node NodesPrivate::readRow(const int row, const QStringList& header, const QStri
     AttributeRangePtr attrRange;
     float coordX = 0.f;
     float coordY = row;
-    Attributes attrs(attrsScope.size());
+    Attributes attrs(schema);
     for (int col = 0; col < values.size(); ++col) {
         bool isValid = true;
         if (header.at(col) == "x") {
@@ -218,7 +352,7 @@ Node NodesPrivate::readRow(const int row, const QStringList& header, const QStri
             if (attrRange) { // is null if the column is not required
                 Value value = attrRange->validate(values.at(col));
                 if (value.isValid()) {
-                    attrs.replace(attrRange->id(), header.at(col), value);
+                    attrs.setValue(attrRange->id(), value);
                 } else {
                     isValid = false;
                 }
@@ -53,9 +53,26 @@ public:
                            std::function<void(int)> progress = [](int){});
 
     // clone a Nodes container
+    // the clones are allocated in a single block and share the values
+    // of their attributes with 'nodes' until they are changed
+    // note that the block is released only when all its nodes are gone, so
+    // a node removed from the graph (e.g., AbstractGraph::removeNode()) keeps
+    // its memory, including its attributes, until the trial is deleted
+    // (the nodes added by AbstractGraph::addNode() are allocated one by one)
     static Nodes clone(const Nodes& nodes);
 
+    // Writes the nodes (ids, coordinates and attributes) to a binary stream
+    // The nodes are written in the same order, i.e., the same Nodes::atIndex()
+    static void writeNodes(const Nodes& nodes, QDataStream& out);
+
+    // Reads a set of nodes written by writeNodes()
+    // Return empty if something goes wrong
+    static Nodes readNodes(QDataStream& in, const GraphType& graphType, QString& error);
+
 private:
+    template<class T>
+    static void cloneInto(const Nodes& nodes, Nodes& ret);
+
     // Checks if the header is in comma-separated format,
     // don't have duplicates, has (or not) 2d coordinates ('x' and 'y')
     // and has all the required attributes (attrsScope)
@@ -64,7 +81,8 @@ private:
 
     static Node readRow(const int row, const QStringList& header,
             const QStringList& values, const AttributesScope& attrsScope,
-            const bool isDirected, QString& error);
+            const AttributesSchemaPtr& schema, const bool isDirected,
+            QString& error);
 };
 
 } // evoplex
@@ -24,16 +24,52 @@
 namespace evoplex
 {
 
+Cache::Block::Block(const size_t numCols, const size_t numRows)
+    : rows(numRows),
+      steps(numRows),
+      values(numCols * numRows),
+      next(nullptr)
+{
+}
+
+Cache::Data::~Data()
+{
+    while (head) {
+        Block* next = head->next.load(std::memory_order_relaxed);
+        delete head;
+        head = next;
+    }
+    delete spare.load(std::memory_order_relaxed);
+}
+
 Cache::Cache(const Values& inputs, const std::vector<int>& trialIds, OutputPtr parent)
     : m_parent(parent)
     , m_inputs(inputs)
+    , m_capacity(0)
 {
     Q_ASSERT_X(!m_inputs.empty(), "Cache", "inputs cannot be empty");
     for (int trialId : trialIds) {
-        m_trials.insert({trialId, Data()});
+        m_trials.insert({trialId, new Data()});
     }
 }
 
+Cache::~Cache()
+{
+    for (auto& it : m_trials) {
+        delete it.second;
+    }
+}
+
+void Cache::setCapacity(const int n)
+{
+    Q_ASSERT_X(n >= 0, "Cache", "the capacity must be positive");
+    for (auto const& it : m_trials) {
+        // the ring buffer is allocated along with the first row
+        Q_ASSERT_X(!it.second->tail, "Cache", "the capacity cannot be changed after a row is written");
+    }
+    m_capacity = n;
+}
+
 void Cache::deleteCache()
 {
     m_parent->deleteCache(this);
@@ -41,9 +77,10 @@ void Cache::deleteCache()
 
 bool Cache::isEmpty(const int trialId) const
 {
-    std::unordered_map<int, Data>::const_iterator trial = m_trials.find(trialId);
+    auto trial = m_trials.find(trialId);
     if (trial != m_trials.end()) {
-        return trial->second.rows.empty();
+        const Data* data = trial->second;
+        return data->numRead == data->numWritten.load(std::memory_order_acquire);
     }
     return false;
 }
@@ -54,13 +91,113 @@ QString Cache::printableHeader(const char sep, const bool joinInputs) const
                                    m_inputs, sep, joinInputs);
 }
 
+void Cache::readFrontRow(const int trialId, Values& out) const
+{
+    Data* data = m_trials.at(trialId);
+    advanceHead(data);
+    const Value* values = data->head->values.data() + data->headRow;
+    for (size_t col = 0; col < m_inputs.size(); ++col) {
+        out.emplace_back(values[col * data->head->rows]);
+    }
+}
+
+void Cache::flushFrontRow(const int trialId)
+{
+    Data* data = m_trials.at(trialId);
+    advanceHead(data);
+    ++data->headRow;
+    ++data->numRead;
+}
+
 void Cache::flushAll()
 {
     for (auto& it : m_trials) {
-        it.second.rows.clear();
+        Data* data = it.second;
+        while (data->numRead != data->numWritten.load(std::memory_order_acquire)) {
+            advanceHead(data);
+            ++data->headRow;
+            ++data->numRead;
+        }
     }
 }
 
+void Cache::advanceHead(Data* data) const
+{
+    if (data->headRow < data->head->rows) {
+        return;
+    } else if (m_capacity > 0) {
+        data->headRow = 0; // wrap around
+        return;
+    }
+
+    // the producer links the next block before writing rows in it
+    Block* read = data->head;
+    data->head = read->next.load(std::memory_order_acquire);
+    data->headRow = 0;
+    read->next.store(nullptr, std::memory_order_relaxed);
+    // keep one block to be reused by the producer
+    delete data->spare.exchange(read, std::memory_order_acq_rel);
+}
+
+void Cache::pushRow(Data* data, const int step, const Values& allValues)
+{
+    if (m_capacity > 0) {
+        pushRowInRing(data, step, allValues);
+        return;
+    }
+
+    if (!data->tail || data->tailRow == BLOCK_ROWS) {
+        Block* block = data->spare.exchange(nullptr, std::memory_order_acq_rel);
+        if (!block) {
+            block = new Block(m_inputs.size(), BLOCK_ROWS);
+        }
+        if (data->tail) {
+            data->tail->next.store(block, std::memory_order_release);
+        } else {
+            // the first row; the consumer will not look at the head
+            // before it reads a row, which happens after the release below
+            data->head = block;
+            data->headRow = 0;
+        }
+        data->tail = block;
+        data->tailRow = 0;
+    }
+
+    writeRow(data, step, allValues);
+    data->numWritten.fetch_add(1, std::memory_order_release);
+}
+
+void Cache::pushRowInRing(Data* data, const int step, const Values& allValues)
+{
+    const size_t capacity = static_cast<size_t>(m_capacity);
+    if (!data->tail) {
+        data->tail = new Block(m_inputs.size(), capacity);
+        data->head = data->tail;
+    } else if (data->tailRow == capacity) {
+        data->tailRow = 0; // wrap around
+    }
+
+    // it's full, so the new row takes the place of the oldest one
+    if (data->numWritten.load(std::memory_order_relaxed) - data->numRead == capacity) {
+        advanceHead(data);
+        ++data->headRow;
+        ++data->numRead;
+    }
+
+    writeRow(data, step, allValues);
+    data->numWritten.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Cache::writeRow(Data* data, const int step, const Values& allValues)
+{
+    Block* block = data->tail;
+    block->steps[data->tailRow] = step;
+    for (size_t col = 0; col < m_columns.size(); ++col) {
+        block->values[col * block->rows + data->tailRow] = allValues[m_columns[col]];
+    }
+    ++data->tailRow;
+}
+
 /*******************************************************/
 /*******************************************************/
 
@@ -86,7 +223,13 @@ void DefaultOutput::doOperation(const Trial* trial)
     switch (m_func) {
     case F_Count:
         if (m_entity == E_Nodes) {
-            allValues = Stats::count(trial->graph()->nodes(), m_attrRange->id(), m_allInputs);
+            // scans the node column (if any), which is faster and up to date
+            auto col = trial->graph()->nodeColumns().find(m_attrRange->id());
+            if (col) {
+                allValues = col->count(m_allInputs);
+            } else {
+                allValues = Stats::count(trial->graph()->nodes(), m_attrRange->id(), m_allInputs);
+            }
         } else {
             allValues = Stats::count(trial->graph()->edges(), m_attrRange->id(), m_allInputs);
         }
@@ -120,6 +263,8 @@ void CustomOutput::doOperation(const Trial* trial)
     if (m_allTrialIds.find(trial->id()) == m_allTrialIds.end()) {
         return;
     }
+    // the model might read the nodes' attributes
+    trial->graph()->syncNodeColumns();
     updateCaches(trial->id(), trial->step(), trial->model()->customOutputs(m_allInputs));
 }
 
@@ -188,31 +333,24 @@ void Output::updateListOfInputs()
     // remove duplicates
     std::sort(m_allInputs.begin(), m_allInputs.end());
     m_allInputs.erase(std::unique(m_allInputs.begin(), m_allInputs.end()), m_allInputs.end());
+
+    // map the columns of each cache to the list of inputs
+    for (Cache* cache : m_caches) {
+        cache->m_columns.clear();
+        for (const Value& input : cache->m_inputs) {
+            auto it = std::lower_bound(m_allInputs.begin(), m_allInputs.end(), input);
+            cache->m_columns.emplace_back(static_cast<int>(it - m_allInputs.begin()));
+        }
+    }
 }
 
 void Output::updateCaches(const int trialId, const int currStep, const Values& allValues)
 {
-    if (m_caches.size() == 0) {
-        return;
-    }
-
     for (Cache* cache : m_caches) {
-        std::unordered_map<int, Cache::Data>::iterator itData = cache->m_trials.find(trialId);
-        if (itData == cache->m_trials.end()) {
-            continue;
-        }
-
-        Cache::Data& data = itData->second;
-        Cache::Row newRow;
-        newRow.first = currStep;
-        newRow.second.reserve(cache->m_inputs.size());
-
-        for (const Value& input : cache->m_inputs) {
-            const size_t col = std::find(m_allInputs.begin(), m_allInputs.end(), input) - m_allInputs.begin();
-            newRow.second.emplace_back(allValues.at(col));
+        auto itData = cache->m_trials.find(trialId);
+        if (itData != cache->m_trials.end()) {
+            cache->pushRow(itData->second, currStep, allValues);
         }
-        if (data.rows.empty()) data.last = data.rows.before_begin();
-        data.last = data.rows.emplace_after(data.last, newRow);
     }
 }
 
@@ -16,7 +16,7 @@
 #ifndef OUTPUT_H
 #define OUTPUT_H
 
-#include <forward_list>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -38,11 +38,29 @@ typedef std::shared_ptr<Output> OutputPtr;
 typedef std::shared_ptr<CustomOutput> CustomOutputPtr;
 typedef std::shared_ptr<DefaultOutput> DefaultOutputPtr;
 
+/**
+ * @brief Holds the rows recorded by an Output for each trial.
+ *
+ * The rows of a trial are stored column by column in blocks of
+ * BLOCK_ROWS rows, i.e., one contiguous array per column plus one
+ * for the step numbers. A block is only allocated when the previous one
+ * is full, and the blocks which have been read are recycled, so nothing
+ * is allocated per step.
+ *
+ * The rows of a trial are a single-producer/single-consumer queue: the
+ * trial appends rows while another thread (e.g., the GUI) reads them.
+ *
+ * A cache might also keep only the last n rows (see setCapacity()), in
+ * which case each trial has a single ring buffer of n rows and the oldest
+ * row not read yet is dropped when a new one arrives. It is meant for
+ * the file outputs, whose rows are read by the trial itself.
+ */
 class Cache
 {
     friend class Output;
+    friend class TestOutput;
 public:
-    typedef std::pair<int, Values> Row; // <rowNumber, values>
+    ~Cache();
 
     bool isEmpty(const int trialId) const;
 
@@ -52,22 +70,68 @@ public:
 
     inline OutputPtr output() const { return m_parent; }
     inline const Values& inputs() const { return m_inputs; }
-    inline const Row& readFrontRow(const int trialId) const { return m_trials.at(trialId).rows.front(); }
-    inline void flushFrontRow(const int trialId) { m_trials.at(trialId).rows.pop_front(); }
+    inline int numColumns() const { return static_cast<int>(m_inputs.size()); }
+
+    // the max number of rows kept for each trial; 0 means no limit
+    inline int capacity() const { return m_capacity; }
+    // the rows must be read and written by the same thread if n>0
+    // it can only be changed while the cache is empty
+    void setCapacity(const int n);
+
+    // the step and the values of the first row not read yet
+    // the trial must not be empty
+    inline int frontStep(const int trialId) const;
+    inline const Value& frontValue(const int trialId, const int col) const;
+    // appends the values of the first row to 'out'
+    void readFrontRow(const int trialId, Values& out) const;
+    void flushFrontRow(const int trialId);
     void flushAll();
 
 private:
+    static const int BLOCK_ROWS = 256;
+
+    struct Block {
+        explicit Block(const size_t numCols, const size_t numRows);
+        const size_t rows;
+        std::vector<int> steps;
+        std::vector<Value> values; // column-major
+        std::atomic<Block*> next;
+    };
+
     struct Data {
-        std::forward_list<Row> rows;
-        std::forward_list<Row>::const_iterator last;
+        Data() : head(nullptr), headRow(0), tail(nullptr), tailRow(0),
+                 numRead(0), numWritten(0), spare(nullptr) {}
+        ~Data();
+        // read by the consumer
+        Block* head;
+        size_t headRow;
+        // written by the producer
+        Block* tail;
+        size_t tailRow;
+        size_t numRead;
+        std::atomic<size_t> numWritten;
+        // a block already read, which is reused by the producer
+        std::atomic<Block*> spare;
     };
 
     OutputPtr m_parent;
     Values m_inputs; // columns
-    std::unordered_map<int, Data> m_trials;
+    int m_capacity;
+    std::unordered_map<int, Data*> m_trials;
+    // m_columns[i] is the position of m_inputs[i] in the parent's allInputs()
+    std::vector<int> m_columns;
 
     // let's keep it private to ensure that only Output can create a Cache
     explicit Cache(const Values& inputs, const std::vector<int>& trialIds, OutputPtr parent);
+
+    // appends a row taking the values of each column from 'allValues'
+    void pushRow(Data* data, const int step, const Values& allValues);
+    void pushRowInRing(Data* data, const int step, const Values& allValues);
+    // writes a row at the tail
+    void writeRow(Data* data, const int step, const Values& allValues);
+    // moves the head to the next block if the current one has been read
+    // or back to the start of the ring buffer
+    void advanceHead(Data* data) const;
 };
 
 class Output : public std::enable_shared_from_this<Output>
@@ -175,5 +239,23 @@ private:
     const AttributeRangePtr m_attrRange;
 };
 
+/************************************************************************
+   Cache: Inline member functions
+ ************************************************************************/
+
+inline int Cache::frontStep(const int trialId) const
+{
+    const Data* data = m_trials.at(trialId);
+    advanceHead(const_cast<Data*>(data));
+    return data->head->steps[data->headRow];
+}
+
+inline const Value& Cache::frontValue(const int trialId, const int col) const
+{
+    const Data* data = m_trials.at(trialId);
+    advanceHead(const_cast<Data*>(data));
+    return data->head->values[col * data->head->rows + data->headRow];
+}
+
 }
 #endif // UTILS_H
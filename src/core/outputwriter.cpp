@@ -0,0 +1,298 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtDebug>
+
+#include "outputwriter.h"
+
+namespace evoplex {
+
+// the number of batches each writer thread can hold
+static const size_t WRITER_QUEUE_CAPACITY = 256;
+// the max number of files each writer thread keeps open
+static const size_t WRITER_MAX_OPEN_FILES = 64;
+// the size of the buffer of each write
+static const int WRITER_BUFFER_SIZE = 1 << 20;
+// the max number of rows in each block of a binary file
+static const size_t WRITER_BLOCK_ROWS = 4096;
+
+OutputWriter::OutputWriter(int numThreads)
+{
+    numThreads = qMax(1, numThreads);
+    m_shards.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        m_shards.emplace_back(new Shard(WRITER_QUEUE_CAPACITY));
+        m_shards.back()->start();
+    }
+}
+
+OutputWriter::~OutputWriter()
+{
+    for (auto& shard : m_shards) {
+        shard->stop();
+    }
+    for (auto& shard : m_shards) {
+        shard->wait();
+    }
+}
+
+OutputWriter::FilePtr OutputWriter::open(const QString& path, Format format)
+{
+    const int shard = static_cast<int>(qHash(path) % m_shards.size());
+    return FilePtr(new File(path, format, shard));
+}
+
+void OutputWriter::write(const FilePtr& file, std::vector<Values> rows, std::vector<int> steps)
+{
+    Q_ASSERT_X(file->m_format != Binary || steps.size() == rows.size(),
+               "OutputWriter", "the rows of a binary file must have a step");
+    if (!rows.empty()) {
+        enqueue(file, std::move(rows), std::move(steps), Batch::Write);
+    }
+}
+
+bool OutputWriter::flush(const FilePtr& file)
+{
+    if (file->m_format == Binary) {
+        // the rows are held until there is enough for a block
+        enqueue(file, std::vector<Values>(), std::vector<int>(), Batch::Flush);
+    }
+
+    QMutexLocker locker(&file->m_mutex);
+    while (file->m_pending.loadAcquire() > 0) {
+        file->m_drained.wait(&file->m_mutex);
+    }
+    return !file->hasError();
+}
+
+bool OutputWriter::close(const FilePtr& file)
+{
+    enqueue(file, std::vector<Values>(), std::vector<int>(), Batch::Close);
+    return flush(file);
+}
+
+void OutputWriter::enqueue(const FilePtr& file, std::vector<Values> rows,
+                           std::vector<int> steps, Batch::Op op)
+{
+    file->m_pending.fetchAndAddOrdered(1);
+    m_shards[file->m_shard]->push(new Batch{file, std::move(rows), std::move(steps), op});
+}
+
+OutputWriter::Shard::Shard(size_t capacity)
+    : m_queue(capacity),
+      m_sleeping(0),
+      m_stopped(0)
+{
+}
+
+void OutputWriter::Shard::push(Batch* batch)
+{
+    // backpressure: wait for the writer if the queue is full
+    int spins = 0;
+    while (!m_queue.tryPush(batch)) {
+        if (++spins < 64) {
+            QThread::yieldCurrentThread();
+        } else {
+            QThread::msleep(1);
+        }
+    }
+
+    if (m_sleeping.testAndSetOrdered(1, 0)) {
+        m_wakeUp.release();
+    }
+}
+
+void OutputWriter::Shard::stop()
+{
+    m_stopped.fetchAndStoreOrdered(1);
+    if (m_sleeping.testAndSetOrdered(1, 0)) {
+        m_wakeUp.release();
+    }
+}
+
+void OutputWriter::Shard::run()
+{
+    Batch* batch = nullptr;
+    for (;;) {
+        if (m_queue.tryPop(batch)) {
+            process(batch);
+            continue;
+        }
+
+        if (m_stopped.loadAcquire()) {
+            break; // nothing left to write
+        }
+
+        // tell the producers we're going to sleep, then look again,
+        // as something might have been pushed in the meantime
+        m_sleeping.fetchAndStoreOrdered(1);
+        if (m_queue.tryPop(batch)) {
+            m_sleeping.fetchAndStoreOrdered(0);
+            process(batch);
+        } else if (!m_stopped.loadAcquire()) {
+            m_wakeUp.acquire();
+        }
+    }
+
+    for (const FilePtr& file : m_openFiles) {
+        file->m_file.close();
+    }
+    m_openFiles.clear();
+}
+
+void OutputWriter::Shard::process(Batch* batch)
+{
+    const FilePtr& file = batch->file;
+    const bool isBinary = file->m_format == Binary;
+    // no need to open a file just to close it, unless it needs an index
+    const bool untouched = !file->m_file.isOpen() && !file->m_indexLoaded;
+
+    if (batch->op == Batch::Close && untouched) {
+        // nothing to do
+    } else if (!file->hasError()) {
+        QFile* f = openFile(file);
+        bool ok = f != nullptr;
+        if (!ok) {
+            qWarning() << "unable to write the output. Could not open" << file->path();
+        } else if (!isBinary) {
+            ok = writeCsv(f, batch->rows);
+        } else if (batch->op == Batch::Write) {
+            file->m_rows.insert(file->m_rows.end(),
+                                std::make_move_iterator(batch->rows.begin()),
+                                std::make_move_iterator(batch->rows.end()));
+            file->m_steps.insert(file->m_steps.end(), batch->steps.begin(), batch->steps.end());
+            if (file->m_rows.size() >= WRITER_BLOCK_ROWS) {
+                ok = writeBlock(file, f);
+            }
+        } else {
+            ok = writeBlock(file, f) && (batch->op != Batch::Close || writeIndex(file, f));
+        }
+
+        if (f && !ok) {
+            qWarning() << "unable to write the output. Could not write in" << file->path();
+        }
+        if (!ok) {
+            file->m_error.fetchAndStoreOrdered(1);
+        }
+    }
+
+    if (batch->op == Batch::Close) {
+        m_openFiles.remove(file);
+        file->m_file.close();
+    }
+
+    // keep a reference to the file; the batch owns the last one
+    FilePtr f = file;
+    delete batch;
+    if (f->m_pending.fetchAndSubOrdered(1) == 1) {
+        QMutexLocker locker(&f->m_mutex);
+        f->m_drained.wakeAll();
+    }
+}
+
+QFile* OutputWriter::Shard::openFile(const FilePtr& file)
+{
+    if (file->m_file.isOpen()) {
+        // move it to the front of the list
+        if (m_openFiles.front() != file) {
+            m_openFiles.remove(file);
+            m_openFiles.push_front(file);
+        }
+        return &file->m_file;
+    }
+
+    file->m_file.setFileName(file->path());
+    if (!file->m_file.open(QFile::WriteOnly | QFile::Append)) {
+        return nullptr;
+    } else if (file->m_format == Binary && !file->m_indexLoaded
+               && !loadIndex(file, &file->m_file)) {
+        file->m_file.close();
+        return nullptr;
+    }
+
+    m_openFiles.push_front(file);
+    if (m_openFiles.size() > WRITER_MAX_OPEN_FILES) {
+        m_openFiles.back()->m_file.close();
+        m_openFiles.pop_back();
+    }
+    return &file->m_file;
+}
+
+bool OutputWriter::Shard::writeCsv(QFile* f, const std::vector<Values>& rows)
+{
+    QByteArray buffer;
+    buffer.reserve(WRITER_BUFFER_SIZE);
+    bool ok = true;
+    for (const Values& row : rows) {
+        for (const Value& value : row) {
+            buffer.append(value.toQString().toUtf8());
+            buffer.append(',');
+        }
+        if (!row.empty()) {
+            buffer.chop(1);
+        }
+        buffer.append('\n');
+
+        if (buffer.size() >= WRITER_BUFFER_SIZE) {
+            ok = ok && f->write(buffer) == buffer.size();
+            buffer.clear();
+        }
+    }
+    return ok && f->write(buffer) == buffer.size() && f->flush();
+}
+
+bool OutputWriter::Shard::writeBlock(const FilePtr& file, QFile* f)
+{
+    if (file->m_rows.empty()) {
+        return true;
+    }
+
+    QByteArray buffer;
+    BinaryOutput::BlockInfo block;
+    QString error;
+    if (!BinaryOutput::appendBlock(buffer, f->size(), file->m_steps, file->m_rows, block, error)) {
+        qWarning() << error << file->path();
+        return false;
+    }
+    file->m_steps.clear();
+    file->m_rows.clear();
+    file->m_blocks.emplace_back(block);
+    return f->write(buffer) == buffer.size() && f->flush();
+}
+
+bool OutputWriter::Shard::writeIndex(const FilePtr& file, QFile* f)
+{
+    const QByteArray index = BinaryOutput::index(file->m_blocks, f->size());
+    return f->write(index) == index.size() && f->flush();
+}
+
+bool OutputWriter::Shard::loadIndex(const FilePtr& file, QFile* f)
+{
+    BinaryOutputReader reader;
+    QString error;
+    if (!reader.open(file->path(), error)) {
+        qWarning() << error;
+        return false;
+    }
+    file->m_blocks = reader.blocks();
+    file->m_indexLoaded = true;
+    const qint64 dataEnd = reader.dataEnd();
+    reader.close();
+    return f->size() == dataEnd || f->resize(dataEnd);
+}
+
+} // evoplex
@@ -0,0 +1,153 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "binaryoutput.h"
+#include "boundedqueue.h"
+#include "value.h"
+
+namespace evoplex {
+
+/**
+ * @brief Writes the rows of the output files in background threads.
+ *
+ * The trials hand batches of rows over to a bounded lock-free queue, and
+ * the writer threads format them and write them with large buffered
+ * writes, keeping the files open. Each file is always written by the same
+ * thread (i.e., the files are sharded among the threads), so its rows are
+ * written in the same order they have been handed over.
+ *
+ * A trial is only slowed down when the queue of its writer is full.
+ */
+class OutputWriter
+{
+public:
+    enum Format {
+        Csv,   // comma-separated values
+        Binary // see BinaryOutput
+    };
+
+    // A file written by the OutputWriter; the errors (e.g., disk full)
+    // are reported by this handle, as they happen asynchronously
+    class File
+    {
+        friend class OutputWriter;
+    public:
+        inline const QString& path() const { return m_path; }
+        inline bool hasError() const { return m_error.loadAcquire() != 0; }
+
+    private:
+        explicit File(const QString& path, Format format, int shard)
+            : m_path(path), m_format(format), m_shard(shard), m_error(0),
+              m_pending(0), m_indexLoaded(false) {}
+
+        const QString m_path;
+        const Format m_format;
+        const int m_shard;
+        QAtomicInt m_error;
+        QAtomicInt m_pending; // number of batches not written yet
+        QMutex m_mutex;
+        QWaitCondition m_drained;
+
+        // only used by the writer thread
+        QFile m_file;
+        bool m_indexLoaded;
+        std::vector<BinaryOutput::BlockInfo> m_blocks;
+        std::vector<int> m_steps; // the rows not written in a block yet
+        std::vector<Values> m_rows;
+    };
+    using FilePtr = std::shared_ptr<File>;
+
+    explicit OutputWriter(int numThreads);
+    // writes everything still in the queues and stops the threads
+    ~OutputWriter();
+
+    // Returns a handle to append rows to an existing file
+    // A binary file must start with a BinaryOutput::header()
+    FilePtr open(const QString& path, Format format=Csv);
+
+    // Hands the rows over to the writer thread
+    // The steps of the rows are only needed by the binary format
+    void write(const FilePtr& file, std::vector<Values> rows,
+               std::vector<int> steps=std::vector<int>());
+
+    // Blocks until all the rows handed over have been written
+    // Returns false if something went wrong
+    bool flush(const FilePtr& file);
+
+    // Flushes and closes the file; the binary files get their index
+    // Returns false if something went wrong
+    bool close(const FilePtr& file);
+
+private:
+    struct Batch {
+        enum Op { Write, Flush, Close };
+        FilePtr file;
+        std::vector<Values> rows;
+        std::vector<int> steps;
+        Op op;
+    };
+
+    class Shard : public QThread
+    {
+    public:
+        explicit Shard(size_t capacity);
+        void push(Batch* batch);
+        void stop();
+
+    protected:
+        void run() override;
+
+    private:
+        BoundedQueue<Batch*> m_queue;
+        QAtomicInt m_sleeping;
+        QSemaphore m_wakeUp;
+        QAtomicInt m_stopped;
+        std::list<FilePtr> m_openFiles; // the most recently used first
+
+        void process(Batch* batch);
+        QFile* openFile(const FilePtr& file);
+        bool writeCsv(QFile* f, const std::vector<Values>& rows);
+        // writes the rows held by the file as a block
+        bool writeBlock(const FilePtr& file, QFile* f);
+        bool writeIndex(const FilePtr& file, QFile* f);
+        // reads the blocks written before the file was opened
+        // and drops its index, as more blocks will be appended
+        bool loadIndex(const FilePtr& file, QFile* f);
+    };
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    void enqueue(const FilePtr& file, std::vector<Values> rows,
+                 std::vector<int> steps, Batch::Op op);
+};
+
+} // evoplex
+#endif // OUTPUTWRITER_H
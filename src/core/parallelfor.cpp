@@ -0,0 +1,82 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QRunnable>
+
+#include "parallelfor.h"
+
+namespace evoplex {
+
+class ParallelFor::Helper : public QRunnable
+{
+public:
+    explicit Helper(LoopPtr loop) : m_loop(loop) { setAutoDelete(true); }
+    void run() override { m_loop->work(); }
+private:
+    LoopPtr m_loop; // keeps the loop alive until the helper is done
+};
+
+void ParallelFor::Loop::work()
+{
+    int chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+    while (chunk < numChunks) {
+        const int begin = chunk * grainSize;
+        const int end = qMin(begin + grainSize, size);
+        func(begin, end, chunk);
+        chunksDone.release();
+        chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ParallelFor::run(QThreadPool* pool, int size, int grainSize, const ChunkFunc& func)
+{
+    if (size < 1) {
+        return;
+    }
+
+    grainSize = qMax(1, grainSize);
+    const int numChunks = (size + grainSize - 1) / grainSize;
+    if (numChunks == 1 || !pool) {
+        for (int c = 0; c < numChunks; ++c) {
+            const int begin = c * grainSize;
+            func(begin, qMin(begin + grainSize, size), c);
+        }
+        return;
+    }
+
+    auto loop = std::make_shared<Loop>();
+    loop->func = func;
+    loop->size = size;
+    loop->grainSize = grainSize;
+    loop->numChunks = numChunks;
+    loop->nextChunk = 0;
+
+    // borrow the idle threads; tryStart() never queues the helper, so we
+    // don't end up waiting for a thread that is busy running other trials
+    for (int i = 1; i < numChunks; ++i) {
+        Helper* helper = new Helper(loop);
+        if (!pool->tryStart(helper)) {
+            delete helper;
+            break;
+        }
+    }
+
+    loop->work();
+    loop->chunksDone.acquire(numChunks);
+}
+
+} // evoplex
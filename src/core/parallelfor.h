@@ -0,0 +1,69 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <QSemaphore>
+#include <QThreadPool>
+
+namespace evoplex {
+
+/**
+ * @brief Splits a range of indexes into chunks and processes them in parallel.
+ *
+ * The calling thread always takes part in the loop; the idle threads of
+ * @p pool (if any) are borrowed to help it. The chunks are handed out
+ * dynamically (i.e., idle threads steal the next pending chunk), and the
+ * helpers are only started when a thread is available, so it is safe to
+ * call it from a QRunnable running in the same @p pool (e.g., a Trial).
+ *
+ * The chunking depends only on the size of the range and on the grain
+ * size, never on the number of threads. Thus, any per-chunk state (e.g.,
+ * a PRG seeded with the chunk index) is deterministic.
+ */
+class ParallelFor
+{
+public:
+    // func(begin, end, chunkIdx)
+    using ChunkFunc = std::function<void(int, int, int)>;
+
+    static void run(QThreadPool* pool, int size, int grainSize, const ChunkFunc& func);
+
+private:
+    struct Loop {
+        ChunkFunc func;
+        int size;
+        int grainSize;
+        int numChunks;
+        std::atomic<int> nextChunk;
+        QSemaphore chunksDone;
+
+        // process chunks until there are no more chunks left
+        void work();
+    };
+    using LoopPtr = std::shared_ptr<Loop>;
+
+    class Helper;
+};
+
+} // evoplex
+#endif // PARALLELFOR_H
@@ -168,6 +168,11 @@ Plugin::Plugin(PluginType type, QPluginLoader* loader, const QString& libPath)
         return;
     }
 
+    if (!readAttrsDefaults()) {
+        m_type = PluginType::Invalid;
+        return;
+    }
+
     m_factory = qobject_cast<PluginInterface*>(m_loader->instance());
     if (!m_factory) {
         qWarning() << QString("factory could not be created for '%1'").arg(m_title);
@@ -216,4 +221,21 @@ bool Plugin::readAttrsScope(const QString& attrName, AttributesScope& attrsScope
     return true;
 }
 
+bool Plugin::readAttrsDefaults()
+{
+    const QJsonObject json = m_metaData.value(PLUGIN_ATTR_ATTRSDEFAULTS).toObject();
+    for (auto it = json.begin(); it != json.end(); ++it) {
+        auto attrRange = m_pluginAttrsScope.value(it.key());
+        const Value value = attrRange ? attrRange->validate(it.value().toVariant().toString())
+                                      : Value();
+        if (!value.isValid()) {
+            qWarning() << QString("invalid default value for the plugin's attribute '%1'")
+                          .arg(it.key());
+            return false;
+        }
+        m_pluginAttrsDefaults.insert(it.key(), value);
+    }
+    return true;
+}
+
 } // evoplex
@@ -60,6 +60,8 @@ public:
     inline const std::vector<QString>& pluginAttrsNames() const;
     inline const AttributesScope& pluginAttrsScope() const;
     inline const AttributeRangePtr pluginAttrRange(const QString& attr) const;
+    // the default value of the attribute 'attr'; it's invalid if there is none
+    inline Value pluginAttrDefault(const QString& attr) const;
 
 protected:
     PluginType m_type;
@@ -87,6 +89,9 @@ private:
     quint16 m_version;
     AttributesScope m_pluginAttrsScope;
     std::vector<QString> m_pluginAttrsNames;
+    QHash<QString, Value> m_pluginAttrsDefaults;
+
+    bool readAttrsDefaults();
 
     static bool checkMetaData(const QJsonObject& metaData, QString& error);
 };
@@ -133,6 +138,9 @@ inline const AttributesScope& Plugin::pluginAttrsScope() const
 inline const AttributeRangePtr Plugin::pluginAttrRange(const QString& attr) const
 { return m_pluginAttrsScope.value(attr); }
 
+inline Value Plugin::pluginAttrDefault(const QString& attr) const
+{ return m_pluginAttrsDefaults.value(attr); }
+
 } // evoplex
 // makes PluginType available to QMetaType system
 Q_DECLARE_METATYPE(evoplex::PluginKey)
@@ -156,7 +156,8 @@ bool Project::editExperiment(int expId, ExpInputsPtr newInputs, QString& error)
     return true;
 }
 
-int Project::importExperiments(const QString& filePath, QString& error)
+int Project::importExperiments(const QString& filePath, QString& error,
+        std::function<bool(const QStringList&, QStringList&)> editRow)
 {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -181,7 +182,11 @@ int Project::importExperiments(const QString& filePath, QString& error)
     // import experiments
     int row = 1;
     while (!in.atEnd()) {
-        const QStringList values = in.readLine().split(",");
+        QStringList values = in.readLine().split(",");
+        if (!editRow(header, values)) {
+            ++row;
+            continue;
+        }
         QString expErrorMsg;
         auto inputs = ExpInputs::parse(m_mainApp, header, values, expErrorMsg);
         if (!expErrorMsg.isEmpty()) {
@@ -17,10 +17,12 @@
 #ifndef PROJECT_H
 #define PROJECT_H
 
+#include <functional>
 #include <memory>
 
 #include <QMutex>
 #include <QObject>
+#include <QStringList>
 
 #include "abstractmodel.h"
 #include "experiment.h"
@@ -55,8 +57,12 @@ public:
     bool editExperiment(int expId, ExpInputsPtr newInputs, QString& error);
 
     // Import a set of experiments from a csv file. It stops if an experiment fails.
+    // 'editRow' is called for each row before parsing it; it can be used
+    // to change the row values or to skip the row (returning false).
     // return the number of experiments imported.
-    int importExperiments(const QString& filePath, QString& error);
+    int importExperiments(const QString& filePath, QString& error,
+            std::function<bool(const QStringList&, QStringList&)> editRow =
+                [](const QStringList&, QStringList&) { return true; });
 
     // Save project into the dest directory.
     // A project is composed of plain csv files
@@ -0,0 +1,73 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtGlobal>
+
+#include "ratetree.h"
+
+namespace evoplex {
+
+RateTree::RateTree(int size)
+{
+    reset(size);
+}
+
+void RateTree::reset(int size)
+{
+    Q_ASSERT_X(size >= 0, "RateTree", "the size must be non-negative");
+    m_size = size;
+    m_leaves = 1;
+    while (m_leaves < size) {
+        m_leaves *= 2;
+    }
+    m_tree.assign(static_cast<size_t>(2 * m_leaves), 0.0);
+}
+
+void RateTree::setRate(int idx, double rate)
+{
+    Q_ASSERT_X(idx >= 0 && idx < m_size, "RateTree", "index out of range");
+    Q_ASSERT_X(rate >= 0.0, "RateTree", "the rate must be non-negative");
+    size_t i = static_cast<size_t>(m_leaves + idx);
+    m_tree[i] = rate;
+    for (i /= 2; i > 0; i /= 2) {
+        m_tree[i] = m_tree[2*i] + m_tree[2*i + 1];
+    }
+}
+
+int RateTree::find(double value) const
+{
+    if (m_tree[1] <= 0.0) {
+        return -1;
+    }
+
+    size_t i = 1;
+    const size_t leaves = static_cast<size_t>(m_leaves);
+    while (i < leaves) {
+        const size_t left = 2 * i;
+        // never go down an empty subtree, even if 'value' is
+        // slightly out of range due to rounding errors
+        if ((value < m_tree[left] && m_tree[left] > 0.0) || m_tree[left + 1] <= 0.0) {
+            i = left;
+        } else {
+            value -= m_tree[left];
+            i = left + 1;
+        }
+    }
+    return static_cast<int>(i - leaves);
+}
+
+} // evoplex
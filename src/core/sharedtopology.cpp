@@ -0,0 +1,98 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "sharedtopology.h"
+#include "abstractgraph.h"
+#include "node_p.h"
+
+namespace evoplex {
+
+SharedTopology::SharedTopology()
+    : m_isCompact(false)
+{
+}
+
+SharedTopologyPtr SharedTopology::capture(const AbstractGraph* graph)
+{
+    Q_ASSERT_X(graph->topology().isValid(), "SharedTopology",
+               "the CSR view must be built before capturing the topology");
+
+    auto st = std::make_shared<SharedTopology>();
+
+    const Nodes& nodes = graph->nodes();
+    st->m_nodeIds.reserve(nodes.size());
+    st->m_coords.reserve(2 * nodes.size());
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+        const Node& node = nodes.atIndex(i);
+        st->m_nodeIds.emplace_back(node.id());
+        st->m_coords.emplace_back(node.x());
+        st->m_coords.emplace_back(node.y());
+    }
+
+    st->m_topology = graph->m_topology;
+    st->m_isCompact = graph->m_compactEdges != nullptr;
+    if (st->m_isCompact) {
+        return st; // the CSR view is enough
+    }
+
+    // the edges are added back in the same order, so that the
+    // neighbours are listed in the same order as well
+    st->m_edges.reserve(graph->edges().size());
+    for (auto const& p : graph->edges()) {
+        const Edge& e = p.second;
+        st->m_edges.push_back({e.id(), e.origin().id(), e.neighbour().id(), *e.attrs()});
+    }
+    std::sort(st->m_edges.begin(), st->m_edges.end(),
+              [](const EdgeData& a, const EdgeData& b) { return a.id < b.id; });
+    return st;
+}
+
+bool SharedTopology::restore(AbstractGraph* graph) const
+{
+    const Nodes& nodes = graph->nodes();
+    if (nodes.size() != m_nodeIds.size() || !graph->edges().empty()) {
+        return false;
+    }
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+        if (nodes.atIndex(i).id() != m_nodeIds[static_cast<size_t>(i)]) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < m_nodeIds.size(); ++i) {
+        Node node = nodes.atIndex(static_cast<int>(i));
+        node.setCoords(m_coords[2*i], m_coords[2*i+1]);
+    }
+
+    if (m_isCompact) {
+        graph->m_topology = m_topology;
+        graph->compactEdges();
+        return true;
+    }
+
+    for (const EdgeData& e : m_edges) {
+        graph->m_lastEdgeId = e.id - 1; // keeps the same edge ids
+        graph->addEdge(nodes.at(e.originId), nodes.at(e.neighbourId), new Attributes(e.attrs));
+    }
+
+    // addEdge() invalidates the view; let's share the captured one
+    graph->m_topology = m_topology;
+    return true;
+}
+
+} // evoplex
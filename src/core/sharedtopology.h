@@ -0,0 +1,74 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHARED_TOPOLOGY_H
+#define SHARED_TOPOLOGY_H
+
+#include <memory>
+#include <vector>
+
+#include "attributes.h"
+#include "topology.h"
+
+namespace evoplex {
+
+class AbstractGraph;
+class SharedTopology;
+using SharedTopologyPtr = std::shared_ptr<const SharedTopology>;
+
+/**
+ * @brief An immutable copy of the topology created by a graph plugin.
+ *
+ * If a graph plugin declares its topology deterministic (i.e., reset()
+ * always creates the same edges for the same nodes and attributes), the
+ * topology is captured from the first trial of an experiment and every
+ * other trial gets it from here, instead of calling reset() again.
+ *
+ * It holds the edges (ids, ends and attributes), the nodes' coordinates
+ * and the CSR view, which is shared as is by all trials. The edges'
+ * attributes are also shared until a trial changes them.
+ */
+class SharedTopology
+{
+public:
+    SharedTopology();
+
+    // captures the topology of 'graph'; the CSR view must be valid
+    static SharedTopologyPtr capture(const AbstractGraph* graph);
+
+    // recreates the topology in 'graph', whose nodes must be the same
+    // as the ones used to capture it and must have no edges
+    // returns false if the nodes do not match
+    bool restore(AbstractGraph* graph) const;
+
+private:
+    struct EdgeData
+    {
+        int id;
+        int originId;
+        int neighbourId;
+        Attributes attrs;
+    };
+
+    std::vector<EdgeData> m_edges; // ordered by id; empty if compact
+    bool m_isCompact; // the edges are in the CSR view only
+    std::vector<int> m_nodeIds; // in the order of Nodes::atIndex()
+    std::vector<float> m_coords; // x,y pairs of each node
+    std::shared_ptr<Topology> m_topology;
+};
+
+} // evoplex
+#endif // SHARED_TOPOLOGY_H
@@ -0,0 +1,114 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "statehash.h"
+#include "node_p.h"
+
+namespace evoplex {
+
+StateHash::StateHash()
+    : m_value(0)
+{
+}
+
+void StateHash::attach(const Nodes& nodes)
+{
+    quint64 value = 0;
+    for (auto const& p : nodes) {
+        BaseNode* node = p.second.m_ptr.get();
+        const Attributes& attrs = node->attrs();
+        for (int attrId = 0; attrId < attrs.size(); ++attrId) {
+            value += term(node->id(), attrId, attrs.value(attrId));
+        }
+        node->m_stateHash = this;
+    }
+    m_value.store(value, std::memory_order_relaxed);
+}
+
+void StateHash::detach(const Nodes& nodes)
+{
+    for (auto const& p : nodes) {
+        if (p.second.m_ptr->m_stateHash == this) {
+            p.second.m_ptr->m_stateHash = nullptr;
+        }
+    }
+}
+
+quint64 StateHash::value(const Nodes& nodes, const NodeColumns& columns) const
+{
+    quint64 value = m_value.load(std::memory_order_relaxed);
+    if (columns.isStale()) {
+        return value; // the nodes hold the current values
+    }
+    for (auto const& col : columns.m_columns) {
+        if (col->isModified()) {
+            value += col->hash(nodes) - col->storedHash(nodes);
+        }
+    }
+    return value;
+}
+
+quint64 StateHash::term(int nodeId, int attrId, const Value& value)
+{
+    // splitmix64 finalizer
+    auto mix = [](quint64 z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    const quint64 key = (static_cast<quint64>(static_cast<quint32>(nodeId)) << 32)
+                      | static_cast<quint32>(attrId);
+    // std::hash<Value> does not accept invalid values (e.g., unset attributes)
+    const quint64 valueHash = value.isValid() ? std::hash<Value>()(value) : 0;
+    return mix(mix(key + 0x9E3779B97F4A7C15ULL) ^ valueHash);
+}
+
+CycleDetector::CycleDetector(int maxPeriod)
+    : m_maxPeriod(maxPeriod),
+      m_head(0)
+{
+    Q_ASSERT_X(maxPeriod > 0, "CycleDetector", "the period must be positive");
+    m_window.reserve(static_cast<size_t>(maxPeriod));
+}
+
+int CycleDetector::push(int step, quint64 hash)
+{
+    int period = 0;
+    auto it = m_lastSeen.find(hash);
+    if (it != m_lastSeen.end() && step - it->second <= m_maxPeriod) {
+        period = step - it->second;
+    }
+    m_lastSeen[hash] = step;
+
+    // keeps the last 'maxPeriod' states, i.e., the
+    // ones the next state will be compared with
+    const size_t capacity = static_cast<size_t>(m_maxPeriod);
+    if (m_window.size() < capacity) {
+        m_window.emplace_back(step, hash);
+    } else {
+        const std::pair<int, quint64>& oldest = m_window[m_head];
+        auto old = m_lastSeen.find(oldest.second);
+        if (old != m_lastSeen.end() && old->second == oldest.first) {
+            m_lastSeen.erase(old);
+        }
+        m_window[m_head] = std::make_pair(step, hash);
+        m_head = (m_head + 1) % capacity;
+    }
+    return period;
+}
+
+} // evoplex
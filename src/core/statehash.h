@@ -0,0 +1,110 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include "nodecolumns.h"
+#include "nodes.h"
+#include "value.h"
+
+namespace evoplex {
+
+/**
+ * @brief A hash of the attributes of all nodes.
+ *
+ * It is the sum of a hash of each (nodeId, attrId, value) triple, so it
+ * does not depend on the order of the nodes and it can be updated in O(1)
+ * when a single attribute changes. Once attached, the nodes report every
+ * BaseNode::setAttr() call to it, including the ones made by the node
+ * columns when they are synced. The terms of an attribute held by a node
+ * column can also be swapped for the ones of the column's values.
+ */
+class StateHash
+{
+public:
+    StateHash();
+
+    // computes the hash of the current state and
+    // makes the nodes report their changes to this object
+    void attach(const Nodes& nodes);
+    // stops tracking the nodes
+    void detach(const Nodes& nodes);
+
+    inline quint64 value() const;
+    // the same, but the attributes held by the 'columns' are read from them,
+    // so the columns do not need to be synced with the 'nodes' first; it
+    // costs O(1) per modified column if they are hashed (see
+    // NodeColumns::setHashed()), and O(n) per column otherwise
+    quint64 value(const Nodes& nodes, const NodeColumns& columns) const;
+
+    // replaces the value of the attribute 'attrId' of the node 'nodeId'
+    // it is thread-safe, i.e., it might be called from parallel loops
+    inline void update(int nodeId, int attrId, const Value& oldValue, const Value& newValue);
+
+    // the hash of the 'value' of the attribute 'attrId' of the node 'nodeId'
+    static quint64 term(int nodeId, int attrId, const Value& value);
+
+private:
+    std::atomic<quint64> m_value;
+};
+
+/**
+ * @brief Finds repeated states in the last steps of a trial.
+ *
+ * It keeps the hashes seen in the last 'maxPeriod' steps, so a fixed
+ * point is found after one step and a cycle of length p after p steps.
+ */
+class CycleDetector
+{
+public:
+    explicit CycleDetector(int maxPeriod);
+
+    // records the 'hash' of the state at 'step'
+    // returns the period if the same state was seen in the
+    // last 'maxPeriod' steps; 0 otherwise
+    int push(int step, quint64 hash);
+
+private:
+    const int m_maxPeriod;
+    std::vector<std::pair<int, quint64>> m_window; // ring of (step, hash)
+    size_t m_head;
+    std::unordered_map<quint64, int> m_lastSeen; // hash -> step
+};
+
+/************************************************************************
+   StateHash: Inline member functions
+ ************************************************************************/
+
+inline quint64 StateHash::value() const
+{ return m_value.load(std::memory_order_relaxed); }
+
+inline void StateHash::update(int nodeId, int attrId, const Value& oldValue, const Value& newValue)
+{
+    if (oldValue != newValue) {
+        // unsigned arithmetic wraps around, so it can be undone
+        m_value.fetch_add(term(nodeId, attrId, newValue) - term(nodeId, attrId, oldValue),
+                          std::memory_order_relaxed);
+    }
+}
+
+} // evoplex
+#endif // STATEHASH_H
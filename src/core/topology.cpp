@@ -0,0 +1,70 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/topology.h"
+#include "include/edges.h"
+
+namespace evoplex {
+
+Topology::Topology()
+    : m_isValid(false),
+      m_isDirected(false)
+{
+}
+
+void Topology::clear()
+{
+    m_isValid = false;
+    m_outOffsets.clear();
+    m_outNeighbours.clear();
+    m_inOffsets.clear();
+    m_inNeighbours.clear();
+}
+
+void Topology::build(const Nodes& nodes, bool isDirected)
+{
+    clear();
+    m_isDirected = isDirected;
+
+    // fills the offsets and neighbours following the nodes' positions;
+    // the neighbours of each node keep the order in which the edges were added
+    auto fill = [&nodes](bool out, std::vector<int>& offsets, std::vector<int>& neighbours) {
+        const size_t n = nodes.size();
+        offsets.resize(n + 1);
+        offsets[0] = 0;
+        size_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const Node& node = nodes.atIndex(static_cast<int>(i));
+            total += (out ? node.outEdges() : node.inEdges()).m_dense.size();
+        }
+        neighbours.reserve(total);
+        for (size_t i = 0; i < n; ++i) {
+            const Node& node = nodes.atIndex(static_cast<int>(i));
+            for (const Edge& e : (out ? node.outEdges() : node.inEdges()).m_dense) {
+                neighbours.emplace_back(nodes.indexOf(e.neighbour()));
+            }
+            offsets[i + 1] = static_cast<int>(neighbours.size());
+        }
+    };
+
+    fill(true, m_outOffsets, m_outNeighbours);
+    if (m_isDirected) {
+        fill(false, m_inOffsets, m_inNeighbours);
+    }
+    m_isValid = true;
+}
+
+} // evoplex
@@ -18,9 +18,11 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QThread>
+#include <QtConcurrent>
 
 #include "abstractgraph.h"
 #include "abstractmodel.h"
+#include "checkpoint.h"
 #include "nodes_p.h"
 #include "trial.h"
 #include "project.h"
@@ -35,7 +37,11 @@ Trial::Trial(const quint16 id, ExperimentPtr exp)
       m_status(Status::Disabled),
       m_prg(nullptr),
       m_graph(nullptr),
-      m_model(nullptr)
+      m_model(nullptr),
+      m_inLoop(false),
+      m_loopTime(0),
+      m_memoryKB(-1),
+      m_memoryProbe(false)
 {
     Q_ASSERT_X(exp, "Trial", "a trial must belong to a valid experiment");
     // important! Trials are deleted by the Experiment class,
@@ -45,6 +51,11 @@ Trial::Trial(const quint16 id, ExperimentPtr exp)
 
 Trial::~Trial()
 {
+    m_checkpointWrite.waitForFinished();
+    closeOutputFile();
+    if (m_cycleDetector) {
+        m_stateHash.detach(m_graph->nodes());
+    }
     delete m_graph;
     delete m_model;
     delete m_prg;
@@ -60,16 +71,51 @@ GraphType Trial::graphType() const
     return  m_exp->graphType();
 }
 
+QThreadPool* Trial::threadPool() const
+{
+    return &m_exp->m_mainApp->expMgr()->m_threadPool;
+}
+
+OutputWriter* Trial::outputWriter() const
+{
+    return &m_exp->m_mainApp->expMgr()->m_outputWriter;
+}
+
 bool Trial::init()
 {
-    if (m_exp->expStatus() == Status::Invalid || m_exp->pauseAt() < 0) {
+    if (initAborted()) {
         return false;
     }
 
-    Nodes nodes = m_exp->cloneCachedNodes(m_id);
-    if (nodes.empty()) {
-        nodes = m_exp->createNodes();
+    // resume from the last checkpoint, if any
+    // the outputs written after it are discarded, so the output file
+    // must have been written at least up to the checkpoint's step
+    std::unique_ptr<Checkpoint> checkpoint;
+    Nodes nodes;
+    // the outputs kept in memory (i.e., the averages across the trials
+    // or the last steps) are not in the checkpoint
+    const bool resumable = !m_exp->aggregator() && m_exp->saveSteps() == 0;
+    const QString ckptPath = checkpointPath();
+    if (!ckptPath.isEmpty() && QFileInfo::exists(ckptPath) && resumable) {
+        QString error;
+        checkpoint = Checkpoint::open(ckptPath, Checkpoint::fingerprint(m_exp.get(), m_id), error);
+        if (checkpoint && QFileInfo(outputFilePath()).size() < checkpoint->outputSize()) {
+            error += "the output file is shorter than expected.";
+            checkpoint.reset();
+        }
+        if (checkpoint) {
+            nodes = checkpoint->readNodes(graphType(), error);
+        }
         if (nodes.empty()) {
+            qWarning() << "unable to resume from the checkpoint; starting over."
+                       << error << ckptPath;
+            checkpoint.reset();
+        }
+    }
+
+    if (nodes.empty()) {
+        nodes = m_exp->initialNodes();
+        if (nodes.empty() || initAborted()) {
             return false;
         }
     }
@@ -93,6 +139,8 @@ bool Trial::init()
                    << "The graph could not be initialized."
                    << "Experiment:" << m_exp->id();
         return false;
+    } else if (initAborted()) {
+        return false;
     }
 
     m_model = dynamic_cast<AbstractModel*>(m_exp->modelPlugin()->create());
@@ -101,14 +149,67 @@ bool Trial::init()
                    << "The model could not be initialized."
                    << "Experiment:" << m_exp->id();
         return false;
+    } else if (initAborted()) {
+        return false;
+    }
+
+    if (checkpoint) {
+        QString error;
+        if (!checkpoint->readState(m_graph, m_prg, m_model, error)) {
+            // the trial is half-restored at this point; better give up
+            qWarning() << "unable to create the trials."
+                       << "Failed to resume from the checkpoint:" << error
+                       << "Experiment:" << m_exp->id();
+            return false;
+        }
+
+        // discard the outputs written after the checkpoint
+        if (!m_exp->inputs()->fileCaches().empty()
+                && !QFile::resize(outputFilePath(), checkpoint->outputSize())) {
+            qWarning() << "unable to create the trials. Could not write in " << outputFilePath();
+            return false;
+        }
+
+        m_step = checkpoint->step();
+        qInfo() << QString("[E%1:T%2] resumed from the checkpoint at step %3.")
+                   .arg(m_exp->id()).arg(m_id).arg(m_step);
+    } else if (!initFresh()) {
+        return false;
+    }
+
+    if (!m_graph->topology().isValid()) {
+        m_graph->freezeTopology();
+    }
+    // a static graph without edge attributes keeps only the CSR view
+    m_graph->compactEdges();
+
+    if (m_exp->cyclePeriod() > 0) {
+        m_stateHash.attach(m_graph->nodes());
+        // the columns' hashes are updated by each write, so the state
+        // is not hashed again in every step (see StateHash::value())
+        m_graph->m_nodeColumns.setHashed(m_graph->m_nodes, true);
+        m_cycleDetector.reset(new CycleDetector(m_exp->cyclePeriod()));
+        m_cycleDetector->push(m_step, m_stateHash.value(m_graph->nodes(), m_graph->nodeColumns()));
     }
 
+    return true;
+}
+
+bool Trial::initFresh()
+{
     if (!m_exp->inputs()->fileCaches().empty()) {
-        const QString fpath = m_exp->m_filePathPrefix + QString("%4.csv").arg(m_id);
+        const QString fpath = outputFilePath();
         QFile file(fpath);
-        if (file.open(QFile::WriteOnly | QFile::Truncate)) {
-            QTextStream stream(&file);
-            stream << m_exp->m_fileHeader;
+        if (m_exp->aggregator()) {
+            // the trials do not have their own files
+        } else if (file.open(QFile::WriteOnly | QFile::Truncate)) {
+            if (m_exp->binaryOutput()) {
+                const QString header = m_exp->m_fileHeader.trimmed();
+                file.write(BinaryOutput::header(header.split(",")));
+            } else {
+                QTextStream stream(&file);
+                stream << m_exp->m_fileHeader;
+            }
             file.close();
         } else {
             qWarning() << "unable to create the trials. Could not write in " << fpath;
@@ -122,25 +223,45 @@ bool Trial::init()
         writeCachedSteps(m_exp.get());
     }
 
-    // make the set of nodes available for other trials
-    if (m_exp->numTrials() > 1 && m_exp->m_clonableNodes.empty()) {
-        m_exp->m_clonableNodes = NodesPrivate::clone(nodes);
-    }
-
     m_step = 0; // important!
 
-    // set-up the edges for the first time
-    if (!m_graph->reset()) {
+    // set-up the edges for the first time; a deterministic topology
+    // is created by the first trial and shared by the others
+    bool ok;
+    if (m_exp->numTrials() > 1 && m_exp->graphPlugin()->isDeterministic()) {
+        bool created = false;
+        SharedTopologyPtr shared = m_exp->sharedTopology([this, &created]() {
+            created = true;
+            if (!m_graph->reset()) {
+                return SharedTopologyPtr();
+            }
+            m_graph->freezeTopology();
+            m_graph->compactEdges();
+            return SharedTopology::capture(m_graph);
+        });
+        // if the first trial has failed, so do the others; a topology
+        // which does not match the nodes (e.g., from a checkpoint) is reset
+        ok = created ? shared != nullptr
+                     : shared && (shared->restore(m_graph) || m_graph->reset());
+    } else {
+        ok = m_graph->reset();
+    }
+
+    if (!ok) {
         qWarning() << "unable to create the trials."
                    << "The graph could not be initialized."
                    << "Experiment:" << m_exp->id();
         return false;
     }
-
     return true;
 }
 
 void Trial::run()
+{
+    runSlice(0);
+}
+
+bool Trial::runSlice(const int quantum)
 {
     if (m_exp->expStatus() == Status::Invalid) {
         m_status = Status::Invalid;
@@ -149,52 +270,102 @@ void Trial::run()
     if (m_status == Status::Invalid || m_status == Status::Running
             || m_status == Status::Finished) {
         m_exp->trialFinished(this);
-        return;
+        return false;
     }
 
     if (m_status == Status::Disabled) {
-        // Ensure we init one trial at a time.
-        // Thus, if one trial fail, the others will be aborted earlier.
-        m_exp->m_mutex.lock();
-        if (!init()) {
-            m_exp->m_mutex.unlock();
+        // The trials are initialized concurrently. If one of them fails,
+        // the experiment is invalidated and paused straight away, so that
+        // the others are aborted at their next check (see initAborted()).
+        const bool ok = init();
+        m_exp->trialInitialized(this, ok);
+        if (!ok) {
             m_status = Status::Invalid;
             m_exp->trialFinished(this);
-            return;
+            return false;
         }
-        m_exp->m_mutex.unlock();
     }
 
     m_status = Status::Running;
-    emit (m_exp->trialCreated(m_id));
+    if (!m_inLoop) { // it's not resuming from the previous slice
+        emit (m_exp->trialCreated(m_id));
+    }
+
+    const bool hasNext = runSteps(quantum);
+    if (m_status == Status::Queued) {
+        return true; // yielded
+    }
 
-    if (!runSteps() || m_step >= m_exp->stopAt()) {
-        if (writeCachedSteps(m_exp.get())) {
+    if (!hasNext || m_step >= m_exp->stopAt()) {
+        if (writeCachedSteps(m_exp.get(), true) && closeOutputFile()) {
             m_status = Status::Finished;
+            // nothing to resume anymore
+            m_checkpointWrite.waitForFinished();
+            if (!checkpointPath().isEmpty()) {
+                QFile::remove(checkpointPath());
+            }
         } else {
             m_status = Status::Invalid;
         }
     } else {
-        m_status = Status::Paused;
+        // make sure the file is complete while paused
+        m_status = flushOutputFile() ? Status::Paused : Status::Invalid;
     }
 
     m_exp->trialFinished(this);
+    return false;
 }
 
-bool Trial::runSteps()
+bool Trial::runSteps(const int quantum)
 {
     const Experiment* exp = m_exp.get();
 
     QElapsedTimer t;
     t.start();
 
-    m_model->beforeLoop();
+    // a loop spans all the slices of a run, so the model's hooks
+    // are only called in the first and in the last slice
+    if (!m_inLoop) {
+        // the nodes might have been changed (e.g., in the GUI) while paused
+        m_graph->m_nodeColumns.reload(m_graph->m_nodes);
+        if (!m_graph->topology().isValid()) {
+            m_graph->freezeTopology();
+        }
+
+        m_model->beforeLoop();
+        m_model->initUpdates();
+        m_inLoop = true;
+        m_loopTime = 0;
+    }
 
     bool hasNext = true;
     while (m_step < exp->pauseAt() && hasNext) {
-        hasNext = m_model->algorithmStep();
+        hasNext = m_model->runStep();
+        if (m_graph->m_nodeColumns.isStale()) {
+            // nodes were added/removed in this step
+            m_graph->m_nodeColumns.reload(m_graph->m_nodes);
+        } else {
+            m_graph->m_nodeColumns.swapBuffers();
+        }
+        // the models read the CSR view, so it must be valid in every step
+        if (!m_graph->topology().isValid()) {
+            m_graph->freezeTopology();
+        }
         ++m_step;
 
+        // the outputs and the cycle detector read the node columns, so
+        // only the model's own state needs to be written to them
+        if (m_nodesSyncRequested.testAndSetRelaxed(1, 0)) {
+            m_model->syncNodes();
+            m_graph->syncNodeColumns();
+        } else if (!exp->m_outputs.empty() || m_cycleDetector) {
+            m_model->syncNodes();
+        }
+
+        if (m_cycleDetector && stateRepeated()) {
+            hasNext = false;
+        }
+
         for (const OutputPtr& output : exp->m_outputs) {
             output->doOperation(this);
         }
@@ -204,52 +375,147 @@ bool Trial::runSteps()
             return false;
         }
 
+        if (m_checkpointRequested.testAndSetRelaxed(1, 0) || (exp->checkpointSteps() > 0
+                && m_step % exp->checkpointSteps() == 0)) {
+            saveCheckpoint();
+        }
+
         if (exp->delay() > 0) {
             QThread::msleep(exp->delay());
         }
+
+        // give way to the other queued trials
+        if (quantum > 0 && hasNext && m_step < exp->pauseAt() && t.elapsed() >= quantum) {
+            m_loopTime += t.elapsed();
+            m_status = Status::Queued;
+            return true;
+        }
     }
 
     m_model->afterLoop();
+    m_model->syncNodes();
+    m_graph->syncNodeColumns();
+    m_inLoop = false;
 
     qDebug() << QString("[E%1:T%2] %3s").arg(exp->id())
-                .arg(m_id).arg(t.elapsed() / 1000);
+                .arg(m_id).arg((m_loopTime + t.elapsed()) / 1000);
 
     return hasNext;
 }
 
-bool Trial::writeCachedSteps(const Experiment* exp) const
+bool Trial::stateRepeated()
 {
-    if (exp->inputs()->fileCaches().empty() ||
-            exp->inputs()->fileCaches().front()->isEmpty(m_id)) {
-        return true;
+    const quint64 hash = m_stateHash.value(m_graph->nodes(), m_graph->nodeColumns());
+    const int period = m_cycleDetector->push(m_step, hash);
+    if (period == 0) {
+        return false;
     }
 
-    const QString fpath = exp->m_filePathPrefix + QString("%1.csv").arg(m_id);
-    QFile file(fpath);
-    if (!file.open(QFile::WriteOnly | QFile::Append)) {
-        qWarning() << "unable to create the trials. Could not write in " << fpath;
-        return false;
+    if (period == 1) {
+        m_stopReason = QString("reached a fixed point at step %1").arg(m_step);
+    } else {
+        m_stopReason = QString("reached a cycle of period %1 at step %2").arg(period).arg(m_step);
+    }
+    qInfo() << QString("[E%1:T%2] %3; finished.").arg(m_exp->id()).arg(m_id).arg(m_stopReason);
+    return true;
+}
+
+void Trial::saveCheckpoint()
+{
+    const QString path = checkpointPath();
+    if (path.isEmpty()) {
+        return;
+    }
+
+    // the checkpoint holds the nodes' attributes, so they must be
+    // up to date; also, the outputs cached so far must be in the file
+    m_model->syncNodes();
+    m_graph->syncNodeColumns();
+    if (!writeCachedSteps(m_exp.get()) || !flushOutputFile()) {
+        return;
     }
 
-    QTextStream stream(&file);
-    do {
-        QString row;
+    const QByteArray data = Checkpoint::save(this, QFileInfo(outputFilePath()).size());
+
+    // at most one write at a time; the serialization above is cheap
+    // compared to the I/O, which does not block the simulation
+    m_checkpointWrite.waitForFinished();
+    m_checkpointWrite = QtConcurrent::run([path, data]() { Checkpoint::write(path, data); });
+}
+
+bool Trial::initAborted() const
+{
+    return m_exp->expStatus() == Status::Invalid || m_exp->pauseAt() < 0;
+}
+
+QString Trial::checkpointPath() const
+{
+    if (m_exp->m_filePathPrefix.isEmpty()) {
+        return QString();
+    }
+    return m_exp->m_filePathPrefix + QString("%1.ckpt").arg(m_id);
+}
+
+QString Trial::outputFilePath() const
+{
+    const char* suffix = m_exp->binaryOutput() ? "bin" : "csv";
+    return m_exp->m_filePathPrefix + QString("%1.%2").arg(m_id).arg(suffix);
+}
+
+bool Trial::writeCachedSteps(const Experiment* exp, const bool finished)
+{
+    // the last steps are only written when the trial finishes
+    if (exp->inputs()->fileCaches().empty() || (exp->saveSteps() > 0 && !finished)) {
+        return true;
+    }
+
+    // the formatting and the I/O are done by the writer thread
+    // every file cache gets one row per step, and they are all written
+    // and read here, in the trial's thread. So, if the front cache is
+    // empty, then all others are also empty.
+    Cache* front = exp->inputs()->fileCaches().front();
+    std::vector<Values> rows;
+    std::vector<int> steps;
+    while (!front->isEmpty(m_id)) {
+        if (exp->binaryOutput() || exp->m_aggregator) {
+            steps.emplace_back(front->frontStep(m_id));
+        }
+        Values row;
         for (Cache* cache : exp->inputs()->fileCaches()) {
-            Values vals = cache->readFrontRow(m_id).second;
+            cache->readFrontRow(m_id, row);
             cache->flushFrontRow(m_id);
-            for (auto const& val : vals) {
-                row += val.toQString() + ",";
-            }
         }
-        row.chop(1);
-        stream << row << "\n";
+        rows.emplace_back(std::move(row));
+    }
 
-    // we synchronously flush all the io stuff. So, it's safe to say
-    // that if the front Output is empty, then all others are also empty.
-    } while (!exp->inputs()->fileCaches().front()->isEmpty(m_id));
+    if (exp->m_aggregator) {
+        exp->m_aggregator->add(steps, rows);
+        return true;
+    }
 
-    file.close();
-    return true;
+    if (!m_outputFile) {
+        m_outputFile = outputWriter()->open(outputFilePath(), exp->binaryOutput()
+                                            ? OutputWriter::Binary : OutputWriter::Csv);
+    }
+    outputWriter()->write(m_outputFile, std::move(rows), std::move(steps));
+
+    // the errors are reported by the next call
+    return !m_outputFile->hasError();
+}
+
+bool Trial::flushOutputFile()
+{
+    return !m_outputFile || outputWriter()->flush(m_outputFile);
+}
+
+bool Trial::closeOutputFile()
+{
+    if (!m_outputFile) {
+        return true;
+    }
+    const bool ok = outputWriter()->close(m_outputFile);
+    m_outputFile.reset();
+    return ok;
 }
 
 } // evoplex
@@ -17,11 +17,17 @@
 #ifndef TRIAL_H
 #define TRIAL_H
 
+#include <memory>
 #include <unordered_map>
+#include <QAtomicInt>
+#include <QFuture>
 #include <QRunnable>
+#include <QThreadPool>
 
 #include "enum.h"
 #include "experiment.h"
+#include "outputwriter.h"
+#include "statehash.h"
 
 namespace evoplex {
 
@@ -37,7 +43,12 @@ namespace evoplex {
  */
 class Trial : public QRunnable
 {
+    friend class Checkpoint;
     friend class ExperimentsMgr;
+    friend class TestCheckpoint;
+    friend class TestParallelFor;
+    friend class TestUpdateModes;
+    friend class TrialScheduler;
 
 public:
     explicit Trial(const quint16 id, ExperimentPtr exp);
@@ -48,6 +59,12 @@ public:
     // number of steps or the pause criteria defined by the user.
     void run() override;
 
+    // Same as run(), but it yields after 'quantum' msecs (if greater than 0),
+    // keeping its state intact for the next slice.
+    // Returns true if it yielded, i.e., it must be run again; in that case,
+    // the experiment is not notified that the trial has finished.
+    bool runSlice(const int quantum);
+
     const QString& graphId() const;
     GraphType graphType() const;
 
@@ -55,11 +72,29 @@ public:
     inline Status status() const;
     inline int step() const;
     inline int stopAt() const;
+    // why the trial finished before stopAt() (e.g., it has reached
+    // a fixed point); it is empty otherwise
+    inline const QString& stopReason() const;
 
     inline PRG* prg() const;
+    // the pool used to run the trials; it is also borrowed by the
+    // models to run parallel loops within a trial
+    QThreadPool* threadPool() const;
     inline const AbstractModel* model() const;
     inline AbstractGraph* graph() const;
 
+    // asks the running trial to write the node columns back to the
+    // nodes after the current step (e.g., to refresh the GUI)
+    inline void requestNodesSync() const;
+
+    // asks the running trial to save a checkpoint after the current step
+    inline void requestCheckpoint() const;
+
+    // Saves a checkpoint of the current step next to the output file.
+    // The file is written in the background, so it must be called
+    // between two steps, i.e., when the trial is not running a step.
+    void saveCheckpoint();
+
 private:
     const quint16 m_id;
     ExperimentPtr m_exp;
@@ -69,18 +104,55 @@ private:
     PRG* m_prg;
     AbstractGraph* m_graph;
     AbstractModel* m_model;
+    bool m_inLoop; // is it between beforeLoop() and afterLoop()?
+    qint64 m_memoryKB; // accounted in the memory budget (-1 if not)
+    bool m_memoryProbe; // is it measuring the footprint of the experiment's trials?
+    qint64 m_loopTime; // msecs spent in the current loop
+    mutable QAtomicInt m_nodesSyncRequested;
+    mutable QAtomicInt m_checkpointRequested;
+    QFuture<void> m_checkpointWrite;
+    OutputWriter::FilePtr m_outputFile; // opened on the first write
+
+    // used to stop the trial early when the nodes' state repeats
+    // (only if the experiment sets a cycle period)
+    StateHash m_stateHash;
+    std::unique_ptr<CycleDetector> m_cycleDetector;
+    QString m_stopReason;
 
     // We can safely consider that all parameters are valid at this point.
     // However, some things might fail (eg, missing nodes, broken graph etc),
     // and, in that case, false is returned.
     bool init();
+    // sets up the outputs and the edges of a trial starting from step 0
+    bool initFresh();
+    // returns true if the experiment has been invalidated or paused
+    // while this trial was being initialized
+    bool initAborted() const;
 
     // The main loop for calling the model steps
     // Returns true if it has a next step
-    bool runSteps();
-
-    // If any file output is set, it'll write the cached steps to file.
-    bool writeCachedSteps(const Experiment* exp) const;
+    // If 'quantum' is greater than 0, it yields (i.e., leaves the loop
+    // open and sets the status to Queued) once 'quantum' msecs have elapsed
+    bool runSteps(const int quantum);
+
+    // If any file output is set, it'll hand the cached steps over to the
+    // OutputWriter, which writes them to file in the background.
+    // If only the last steps are saved, they're written once 'finished'.
+    // Returns false if a previous write has failed.
+    bool writeCachedSteps(const Experiment* exp, const bool finished=false);
+    // blocks until the steps handed over have been written to file
+    bool flushOutputFile();
+    // flushes and closes the output file
+    bool closeOutputFile();
+    OutputWriter* outputWriter() const;
+
+    // Records the current state in the cycle detector.
+    // Returns true if the state has been seen in the last steps.
+    bool stateRepeated();
+
+    // the trial's checkpoint file; it is empty if there are no file outputs
+    QString checkpointPath() const;
+    QString outputFilePath() const;
 };
 
 /************************************************************************
@@ -96,6 +168,9 @@ inline int Trial::step() const
 inline int Trial::stopAt() const
 { return m_exp->stopAt(); }
 
+inline const QString& Trial::stopReason() const
+{ return m_stopReason; }
+
 inline Status Trial::status() const
 { return m_status; }
 
@@ -108,5 +183,11 @@ inline const AbstractModel* Trial::model() const
 inline AbstractGraph* Trial::graph() const
 { return m_graph; }
 
+inline void Trial::requestNodesSync() const
+{ m_nodesSyncRequested.fetchAndStoreRelaxed(1); }
+
+inline void Trial::requestCheckpoint() const
+{ m_checkpointRequested.fetchAndStoreRelaxed(1); }
+
 } // evoplex
 #endif // TRIAL_H
@@ -0,0 +1,135 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QFile>
+#include <QTextStream>
+
+#include "trialsaggregator.h"
+
+namespace evoplex {
+
+void TrialsAggregator::Stats::add(const double x)
+{
+    ++count;
+    if (count == 1) {
+        min = max = x;
+    } else {
+        min = qMin(min, x);
+        max = qMax(max, x);
+    }
+    const double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+}
+
+TrialsAggregator::TrialsAggregator(const QString& filePath, const QStringList& columns)
+    : m_filePath(filePath),
+      m_columns(columns)
+{
+}
+
+void TrialsAggregator::add(const std::vector<int>& steps, const std::vector<Values>& rows)
+{
+    Q_ASSERT_X(steps.size() == rows.size(), "TrialsAggregator", "each row must have a step");
+    const size_t numCols = static_cast<size_t>(m_columns.size());
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_steps.begin();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        // the steps of a trial are in ascending order, so the
+        // next one is usually right after the previous one
+        if (it == m_steps.end() || it->first != steps[i]) {
+            it = m_steps.lower_bound(steps[i]);
+            if (it == m_steps.end() || it->first != steps[i]) {
+                it = m_steps.emplace_hint(it, steps[i], Step{0, std::vector<Stats>(numCols)});
+            }
+        }
+
+        Step& step = it->second;
+        ++step.numTrials;
+        const Values& row = rows[i];
+        for (size_t col = 0; col < numCols && col < row.size(); ++col) {
+            const Value& v = row[col];
+            if (v.isInt()) {
+                step.columns[col].add(v.toInt());
+            } else if (v.isDouble()) {
+                step.columns[col].add(v.toDouble());
+            } else if (v.isBool()) {
+                step.columns[col].add(v.toBool());
+            }
+        }
+        ++it;
+    }
+}
+
+void TrialsAggregator::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_steps.clear();
+}
+
+int TrialsAggregator::numTrials(const int step) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_steps.find(step);
+    return it == m_steps.end() ? 0 : it->second.numTrials;
+}
+
+TrialsAggregator::Stats TrialsAggregator::stats(const int step, const int col) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_steps.find(step);
+    return it == m_steps.end() ? Stats() : it->second.columns.at(static_cast<size_t>(col));
+}
+
+bool TrialsAggregator::save(QString& error) const
+{
+    QFile file(m_filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        error = "unable to write the averages across the trials.\n" + m_filePath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "step,trials";
+    for (const QString& col : m_columns) {
+        out << "," << col << "_mean," << col << "_var," << col << "_min," << col << "_max";
+    }
+    out << "\n";
+
+    QMutexLocker locker(&m_mutex);
+    for (auto const& it : m_steps) {
+        out << it.first << "," << it.second.numTrials;
+        for (const Stats& s : it.second.columns) {
+            if (s.count == 0) {
+                out << ",,,,";
+            } else {
+                out << "," << Value(s.mean).toQString() << "," << Value(s.variance()).toQString()
+                    << "," << Value(s.min).toQString() << "," << Value(s.max).toQString();
+            }
+        }
+        out << "\n";
+    }
+    out.flush();
+
+    if (out.status() != QTextStream::Ok) {
+        error = "unable to write the averages across the trials.\n" + m_filePath;
+        return false;
+    }
+    return true;
+}
+
+} // evoplex
@@ -0,0 +1,85 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRIALS_AGGREGATOR_H
+#define TRIALS_AGGREGATOR_H
+
+#include <map>
+#include <vector>
+
+#include <QMutex>
+#include <QStringList>
+
+#include "value.h"
+
+namespace evoplex {
+
+/**
+ * @brief Merges the outputs of all trials of an experiment, step by step.
+ *
+ * The rows are reduced as soon as the trials produce them, so it only
+ * holds the running mean, variance (Welford's algorithm), min and max of
+ * each column at each step, regardless of the number of trials.
+ */
+class TrialsAggregator
+{
+public:
+    struct Stats {
+        quint32 count = 0;
+        double mean = 0.;
+        double m2 = 0.; // sum of the squared differences from the mean
+        double min = 0.;
+        double max = 0.;
+
+        void add(const double x);
+        // the sample variance
+        inline double variance() const { return count > 1 ? m2 / (count - 1) : 0.; }
+    };
+
+    explicit TrialsAggregator(const QString& filePath, const QStringList& columns);
+
+    inline const QString& filePath() const { return m_filePath; }
+    inline const QStringList& columns() const { return m_columns; }
+
+    // merges the rows of a trial; thread-safe
+    // the non-numeric values are ignored
+    void add(const std::vector<int>& steps, const std::vector<Values>& rows);
+    void clear();
+
+    // Returns the number of trials which have reached the given step
+    int numTrials(const int step) const;
+    // Returns the stats of a column at the given step
+    Stats stats(const int step, const int col) const;
+
+    // writes one row per step: the step, the number of trials and,
+    // for each column, its mean, variance, min and max
+    // Returns false if something went wrong
+    bool save(QString& error) const;
+
+private:
+    struct Step {
+        int numTrials;
+        std::vector<Stats> columns;
+    };
+
+    const QString m_filePath;
+    const QStringList m_columns;
+    mutable QMutex m_mutex;
+    std::map<int, Step> m_steps;
+};
+
+} // evoplex
+#endif // TRIALS_AGGREGATOR_H
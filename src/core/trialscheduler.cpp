@@ -0,0 +1,417 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <algorithm>
+
+#include <QRunnable>
+#include <QtDebug>
+
+#include "trialscheduler.h"
+#include "abstractgraph.h"
+#include "trial.h"
+
+namespace evoplex {
+
+class TrialScheduler::Worker : public QRunnable
+{
+public:
+    explicit Worker(TrialScheduler* s, int slot) : m_s(s), m_slot(slot) { setAutoDelete(true); }
+    void run() override { m_s->work(m_slot); }
+private:
+    TrialScheduler* m_s;
+    const int m_slot;
+};
+
+TrialScheduler::TrialScheduler(QThreadPool* pool, int maxWorkers,
+                               RunFunc runTrial, AdmitFunc admitTrial)
+    : m_pool(pool),
+      m_runTrial(runTrial),
+      m_admitTrial(admitTrial),
+      m_numWorkers(maxWorkers),
+      m_activeWorkers(0),
+      m_pending(0),
+      m_stopped(0),
+      m_policy(Policy::FIFO),
+      m_injected(0)
+{
+    Q_ASSERT_X(pool && maxWorkers > 0, "TrialScheduler", "invalid pool");
+    m_queues.reserve(maxWorkers);
+    for (int i = 0; i < maxWorkers; ++i) {
+        m_queues.emplace_back(new WorkQueue());
+    }
+}
+
+TrialScheduler::~TrialScheduler()
+{
+    shutdown();
+}
+
+QString TrialScheduler::policyToString(Policy policy)
+{
+    switch (policy) {
+    case Policy::FIFO: return "fifo";
+    case Policy::RoundRobin: return "roundrobin";
+    case Policy::ShortestJobFirst: return "sjf";
+    }
+    return QString();
+}
+
+TrialScheduler::Policy TrialScheduler::policyFromString(const QString& str, bool& ok)
+{
+    ok = true;
+    if (str == "fifo") return Policy::FIFO;
+    if (str == "roundrobin") return Policy::RoundRobin;
+    if (str == "sjf") return Policy::ShortestJobFirst;
+    ok = false;
+    return Policy::FIFO;
+}
+
+void TrialScheduler::setPolicy(Policy policy)
+{
+    QMutexLocker locker(&m_injectorMutex);
+    if (policy == m_policy) {
+        return;
+    }
+
+    // re-insert the queued trials in the new order
+    std::vector<Trial*> queued;
+    queued.reserve(m_injected);
+    while (Trial* trial = popInjected()) {
+        queued.emplace_back(trial);
+    }
+    m_policy = policy;
+    for (Trial* trial : queued) {
+        inject(trial);
+    }
+}
+
+void TrialScheduler::setNumWorkers(int n)
+{
+    n = qBound(1, n, static_cast<int>(m_queues.size()));
+    m_numWorkers.fetchAndStoreOrdered(n);
+    spawnWorkers();
+}
+
+void TrialScheduler::submit(const std::vector<Trial*>& trials)
+{
+    if (trials.empty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_injectorMutex);
+    for (Trial* trial : trials) {
+        inject(trial);
+    }
+    m_pending.fetchAndAddOrdered(static_cast<int>(trials.size()));
+    locker.unlock();
+
+    spawnWorkers();
+}
+
+int TrialScheduler::remove(const Experiment* exp)
+{
+    int removed = 0; // the trials counted in m_pending
+    auto ofExp = [exp](const Trial* t) { return t->m_exp.get() == exp; };
+
+    QMutexLocker locker(&m_injectorMutex);
+    const int before = m_injected;
+    auto fifoEnd = std::remove_if(m_fifo.begin(), m_fifo.end(), ofExp);
+    m_fifo.erase(fifoEnd, m_fifo.end());
+    for (auto it = m_byCost.begin(); it != m_byCost.end();) {
+        it = ofExp(it->second) ? m_byCost.erase(it) : std::next(it);
+    }
+    auto round = m_roundOf.find(exp);
+    if (round != m_roundOf.end()) {
+        m_rounds.erase(round->second);
+        m_roundOf.erase(round);
+    }
+    m_injected = static_cast<int>(m_fifo.size() + m_byCost.size());
+    for (auto const& r : m_rounds) {
+        m_injected += static_cast<int>(r.size());
+    }
+    removed += before - m_injected;
+
+    auto deferredEnd = std::remove_if(m_deferred.begin(), m_deferred.end(), ofExp);
+    const int deferred = static_cast<int>(m_deferred.end() - deferredEnd);
+    m_deferred.erase(deferredEnd, m_deferred.end());
+    locker.unlock();
+
+    for (auto& queue : m_queues) {
+        QMutexLocker ql(&queue->mutex);
+        const size_t size = queue->trials.size();
+        auto end = std::remove_if(queue->trials.begin(), queue->trials.end(), ofExp);
+        queue->trials.erase(end, queue->trials.end());
+        removed += static_cast<int>(size - queue->trials.size());
+    }
+
+    m_pending.fetchAndSubOrdered(removed);
+    return removed + deferred;
+}
+
+void TrialScheduler::wakeUp()
+{
+    spawnWorkers(true);
+}
+
+void TrialScheduler::shutdown()
+{
+    m_stopped.fetchAndStoreOrdered(1);
+
+    QMutexLocker locker(&m_injectorMutex);
+    m_fifo.clear();
+    m_byCost.clear();
+    m_rounds.clear();
+    m_roundOf.clear();
+    m_deferred.clear();
+    m_injected = 0;
+    locker.unlock();
+
+    for (auto& queue : m_queues) {
+        QMutexLocker ql(&queue->mutex);
+        queue->trials.clear();
+    }
+    m_pending.fetchAndStoreOrdered(0);
+}
+
+void TrialScheduler::spawnWorkers(bool withDeferred)
+{
+    int waiting = 0;
+    if (withDeferred) {
+        QMutexLocker locker(&m_injectorMutex);
+        waiting = static_cast<int>(m_deferred.size());
+    }
+
+    while (!m_stopped.loadAcquire()) {
+        const int active = m_activeWorkers.loadAcquire();
+        if (active >= m_numWorkers.loadAcquire()
+                || active >= m_pending.loadAcquire() + waiting) {
+            return;
+        }
+        if (!m_activeWorkers.testAndSetOrdered(active, active + 1)) {
+            continue;
+        }
+
+        // there is always a free slot, as each active worker holds one
+        int slot = 0;
+        while (!m_queues[slot]->claimed.testAndSetOrdered(0, 1)) {
+            slot = (slot + 1) % static_cast<int>(m_queues.size());
+        }
+        m_pool->start(new Worker(this, slot));
+    }
+}
+
+void TrialScheduler::work(int slot)
+{
+    // the workers beyond numWorkers() quit after the current trial
+    while (!m_stopped.loadAcquire() && slot < m_numWorkers.loadAcquire()) {
+        Trial* trial = next(slot);
+        if (!trial) {
+            break;
+        }
+        if (m_runTrial(trial)) {
+            QMutexLocker locker(&m_injectorMutex);
+            inject(trial);
+            m_pending.fetchAndAddOrdered(1);
+        }
+    }
+
+    m_queues[slot]->claimed.storeRelease(0);
+    m_activeWorkers.fetchAndSubOrdered(1);
+
+    // a trial might have been submitted after we looked for it, but
+    // before we left; in that case, the submitter didn't start a worker
+    if (m_pending.loadAcquire() > 0) {
+        spawnWorkers();
+    }
+}
+
+Trial* TrialScheduler::next(int slot)
+{
+    // the deferred trials go first, if they can start now
+    if (Trial* trial = takeDeferred()) {
+        return trial;
+    }
+
+    WorkQueue& own = *m_queues[slot];
+    for (;;) {
+        Trial* trial = nullptr;
+        QMutexLocker locker(&own.mutex);
+        if (!own.trials.empty()) {
+            trial = own.trials.front();
+            own.trials.pop_front();
+        }
+        locker.unlock();
+
+        if (!trial) {
+            trial = takeFromInjector(own);
+        }
+        if (!trial) {
+            trial = steal(slot);
+        }
+        if (!trial) {
+            return nullptr;
+        }
+
+        m_pending.fetchAndSubOrdered(1);
+        if (admitOrDefer(trial)) {
+            return trial;
+        }
+    }
+}
+
+Trial* TrialScheduler::takeDeferred()
+{
+    if (!m_admitTrial) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_injectorMutex);
+    for (auto it = m_deferred.begin(); it != m_deferred.end(); ++it) {
+        if (m_admitTrial(*it)) {
+            Trial* trial = *it;
+            m_deferred.erase(it);
+            return trial;
+        }
+    }
+    return nullptr;
+}
+
+bool TrialScheduler::admitOrDefer(Trial* trial)
+{
+    if (!m_admitTrial) {
+        return true;
+    }
+
+    // the decision and the deferral are atomic, so that a worker which
+    // finishes a trial in the meantime will see this trial as deferred
+    QMutexLocker locker(&m_injectorMutex);
+    if (m_admitTrial(trial)) {
+        return true;
+    }
+    m_deferred.emplace_back(trial);
+    return false;
+}
+
+Trial* TrialScheduler::takeFromInjector(WorkQueue& queue)
+{
+    QMutexLocker locker(&m_injectorMutex);
+    // take a fair share of the queued trials (up to 8), so that the
+    // workers don't need to come back to the injection queue every time
+    const int batch = qBound(1, m_injected / qMax(1, numWorkers()), 8);
+    Trial* first = popInjected();
+    if (!first || batch == 1) {
+        return first;
+    }
+
+    QMutexLocker ql(&queue.mutex);
+    for (int i = 1; i < batch; ++i) {
+        Trial* trial = popInjected();
+        if (!trial) {
+            break;
+        }
+        queue.trials.emplace_back(trial);
+    }
+    return first;
+}
+
+Trial* TrialScheduler::steal(int thief)
+{
+    const int n = static_cast<int>(m_queues.size());
+    for (int i = 1; i < n; ++i) {
+        WorkQueue& victim = *m_queues[(thief + i) % n];
+        QMutexLocker locker(&victim.mutex);
+        if (!victim.trials.empty()) {
+            // the back of the deque holds the least urgent trials
+            Trial* trial = victim.trials.back();
+            victim.trials.pop_back();
+            return trial;
+        }
+    }
+    return nullptr;
+}
+
+void TrialScheduler::inject(Trial* trial)
+{
+    ++m_injected;
+    switch (m_policy) {
+    case Policy::FIFO:
+        m_fifo.emplace_back(trial);
+        break;
+    case Policy::RoundRobin: {
+        const Experiment* exp = trial->m_exp.get();
+        auto it = m_roundOf.find(exp);
+        if (it == m_roundOf.end()) {
+            m_rounds.emplace_back();
+            it = m_roundOf.insert({exp, std::prev(m_rounds.end())}).first;
+        }
+        it->second->emplace_back(trial);
+        break;
+    }
+    case Policy::ShortestJobFirst:
+        m_byCost.insert({estimatedCost(trial), trial});
+        break;
+    }
+}
+
+Trial* TrialScheduler::popInjected()
+{
+    if (m_injected == 0) {
+        return nullptr;
+    }
+
+    Trial* trial = nullptr;
+    switch (m_policy) {
+    case Policy::FIFO:
+        trial = m_fifo.front();
+        m_fifo.pop_front();
+        break;
+    case Policy::RoundRobin: {
+        // take the first trial of the first experiment and move the
+        // experiment to the end of the round
+        auto round = m_rounds.begin();
+        trial = round->front();
+        round->pop_front();
+        if (round->empty()) {
+            m_roundOf.erase(trial->m_exp.get());
+            m_rounds.erase(round);
+        } else {
+            m_rounds.splice(m_rounds.end(), m_rounds, round);
+        }
+        break;
+    }
+    case Policy::ShortestJobFirst:
+        trial = m_byCost.begin()->second;
+        m_byCost.erase(m_byCost.begin());
+        break;
+    }
+    --m_injected;
+    return trial;
+}
+
+qint64 TrialScheduler::estimatedCost(const Trial* trial)
+{
+    // the graph is only known after the first run of the trial; before
+    // that, the trials are ordered by the number of steps only
+    qint64 size = 1;
+    if (trial->graph()) {
+        size = qMax<qint64>(1, static_cast<qint64>(trial->graph()->nodes().size()
+                                                    + trial->graph()->edges().size()));
+    }
+    return qMax(0, trial->stopAt() - trial->step()) * size;
+}
+
+} // evoplex
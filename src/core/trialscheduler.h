@@ -0,0 +1,178 @@
+/* Evoplex <https://evoplex.org>
+ * Copyright (C) 2016-present - Marcos Cardinot <marcos@cardinot.net>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TRIALSCHEDULER_H
+#define TRIALSCHEDULER_H
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+
+namespace evoplex {
+
+class Experiment;
+class Trial;
+
+/**
+ * @brief Hands out the queued trials to the worker threads.
+ *
+ * Each worker owns a deque of trials. A worker runs the trials of its
+ * own deque first; when it is empty, it takes a batch of trials from the
+ * injection queue (i.e., the trials submitted by play()), and, if there
+ * is nothing left there, it steals a trial from the back of the deque of
+ * another worker. Each deque has its own lock, so the workers only
+ * contend when they run out of work.
+ *
+ * The injection queue is ordered by the scheduling policy. The trials
+ * which yield (i.e., time slicing) go back to the injection queue, so
+ * that the policy decides whether they run again straight away.
+ *
+ * Before running a trial, the workers ask the admission function whether
+ * it can start now (e.g., if there is enough memory). If it cannot, the
+ * trial is deferred and the next one is tried instead; the deferred
+ * trials are tried again before any other trial, each time a worker
+ * looks for work or after wakeUp().
+ *
+ * The workers are QRunnables started in @p pool only when there are
+ * trials to run, and they quit as soon as there is nothing left. Thus,
+ * the idle threads of the pool remain available (e.g., to ParallelFor).
+ */
+class TrialScheduler
+{
+public:
+    enum class Policy {
+        FIFO,            // in the same order they have been submitted
+        RoundRobin,      // one trial of each experiment in turn
+        ShortestJobFirst // the trials with the least estimated work first
+    };
+
+    // runs a trial (or a slice of it); returns true to requeue the trial
+    using RunFunc = std::function<bool(Trial*)>;
+    // returns true if the trial can start now; it's called with the
+    // scheduler locked, so it must not call the scheduler back
+    using AdmitFunc = std::function<bool(Trial*)>;
+
+    explicit TrialScheduler(QThreadPool* pool, int maxWorkers,
+                            RunFunc runTrial, AdmitFunc admitTrial=nullptr);
+    ~TrialScheduler();
+
+    static QString policyToString(Policy policy);
+    static Policy policyFromString(const QString& str, bool& ok);
+
+    // the trials already queued are re-ordered by the new policy
+    // this IS thread-safe
+    void setPolicy(Policy policy);
+    inline Policy policy() const;
+
+    // set the max number of workers running at the same time
+    // the workers are created on demand (up to maxWorkers)
+    // if it shrinks, the extra workers quit once their current trial
+    // finishes or yields
+    // this IS thread-safe
+    void setNumWorkers(int n);
+    inline int numWorkers() const;
+
+    // queues the trials according to the scheduling policy
+    // this IS thread-safe
+    void submit(const std::vector<Trial*>& trials);
+
+    // removes the queued trials of an experiment
+    // Returns the number of trials removed
+    // this IS thread-safe
+    int remove(const Experiment* exp);
+
+    // starts the workers needed to try the deferred trials again
+    // (e.g., some memory has been released)
+    // this IS thread-safe
+    void wakeUp();
+
+    // drops all queued trials and stops handing out new ones
+    void shutdown();
+
+private:
+    class Worker;
+
+    struct WorkQueue {
+        QMutex mutex;
+        std::deque<Trial*> trials;
+        QAtomicInt claimed; // is it owned by a running worker?
+    };
+
+    QThreadPool* m_pool;
+    const RunFunc m_runTrial;
+    const AdmitFunc m_admitTrial;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues; // one per worker
+    QAtomicInt m_numWorkers;
+    QAtomicInt m_activeWorkers;
+    QAtomicInt m_pending; // trials in the injection queue and in the deques
+    QAtomicInt m_stopped;
+
+    // the injection queue; only one of these containers is used,
+    // according to the current policy
+    QMutex m_injectorMutex;
+    Policy m_policy;
+    int m_injected;
+    std::deque<Trial*> m_fifo;
+    std::multimap<qint64, Trial*> m_byCost; // keeps the order of equal keys
+    std::list<std::deque<Trial*>> m_rounds; // a deque per experiment
+    std::unordered_map<const Experiment*, std::list<std::deque<Trial*>>::iterator> m_roundOf;
+    std::deque<Trial*> m_deferred; // trials not admitted yet (oldest first)
+
+    // starts new workers while there are trials waiting for a worker
+    void spawnWorkers(bool withDeferred=false);
+    // the worker loop: runs trials until there is nothing left
+    void work(int slot);
+    // Returns the next trial for the worker at 'slot' or nullptr
+    Trial* next(int slot);
+    // moves a batch of trials from the injection queue to 'queue'
+    // Returns the first trial of the batch or nullptr
+    Trial* takeFromInjector(WorkQueue& queue);
+    // Returns the trial removed from the back of another worker's deque
+    Trial* steal(int thief);
+    // Returns the oldest deferred trial which can start now or nullptr
+    Trial* takeDeferred();
+    // Returns true if the trial can start now; otherwise, defers it
+    bool admitOrDefer(Trial* trial);
+
+    void inject(Trial* trial);
+    Trial* popInjected();
+
+    // remaining steps times the size of the graph (if it's known)
+    static qint64 estimatedCost(const Trial* trial);
+};
+
+/************************************************************************
+   TrialScheduler: Inline member functions
+ ************************************************************************/
+
+inline TrialScheduler::Policy TrialScheduler::policy() const
+{ return m_policy; }
+
+inline int TrialScheduler::numWorkers() const
+{ return m_numWorkers.loadAcquire(); }
+
+} // evoplex
+#endif // TRIALSCHEDULER_H
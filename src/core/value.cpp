@@ -15,6 +15,7 @@
  */
 
 #include <stdexcept>
+#include <QDataStream>
 #include <QString>
 #include "value.h"
 
@@ -221,4 +222,34 @@ std::logic_error Value::throwError() const
     }
 }
 
+QDataStream& operator<<(QDataStream& out, const Value& v)
+{
+    out << static_cast<quint8>(v.type());
+    switch (v.type()) {
+    case Value::INT: out << static_cast<qint32>(v.toInt()); break;
+    case Value::DOUBLE: out << v.toDouble(); break;
+    case Value::BOOL: out << v.toBool(); break;
+    case Value::CHAR: out << static_cast<qint8>(v.toChar()); break;
+    case Value::STRING: out << QByteArray(v.toString()); break;
+    default: break;
+    }
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, Value& v)
+{
+    quint8 type;
+    in >> type;
+    switch (type) {
+    case Value::INT: { qint32 i; in >> i; v = Value(static_cast<int>(i)); break; }
+    case Value::DOUBLE: { double d; in >> d; v = Value(d); break; }
+    case Value::BOOL: { bool b; in >> b; v = Value(b); break; }
+    case Value::CHAR: { qint8 c; in >> c; v = Value(static_cast<char>(c)); break; }
+    case Value::STRING: { QByteArray s; in >> s; v = Value(s.constData()); break; }
+    case Value::INVALID: v = Value(); break;
+    default: in.setStatus(QDataStream::ReadCorruptData); v = Value();
+    }
+    return in;
+}
+
 } // evoplex
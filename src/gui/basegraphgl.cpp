@@ -458,6 +458,8 @@ void BaseGraphGL::updateView(bool forceUpdate)
     }
     m_currStep = m_trial->step();
     m_ui->currStep->setText(QString::number(m_currStep));
+    // node attributes stored in columns are written back asynchronously
+    m_trial->requestNodesSync();
     update();
 }
 
@@ -125,6 +125,10 @@ ExperimentDesigner::ExperimentDesigner(MainApp* mainApp, QWidget *parent)
     addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_TRIALS);
     // --  auto delete
     addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_AUTODELETE);
+    // --  cycle period
+    addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_CYCLEPERIOD)->setValue(0);
+    // --  checkpoint
+    addGeneralAttr(m_treeItemGeneral, GENERAL_ATTR_CHECKPOINT)->setValue(0);
 
     // setup the tree widget: outputs
     m_treeItemOutputs = newTreeItem("File Outputs", false);
@@ -141,35 +145,23 @@ ExperimentDesigner::ExperimentDesigner(MainApp* mainApp, QWidget *parent)
     LineButton* outHeader = new LineButton(this, LineButton::None);
     connect(outHeader->button(), SIGNAL(pressed()), SLOT(slotOutputWidget()));
     addGeneralAttr(m_treeItemOutputs, OUTPUT_HEADER, outHeader);
-
-/* TODO: make the buttons to avgTrials and saveSteps work*/
-/*    // -- avgTrials
-    QtMaterialCheckBox* outAvgTrials = new QtMaterialCheckBox("average trials");
-    addGeneralAttr(m_treeItemOutputs, OUTPUT_AVGTRIALS, QVariant::fromValue(outAvgTrials));
+    // -- file format
+    AttrWidget* outFormat = addGeneralAttr(m_treeItemOutputs, OUTPUT_FORMAT);
+    // -- avgTrials
+    AttrWidget* outAvgTrials = addGeneralAttr(m_treeItemOutputs, OUTPUT_AVGTRIALS);
     // -- steps to save
-    QRadioButton* outAllSteps = new QRadioButton("all");
-    outAllSteps->setChecked(true);
-    QRadioButton* outLastSteps = new QRadioButton("last");
-    QSpinBox* outNumSteps = new QSpinBox();
-    outNumSteps->setButtonSymbols(QSpinBox::NoButtons);
-    outNumSteps->setMinimum(0);
-    outNumSteps->setMaximum(EVOPLEX_MAX_STEPS);
-    QHBoxLayout* outStepsLayout = new QHBoxLayout(new QWidget(m_ui->treeWidget));
-    outStepsLayout->setMargin(0);
-    outStepsLayout->insertWidget(0, outAllSteps);
-    outStepsLayout->insertWidget(1, outLastSteps);
-    outStepsLayout->insertWidget(2, outNumSteps);
-    outStepsLayout->insertSpacerItem(3, new QSpacerItem(5,5,QSizePolicy::MinimumExpanding));
-    QTreeWidgetItem* itemOut = new QTreeWidgetItem(m_treeItemOutputs);
-    itemOut->setText(0, OUTPUT_SAVESTEPS);
-    m_ui->treeWidget->setItemWidget(itemOut, 1, outStepsLayout->parentWidget());
-*/
+    AttrWidget* outSaveSteps = addGeneralAttr(m_treeItemOutputs, OUTPUT_SAVESTEPS);
+    outSaveSteps->setValue(0);
+    outSaveSteps->setToolTip("0 to save all steps; n>0 to save the last n steps");
+
     connect(m_enableOutputs, &AttrWidget::valueChanged,
-        [this, outDir, outHeader]() {
+        [this, outDir, outHeader, outFormat, outAvgTrials, outSaveSteps]() {
             bool b = m_enableOutputs->value().toBool();
             outDir->setEnabled(b);
             outHeader->setEnabled(b);
-//          outAvgTrials->setEnabled(b);
+            outFormat->setEnabled(b);
+            outAvgTrials->setEnabled(b);
+            outSaveSteps->setEnabled(b);
         });
     m_enableOutputs->setValue(true);
     m_enableOutputs->setValue(false);
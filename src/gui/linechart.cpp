@@ -209,14 +209,14 @@ void LineChart::updateSeries()
         int i = 0;
         bool lastWasDuplicated = false;
         do {
-            const Cache::Row& row = s.cache->readFrontRow(m_currTrialId);
-            Q_ASSERT_X(row.second.size() == 1, "LineChart", "it must have only one column");
-
-            x = row.first;
-            if (row.second.at(0).type() == Value::INT) {
-                y = row.second.at(0).toInt();
-            } else if (row.second.at(0).type() == Value::DOUBLE) {
-                y = row.second.at(0).toDouble();
+            Q_ASSERT_X(s.cache->numColumns() == 1, "LineChart", "it must have only one column");
+            const Value& value = s.cache->frontValue(m_currTrialId, 0);
+
+            x = s.cache->frontStep(m_currTrialId);
+            if (value.type() == Value::INT) {
+                y = value.toInt();
+            } else if (value.type() == Value::DOUBLE) {
+                y = value.toDouble();
             } else {
                 qFatal("the type is invalid!");
             }
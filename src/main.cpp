@@ -18,11 +18,15 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <set>
+
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDate>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QFontDatabase>
 #include <QScopedPointer>
 #include <QStringBuilder>
@@ -30,6 +34,9 @@
 #include <QStyleFactory>
 
 #include "config.h"
+#include "core/batchrunner.h"
+#include "core/binaryoutput.h"
+#include "core/experimentsmgr.h"
 #include "core/logger.h"
 #include "core/mainapp.h"
 #include "gui/maingui.h"
@@ -44,6 +51,159 @@ QCoreApplication* createApp(int& argc, char* argv[])
     return new QApplication(argc, argv);
 }
 
+// parses a list of experiment ids, e.g., "0,2,5-8"
+std::set<int> parseExpIds(const QString& str, bool& ok)
+{
+    std::set<int> ids;
+    ok = true;
+    for (const QString& item : str.split(",", QString::SkipEmptyParts)) {
+        const QStringList range = item.split("-");
+        bool okMin = false, okMax = false;
+        const int min = range.first().trimmed().toInt(&okMin);
+        const int max = range.last().trimmed().toInt(&okMax);
+        if (range.size() > 2 || !okMin || !okMax || min > max) {
+            ok = false;
+            return ids;
+        }
+        for (int id = min; id <= max; ++id) {
+            ids.insert(id);
+        }
+    }
+    return ids;
+}
+
+// converts a binary output file to csv (next to it); returns the exit code
+int convertOutput(const QString& filePath)
+{
+    QString error;
+    evoplex::BinaryOutputReader reader;
+    if (!reader.open(filePath, error)) {
+        qWarning() << error;
+        return evoplex::BatchRunner::InvalidArguments;
+    }
+
+    const QFileInfo fi(filePath);
+    const QString csvPath = fi.absolutePath() + "/" + fi.completeBaseName() + ".csv";
+    if (!reader.toCsv(csvPath, error)) {
+        qWarning() << error;
+        return evoplex::BatchRunner::InvalidArguments;
+    }
+    qInfo() << "converted" << reader.numRows() << "rows to" << csvPath;
+    return evoplex::BatchRunner::Success;
+}
+
+// runs the experiments without the GUI; returns the exit code
+int runBatch(QCoreApplication* app, evoplex::MainApp* mainApp)
+{
+    QCommandLineParser parser;
+    parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+    parser.setApplicationDescription("Runs the experiments of a project without the GUI.");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "no-gui", "Starts Evoplex in the headless mode." },
+        { "project", "The project file (csv).", "file" },
+        { "threads", "Max number of threads.", "n" },
+        { "policy", "Order of the queued trials: fifo, roundrobin or sjf.", "policy" },
+        { "memory", "Max memory (MB) the trials might use; queued trials wait while it's exceeded (0: no limit).", "MB" },
+        { "timeslice", "Max time a trial runs before giving way to the others, in msec (0: no limit).", "msec" },
+        { "output", "Overrides the output directory of all experiments.", "dir" },
+        { "experiments", "Only runs these experiments, e.g., 0,2,5-8.", "ids" },
+        { "interval", "Progress report interval in msec (default: 1000).", "msec", "1000" },
+        { "convert", "Converts a binary output file to csv and exits.", "file" }
+    });
+    parser.addPositionalArgument("project", "The project file (csv).", "[project]");
+    parser.process(*app);
+
+    if (parser.isSet("convert")) {
+        return convertOutput(parser.value("convert"));
+    }
+
+    QString projectFile = parser.value("project");
+    if (projectFile.isEmpty() && !parser.positionalArguments().isEmpty()) {
+        projectFile = parser.positionalArguments().first();
+    }
+    if (projectFile.isEmpty()) {
+        qWarning() << "missing project file. Usage: -no-gui -project <file.csv>";
+        return evoplex::BatchRunner::InvalidArguments;
+    }
+
+    bool ok = true;
+    std::set<int> expIds;
+    if (parser.isSet("experiments")) {
+        expIds = parseExpIds(parser.value("experiments"), ok);
+        if (!ok || expIds.empty()) {
+            qWarning() << "invalid list of experiments:" << parser.value("experiments");
+            return evoplex::BatchRunner::InvalidArguments;
+        }
+    }
+
+    if (parser.isSet("threads")) {
+        QString error;
+        const int threads = parser.value("threads").toInt(&ok);
+        if (ok) {
+            // headless runs must not change the user preferences
+            mainApp->expMgr()->setMaxThreadCount(threads, &error, false);
+        }
+        if (!ok || !error.isEmpty()) {
+            qWarning() << "invalid number of threads:" << parser.value("threads");
+            return evoplex::BatchRunner::InvalidArguments;
+        }
+    }
+
+    if (parser.isSet("policy")) {
+        QString error;
+        const auto policy = evoplex::TrialScheduler::policyFromString(parser.value("policy"), ok);
+        if (ok) {
+            mainApp->expMgr()->setSchedulingPolicy(policy, &error, false);
+        }
+        if (!ok || !error.isEmpty()) {
+            qWarning() << "invalid scheduling policy:" << parser.value("policy");
+            return evoplex::BatchRunner::InvalidArguments;
+        }
+    }
+
+    if (parser.isSet("memory")) {
+        QString error;
+        const int memory = parser.value("memory").toInt(&ok);
+        if (ok) {
+            mainApp->expMgr()->setMemoryBudget(memory, &error, false);
+        }
+        if (!ok || !error.isEmpty()) {
+            qWarning() << "invalid memory budget:" << parser.value("memory");
+            return evoplex::BatchRunner::InvalidArguments;
+        }
+    }
+
+    if (parser.isSet("timeslice")) {
+        QString error;
+        const int timeSlice = parser.value("timeslice").toInt(&ok);
+        if (ok) {
+            mainApp->expMgr()->setTimeSlice(timeSlice, &error, false);
+        }
+        if (!ok || !error.isEmpty()) {
+            qWarning() << "invalid time slice:" << parser.value("timeslice");
+            return evoplex::BatchRunner::InvalidArguments;
+        }
+    }
+
+    const int interval = parser.value("interval").toInt(&ok);
+    if (!ok || interval < 1) {
+        qWarning() << "invalid interval:" << parser.value("interval");
+        return evoplex::BatchRunner::InvalidArguments;
+    }
+
+    QString error;
+    evoplex::BatchRunner runner(mainApp);
+    if (!runner.load(projectFile, parser.value("output"), expIds, error)) {
+        return evoplex::BatchRunner::InvalidArguments;
+    }
+
+    QObject::connect(&runner, &evoplex::BatchRunner::finished,
+                     app, &QCoreApplication::exit, Qt::QueuedConnection);
+    runner.start(interval);
+    return app->exec();
+}
+
 int main(int argc, char* argv[])
 {
     if (!qstrcmp(argv[1], "-version")) {
@@ -137,7 +297,7 @@ int main(int argc, char* argv[])
         result = app->exec();
     } else {
         // start console application
-        // TODO: handle args
+        result = runBatch(coreApp.data(), &mainApp);
     }
 
     evoplex::Logger::instance()->destroy();
@@ -124,10 +124,13 @@ bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList
         return false;
     }
 
-    Attributes* attrs = new Attributes();
-    if (m_edgeAttrsGen) {
+    Attributes* attrs;
+    if (!m_edgeAttrsGen) {
+        attrs = new Attributes();
+    } else {
+        // all edges share the schema of the generator
+        attrs = new Attributes(m_edgeAttrsGen->schema());
         auto const& ascope = m_edgeAttrsGen->attrsScope();
-        attrs->resize(ascope.size());
         for (int col = 2; col < values.size(); ++col) {
             auto const& attrRange = ascope.value(header.at(col), nullptr);
             if (!attrRange) { // is null if the column is not required
@@ -136,7 +139,7 @@ bool EdgesFromCSV::readRow(int row, const QStringList& header, const QStringList
 
             Value value = attrRange->validate(values.at(col));
             if (value.isValid()) {
-                attrs->replace(attrRange->id(), header.at(col), value);
+                attrs->setValue(attrRange->id(), value);
             } else {
                 qWarning() << QString("invalid value at column %1 ('%2') row %3!\n"
                                       "Expected: %4; Actual: %5")
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ * Copyright (c) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ * This source code is licensed under the MIT license found in
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef PACKED_RULE_H
+#define PACKED_RULE_H
+
+#include <vector>
+#include <QtGlobal>
+
+namespace evoplex {
+
+/**
+ * @brief An elementary cellular automaton rule applied to bit-packed rows.
+ * A row is stored in 64-bit words (one bit per cell), so the next row is
+ * computed for 64 cells at once from the minterms of the rule. The row is
+ * either a ring (toroidal) or the cells beyond its ends are always off.
+ */
+class PackedRule
+{
+public:
+    //! Constructor.
+    PackedRule() : m_width(0), m_words(0), m_toroidal(false), m_lastMask(0) {}
+
+    // sets the Wolfram code [0,255] and the number of cells in a row
+    inline void reset(int rule, int width, bool toroidal);
+
+    // number of words per row
+    inline int words() const { return m_words; }
+
+    // computes the next row from the current one
+    inline void apply(const std::vector<quint64>& row, std::vector<quint64>& next) const;
+
+private:
+    int m_width;
+    int m_words;
+    bool m_toroidal;
+    quint64 m_lastMask;          // valid bits of the last word in a row
+    std::vector<int> m_minterms; // the neighbourhoods (lcr) mapped to 'on'
+};
+
+/************************************************************************
+   PackedRule: Inline member functions
+ ************************************************************************/
+
+inline void PackedRule::reset(int rule, int width, bool toroidal)
+{
+    // Wolfram code: the bit 'p' of the rule number is the next state of
+    // a cell whose neighbourhood (left,center,right) reads 'p' in binary
+    m_minterms.clear();
+    for (int p = 0; p < 8; ++p) {
+        if ((rule >> p) & 1) {
+            m_minterms.emplace_back(p);
+        }
+    }
+
+    m_width = width;
+    m_toroidal = toroidal;
+    m_words = (width + 63) / 64;
+    const int lastBit = (width - 1) % 64;
+    m_lastMask = lastBit == 63 ? ~quint64(0) : (quint64(1) << (lastBit + 1)) - 1;
+}
+
+inline void PackedRule::apply(const std::vector<quint64>& row, std::vector<quint64>& next) const
+{
+    const size_t last = static_cast<size_t>(m_words - 1);
+    const int lastBit = (m_width - 1) % 64;
+    for (size_t k = 0; k <= last; ++k) {
+        // the left and right neighbours of the 64 cells in this word
+        quint64 left = (row[k] << 1) | (k > 0 ? row[k-1] >> 63 : 0);
+        quint64 right = (row[k] >> 1) | (k < last ? row[k+1] << 63 : 0);
+        if (m_toroidal && k == 0) {
+            left |= (row[last] >> lastBit) & 1;
+        }
+        if (m_toroidal && k == last) {
+            right |= (row[0] & 1) << lastBit;
+        }
+
+        const quint64 center = row[k];
+        quint64 n = 0;
+        for (int p : m_minterms) {
+            n |= ((p & 4) ? left : ~left)
+               & ((p & 2) ? center : ~center)
+               & ((p & 1) ? right : ~right);
+        }
+        next[k] = n;
+    }
+    next[last] &= m_lastMask;
+}
+
+} // evoplex
+#endif // PACKED_RULE_H
@@ -35,36 +35,78 @@ bool CellularAutomata1D::init()
 
     // gets the id of the `state` node's attribute, which is the same for all nodes
     m_stateAttrId = node(0).attrs().indexOf("state");
+    if (m_stateAttrId < 0) {
+        return false;
+    }
+    m_state = nodeColumn<bool>(m_stateAttrId);
+    if (!m_state || m_state->size() != m_width * m_height) {
+        return false;
+    }
 
     // determines which rule to use
     m_rule = attr("rule").toInt();
+    if (m_rule < 0 || m_rule > 255) {
+        qWarning() << "the rule must be in the interval [0,255]";
+        return false;
+    }
+
+    m_packedRule.reset(m_rule, m_width, m_toroidal);
+    m_row.assign(static_cast<size_t>(m_packedRule.words()), 0);
+    m_next.assign(static_cast<size_t>(m_packedRule.words()), 0);
 
-    return m_stateAttrId >= 0;
+    // squareGrid uses row-major node ids
+    m_cellIdx.resize(static_cast<size_t>(m_width * m_height));
+    for (int id = 0; id < m_width * m_height; ++id) {
+        m_cellIdx[static_cast<size_t>(id)] = nodes().indexOf(node(id));
+    }
+
+    return true;
+}
+
+void CellularAutomata1D::beforeLoop()
+{
+    // the nodes might have been changed while paused (e.g., in the GUI),
+    // so the current row is always packed again from the `state` column
+    const bool* state = m_state->constData();
+    std::fill(m_row.begin(), m_row.end(), 0);
+    for (int col = 0; col < m_width; ++col) {
+        if (state[m_cellIdx[static_cast<size_t>(linearIdx(m_currRow, col))]]) {
+            m_row[static_cast<size_t>(col / 64)] |= quint64(1) << (col % 64);
+        }
+    }
 }
 
 bool CellularAutomata1D::algorithmStep()
 {
-    // 1. gets first node in the current row
-    Node first = node(linearIdx(m_currRow, 0));
-
-    // 2. for each node (starting from the second),
-    int lastColumn = m_width - 1;
-    for (int col = 1; col < lastColumn; ++col) {
-        Node central = node(first.id() + col);
-        // a. compute the next state based on its neighbours on the left and right
-        Value state = nextState(node(central.id()-1), central, node(central.id()+1));
-        // b. assign the next state to the node below the current node
-        node(central.id()+m_width).setAttr(m_stateAttrId, state);
+    // 1. compute the next state of all nodes in the current row
+    m_packedRule.apply(m_row, m_next);
+
+    // 2. edge case: if the graph is not a toroid, the nodes in the first
+    // and last columns have a missing neighbour, so they keep their states
+    bool* state = m_state->data();
+    const int nextRowIdx = linearIdx(m_currRow + 1, 0);
+    int firstCol = 0;
+    int lastCol = m_width - 1;
+    if (!m_toroidal) {
+        for (int col : {firstCol, lastCol}) {
+            const quint64 bit = quint64(1) << (col % 64);
+            quint64& word = m_next[static_cast<size_t>(col / 64)];
+            if (state[m_cellIdx[static_cast<size_t>(nextRowIdx + col)]]) {
+                word |= bit;
+            } else {
+                word &= ~bit;
+            }
+        }
+        ++firstCol;
+        --lastCol;
     }
 
-    // 3. edge case: if the graph is a toroid, we compute the state for the last column
-    if (m_toroidal) {
-        Node last = node(linearIdx(m_currRow, lastColumn));
-        // a. compute the next state based on its left neighbour and the first node in the row
-        Value state = nextState(node(last.id()-1), last, first);
-        // b. assign the next state to the first node of the next row
-        node(first.id()+m_width).setAttr(m_stateAttrId, state);
+    // 3. assign the next states to the nodes in the row below
+    for (int col = firstCol; col <= lastCol; ++col) {
+        state[m_cellIdx[static_cast<size_t>(nextRowIdx + col)]] =
+                (m_next[static_cast<size_t>(col / 64)] >> (col % 64)) & 1;
     }
+    m_row.swap(m_next);
 
     ++m_currRow;
     if (m_currRow == m_height-1) {
@@ -74,25 +116,22 @@ bool CellularAutomata1D::algorithmStep()
     return true;
 }
 
-Value CellularAutomata1D::nextState(const Node& leftNode, const Node& node, const Node& rightNode) const
+void CellularAutomata1D::saveState(QDataStream& out) const
 {
-    bool left = leftNode.attr(m_stateAttrId).toBool();
-    bool center = node.attr(m_stateAttrId).toBool();
-    bool right = rightNode.attr(m_stateAttrId).toBool();
-
-    bool r = false;
-    if (m_rule == 30) {
-        r = left ^ (center || right);
-    } else if (m_rule == 32) {
-        r = left && !center && right;
-    } else if (m_rule == 110) {
-        r = (!left && center) || (center ^ right);
-    } else if (m_rule == 250) {
-        r = left || right;
-    } else {
-        qFatal("invalid rule");
+    // the rows are stored in the nodes, but not which one is the current
+    out << static_cast<qint32>(m_currRow);
+}
+
+bool CellularAutomata1D::loadState(QDataStream& in)
+{
+    qint32 currRow;
+    in >> currRow;
+    if (currRow < 0 || currRow >= m_height) {
+        qWarning() << "invalid row in the checkpoint" << currRow;
+        return false;
     }
-    return Value(r);
+    m_currRow = currRow;
+    return true;
 }
 
 int CellularAutomata1D::linearIdx(int row, int col) const
@@ -9,28 +9,39 @@
 #ifndef CELLULARAUTOMATA1D_H
 #define CELLULARAUTOMATA1D_H
 
+#include <algorithm>
+#include <vector>
 #include <plugininterface.h>
 
+#include "packedrule.h"
+
 namespace evoplex {
 class CellularAutomata1D: public AbstractModel
 {
 public:
     bool init() override;
+    void beforeLoop() override;
     bool algorithmStep() override;
+    void saveState(QDataStream& out) const override;
+    bool loadState(QDataStream& in) override;
 
 private:
-    int m_currRow;
+    int m_currRow;      // the row being read; it is saved in the checkpoints
 
     int m_stateAttrId;  // the id of the `state` node attribute
     int m_rule;         // model attribute: cellular automaton rule
+    NodeColumn<bool>* m_state; // the `state` of all nodes
 
     bool m_toroidal;    // true if the graph is a toroid
     int m_width;        // the number of columns in the `squareGrid` graph
     int m_height;       // the number of rows in the `squareGrid` graph
 
-    // returns the next state of a node based on the state
-    // of itself and its neighbours on the left and right
-    Value nextState(const Node& leftNode, const Node& node, const Node& rightNode) const;
+    // The current row is stored as a bit-packed vector of 64-bit words
+    // (one bit per cell), so the next row is computed for 64 cells at once.
+    PackedRule m_packedRule;
+    std::vector<int> m_cellIdx;  // node position of each cell (row-major)
+    std::vector<quint64> m_row;
+    std::vector<quint64> m_next;
 
     // return the linear index of an element in a matrix.
     int linearIdx(int row, int col) const;
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ * Copyright (c) 2018 - Ethan Padden <e.padden1@nuigalway.ie>
+ *
+ * This source code is licensed under the MIT license found in
+ * the LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef PACKED_LATTICE_H
+#define PACKED_LATTICE_H
+
+#include <vector>
+#include <QtGlobal>
+
+namespace evoplex {
+
+/**
+ * @brief A bit-packed lattice for the Game of Life with eight neighbours.
+ * Each row of cells is stored in 64-bit words (one bit per cell), and a
+ * generation is computed with bitwise adders. The lattice is either a
+ * toroid (periodic) or the cells beyond its borders are always dead.
+ */
+class PackedLattice
+{
+public:
+    //! Constructor.
+    PackedLattice() : m_width(0), m_height(0), m_words(0), m_periodic(false) {}
+
+    // resets the lattice to 'width' x 'height' dead cells
+    inline void reset(int width, int height, bool periodic);
+
+    inline int width() const { return m_width; }
+    inline int height() const { return m_height; }
+
+    inline bool get(int row, int col) const;
+    inline void set(int row, int col, bool live);
+
+    // computes the next generation of all cells
+    inline void step();
+
+private:
+    int m_width;
+    int m_height;
+    int m_words; // number of words per row
+    bool m_periodic;
+    std::vector<quint64> m_cells;
+    std::vector<quint64> m_next;
+    std::vector<quint64> m_west; // m_west[c] is the cell at column c-1
+    std::vector<quint64> m_east; // m_east[c] is the cell at column c+1
+};
+
+/************************************************************************
+   PackedLattice: Inline member functions
+ ************************************************************************/
+
+inline bool PackedLattice::get(int row, int col) const
+{ return (m_cells[static_cast<size_t>(row * m_words + col / 64)] >> (col % 64)) & 1; }
+
+inline void PackedLattice::set(int row, int col, bool live)
+{
+    const quint64 bit = quint64(1) << (col % 64);
+    quint64& word = m_cells[static_cast<size_t>(row * m_words + col / 64)];
+    word = live ? word | bit : word & ~bit;
+}
+
+inline void PackedLattice::reset(int width, int height, bool periodic)
+{
+    m_width = width;
+    m_height = height;
+    m_periodic = periodic;
+    m_words = (width + 63) / 64;
+    const size_t numWords = static_cast<size_t>(m_words * height);
+    m_cells.assign(numWords, 0);
+    m_next.assign(numWords, 0);
+    m_west.assign(numWords, 0);
+    m_east.assign(numWords, 0);
+}
+
+inline void PackedLattice::step()
+{
+    const int lastBit = (m_width - 1) % 64;
+    const quint64 lastMask = lastBit == 63 ? ~quint64(0) : (quint64(1) << (lastBit + 1)) - 1;
+
+    // horizontal neighbours of all rows
+    for (int r = 0; r < m_height; ++r) {
+        const quint64* row = &m_cells[static_cast<size_t>(r * m_words)];
+        quint64* west = &m_west[static_cast<size_t>(r * m_words)];
+        quint64* east = &m_east[static_cast<size_t>(r * m_words)];
+        for (int k = 0; k < m_words; ++k) {
+            const quint64 prev = k > 0 ? row[k-1] >> 63 : 0;
+            const quint64 next = k + 1 < m_words ? row[k+1] << 63 : 0;
+            west[k] = (row[k] << 1) | prev;
+            east[k] = (row[k] >> 1) | next;
+        }
+        if (m_periodic) {
+            west[0] |= (row[m_words-1] >> lastBit) & 1;
+            east[m_words-1] |= (row[0] & 1) << lastBit;
+        }
+        west[m_words-1] &= lastMask;
+    }
+
+    // sums the eight neighbours with bit-sliced adders; the count modulo 8
+    // is enough as we are only interested in 2 and 3 (8 is aliased to 0)
+    const std::vector<quint64> zeros(static_cast<size_t>(m_words), 0);
+    for (int r = 0; r < m_height; ++r) {
+        int up = r - 1;
+        int down = r + 1;
+        if (m_periodic) {
+            up = up < 0 ? m_height - 1 : up;
+            down = down == m_height ? 0 : down;
+        }
+        auto rowPtr = [this, &zeros](const std::vector<quint64>& v, int row) {
+            return (row < 0 || row >= m_height) ? zeros.data()
+                                                : &v[static_cast<size_t>(row * m_words)];
+        };
+        const quint64* n = rowPtr(m_cells, up);
+        const quint64* nw = rowPtr(m_west, up);
+        const quint64* ne = rowPtr(m_east, up);
+        const quint64* s = rowPtr(m_cells, down);
+        const quint64* sw = rowPtr(m_west, down);
+        const quint64* se = rowPtr(m_east, down);
+        const quint64* w = rowPtr(m_west, r);
+        const quint64* e = rowPtr(m_east, r);
+        const quint64* cell = rowPtr(m_cells, r);
+        quint64* out = &m_next[static_cast<size_t>(r * m_words)];
+
+        for (int k = 0; k < m_words; ++k) {
+            // full adders
+            quint64 t = nw[k] ^ n[k];
+            const quint64 s1 = t ^ ne[k];
+            const quint64 c1 = (nw[k] & n[k]) | (t & ne[k]);
+            t = w[k] ^ e[k];
+            const quint64 s2 = t ^ sw[k];
+            const quint64 c2 = (w[k] & e[k]) | (t & sw[k]);
+            const quint64 s3 = s[k] ^ se[k];
+            const quint64 c3 = s[k] & se[k];
+            // ones
+            t = s1 ^ s2;
+            const quint64 ones = t ^ s3;
+            const quint64 c4 = (s1 & s2) | (t & s3);
+            // twos and fours
+            t = c1 ^ c2;
+            const quint64 t2 = t ^ c3;
+            const quint64 c5 = (c1 & c2) | (t & c3);
+            const quint64 twos = t2 ^ c4;
+            const quint64 fours = c5 ^ (t2 & c4);
+            // alive with 2 or 3 neighbours; or dead with 3
+            out[k] = twos & ~fours & (ones | cell[k]);
+        }
+        out[m_words-1] &= lastMask;
+    }
+
+    m_cells.swap(m_next);
+}
+
+} // evoplex
+#endif // PACKED_LATTICE_H
@@ -14,42 +14,92 @@ bool GameOfLife::init()
 {
     // gets the id of the `live` node's attribute, which is the same for all nodes
     m_liveAttrId = node(0).attrs().indexOf("live");
-    return m_liveAttrId >= 0;
+    if (m_liveAttrId < 0) {
+        return false;
+    }
+    // all nodes are updated at once, so we use a double-buffered column
+    m_live = nodeBuffer<bool>(m_liveAttrId);
+    m_packed = false;
+    m_unsynced = false;
+    return m_live != nullptr;
+}
+
+void GameOfLife::beforeLoop()
+{
+    // the nodes might have been changed while paused (e.g., in the GUI),
+    // so the packed cells are always rebuilt from the 'live' column
+    m_packed = initLattice();
+    m_unsynced = false;
 }
 
 bool GameOfLife::algorithmStep()
 {
-    std::vector<Value> nextStates;
-    nextStates.reserve(nodes().size());
+    if (m_packed) {
+        m_lattice.step();
+        m_unsynced = true;
+        return true;
+    }
 
-    for (Node node : nodes()) {
+    const Topology& topology = graph()->topology();
+    Q_ASSERT_X(topology.isValid(), "GameOfLife", "the graph must be static");
+
+    const bool* live = m_live->constData();
+    bool* next = m_live->nextData();
+    for (int i = 0; i < m_live->size(); ++i) {
         int liveNeighbourCount = 0;
-        for (Node neighbour : node.outEdges()){
-            if (neighbour.attr(m_liveAttrId).toBool()) {
-                ++liveNeighbourCount;
-            }
+        for (int neighbour : topology.outNeighbours(i)) {
+            liveNeighbourCount += live[neighbour];
         }
 
-        if (node.attr(m_liveAttrId).toBool()) {
-            if (liveNeighbourCount < 2) { // Dies due to underpopulation
-                nextStates.emplace_back(false);
-            } else if (liveNeighbourCount < 4) { // Lives to next state
-                nextStates.emplace_back(true);
-            }  else { // Dies due to overpopulation
-                nextStates.emplace_back(false);
-            }
+        if (live[i]) {
+            // Dies due to underpopulation (<2) or overpopulation (>3)
+            next[i] = liveNeighbourCount == 2 || liveNeighbourCount == 3;
         } else {
             // Any dead node with exactly three live neighbors
             // becomes a live node, as if by reproduction.
-            nextStates.emplace_back(liveNeighbourCount == 3);
+            next[i] = liveNeighbourCount == 3;
+        }
+    }
+    return true;
+}
+
+void GameOfLife::syncNodes()
+{
+    if (!m_unsynced) {
+        return;
+    }
+    bool* live = m_live->data();
+    const int width = m_lattice.width();
+    for (int r = 0; r < m_lattice.height(); ++r) {
+        for (int c = 0; c < width; ++c) {
+            live[m_cellIdx[static_cast<size_t>(r * width + c)]] = m_lattice.get(r, c);
         }
     }
+    m_unsynced = false;
+}
+
+bool GameOfLife::initLattice()
+{
+    // The lattice engine must give exactly the same results as the generic
+    // one, so we only use it when the eight neighbours of each cell are
+    // distinct nodes, i.e., 'squareGrid' with at least 3x3 cells.
+    if (graphId() != "squareGrid" || graph()->attr("neighbours", 0).toInt() != 8) {
+        return false;
+    }
+    const int width = graph()->attr("width", 0).toInt();
+    const int height = graph()->attr("height", 0).toInt();
+    if (width < 3 || height < 3 || width * height != m_live->size()) {
+        return false;
+    }
+    m_lattice.reset(width, height, graph()->attr("boundary").toQString() == "periodic");
 
-    // For each node, load the next state into the current state
-    size_t i = 0;
-    for (Node node : nodes()) {
-        node.setAttr(m_liveAttrId, nextStates.at(i));
-        ++i;
+    // squareGrid uses row-major node ids
+    const bool* live = m_live->constData();
+    m_cellIdx.resize(static_cast<size_t>(width * height));
+    for (int id = 0; id < width * height; ++id) {
+        const int idx = nodes().indexOf(node(id));
+        m_cellIdx[static_cast<size_t>(id)] = idx;
+        m_lattice.set(id / width, id % width, live[idx]);
     }
     return true;
 }
@@ -9,17 +9,32 @@
 #ifndef GAME_OF_LIFE_H
 #define GAME_OF_LIFE_H
 
+#include <vector>
 #include <plugininterface.h>
 
+#include "packedlattice.h"
+
 namespace evoplex {
 class GameOfLife: public AbstractModel
 {
 public:
     bool init() override;
+    void beforeLoop() override;
     bool algorithmStep() override;
+    void syncNodes() override;
 
 private:
     int m_liveAttrId;  // the id of the 'live' node's attribute
+    NodeColumn<bool>* m_live; // the (double-buffered) 'live' states
+
+    // Bit-packed lattice engine, used on 'squareGrid' graphs with eight
+    // neighbours; it gives exactly the same results as the generic one.
+    bool m_packed;      // true if the lattice engine is in use
+    bool m_unsynced;    // true if m_live is behind the packed cells
+    PackedLattice m_lattice;
+    std::vector<int> m_cellIdx; // node position of each cell (row-major)
+
+    bool initLattice();
 };
 } // evoplex
 #endif // GAME_OF_LIFEL_H
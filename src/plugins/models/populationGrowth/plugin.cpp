@@ -14,49 +14,180 @@ bool PopulationGrowth::init()
 {
     // gets the id of the `infected` node's attribute, which is the same for all nodes
     m_infectedAttrId = node(0).attrs().indexOf("infected");
-    // initializing model attribute, which is constant throughout the simulation
+    // initializing model attributes, which are constant throughout the simulation
     m_prob = attr("prob").toDouble();
+    m_useFrontier = attr("frontier", false).toBool();
+    m_frontier.clear();
 
-    return m_infectedAttrId >= 0;
+    if (m_infectedAttrId < 0) {
+        return false;
+    }
+    // all nodes are updated at once, so we use a double-buffered column
+    m_infected = nodeBuffer<bool>(m_infectedAttrId);
+    return m_infected != nullptr;
+}
+
+void PopulationGrowth::beforeLoop()
+{
+    if (!m_useFrontier) {
+        return;
+    }
+
+    // the nodes might have been changed while paused (e.g., in the GUI),
+    // so the frontier is always rebuilt from the 'infected' column; the
+    // nodes which remain in it keep their order, so pausing or resuming
+    // from a checkpoint does not change the outcome of the simulation
+    const Topology& topology = graph()->topology();
+    Q_ASSERT_X(topology.isValid(), "PopulationGrowth", "the graph must be static");
+
+    const bool* infected = m_infected->constData();
+    std::vector<int> previous;
+    previous.swap(m_frontier);
+    m_inFrontier.assign(static_cast<size_t>(m_infected->size()), false);
+    for (const int i : previous) {
+        if (i < m_infected->size() && !infected[i] && !m_inFrontier[static_cast<size_t>(i)]
+                && hasInfectedNeighbour(topology, infected, i)) {
+            m_inFrontier[static_cast<size_t>(i)] = true;
+            m_frontier.emplace_back(i);
+        }
+    }
+    for (int i = 0; i < m_infected->size(); ++i) {
+        if (infected[i]) {
+            expandFrontier(topology, infected, i);
+        }
+    }
 }
 
 bool PopulationGrowth::algorithmStep()
 {
-    std::vector<Value> nextInfectedStates;
-    nextInfectedStates.reserve(nodes().size());
+    if (m_useFrontier) {
+        return frontierStep();
+    }
+    fullStep();
+    return true;
+}
+
+void PopulationGrowth::fullStep()
+{
+    const Topology& topology = graph()->topology();
+    Q_ASSERT_X(topology.isValid(), "PopulationGrowth", "the graph must be static");
 
-    for (Node node : nodes()) {
-        if (node.attr(m_infectedAttrId).toBool()) {
-            nextInfectedStates.emplace_back(true);
+    const bool* infected = m_infected->constData();
+    bool* next = m_infected->nextData();
+    for (int i = 0; i < m_infected->size(); ++i) {
+        if (infected[i]) {
+            next[i] = true;
             continue; // the node is already infected; skip
         }
 
-        if (node.outDegree() < 1) {
-            nextInfectedStates.emplace_back(false);
+        const Topology::Span neighbours = topology.outNeighbours(i);
+        if (neighbours.empty()) {
+            next[i] = false;
             continue; // the node does not have neighbours; skip
         }
 
         // Select a random neighbour
-        auto neighbour = node.randNeighbour(prg());
+        const int neighbour = neighbours[prg()->uniform(neighbours.size() - 1)];
+
+        // and check if the neighbour is currently infected; if so, the
+        // current node will become infected with a given probability
+        next[i] = infected[neighbour] && m_prob > prg()->uniform();
+    }
+}
+
+bool PopulationGrowth::frontierStep()
+{
+    if (m_frontier.empty()) {
+        // nobody else can be infected; return false to stop the simulation
+        return false;
+    }
+
+    const Topology& topology = graph()->topology();
+    const bool* infected = m_infected->constData();
 
-        // and check if the neighbour is currently infected
-        if (neighbour.attr(m_infectedAttrId).toBool()) {
-            // if so, the current node will become infected with a given probability
-            nextInfectedStates.emplace_back(m_prob > prg()->uniform());
+    // 1. same rule as in fullStep(), but only for the nodes in the frontier;
+    // the nodes which remain susceptible are kept in the frontier
+    m_newlyInfected.clear();
+    size_t remaining = 0;
+    for (const int i : m_frontier) {
+        const Topology::Span neighbours = topology.outNeighbours(i);
+        const int neighbour = neighbours[prg()->uniform(neighbours.size() - 1)];
+        if (infected[neighbour] && m_prob > prg()->uniform()) {
+            m_newlyInfected.emplace_back(i);
+            m_inFrontier[static_cast<size_t>(i)] = false;
         } else {
-            nextInfectedStates.emplace_back(false);
+            m_frontier[remaining++] = i;
         }
     }
+    m_frontier.resize(remaining);
 
-    // For each node, load the next state into the current state
-    size_t i = 0;
-    for (Node node : nodes()) {
-        node.setAttr(m_infectedAttrId, nextInfectedStates.at(i));
-        ++i;
+    // 2. the states are changed only after visiting the whole frontier, so
+    // all nodes are updated at once; there is no need for the next buffer
+    // as all the other nodes keep their states
+    bool* states = m_infected->data();
+    for (const int i : m_newlyInfected) {
+        states[i] = true;
     }
+    for (const int i : m_newlyInfected) {
+        expandFrontier(topology, states, i);
+    }
+
+    return true;
+}
 
+void PopulationGrowth::saveState(QDataStream& out) const
+{
+    out << static_cast<quint32>(m_frontier.size());
+    for (const int i : m_frontier) {
+        out << static_cast<qint32>(i);
+    }
+}
+
+bool PopulationGrowth::loadState(QDataStream& in)
+{
+    // the frontier is checked against the nodes in beforeLoop()
+    quint32 size;
+    in >> size;
+    if (size > static_cast<quint32>(m_infected->size())) {
+        qWarning() << "invalid frontier in the checkpoint" << size;
+        return false;
+    }
+    m_frontier.resize(size);
+    for (int& i : m_frontier) {
+        qint32 node;
+        in >> node;
+        if (node < 0) {
+            qWarning() << "invalid frontier in the checkpoint" << node;
+            return false;
+        }
+        i = node;
+    }
     return true;
 }
+
+bool PopulationGrowth::hasInfectedNeighbour(const Topology& topology,
+                                            const bool* infected, int n) const
+{
+    for (const int neighbour : topology.outNeighbours(n)) {
+        if (infected[neighbour]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PopulationGrowth::expandFrontier(const Topology& topology,
+                                      const bool* infected, int infectedNode)
+{
+    // a node picks its neighbours from its out-edges, so the nodes
+    // which can be infected by 'infectedNode' are its in-neighbours
+    for (const int n : topology.inNeighbours(infectedNode)) {
+        if (!infected[n] && !m_inFrontier[static_cast<size_t>(n)]) {
+            m_inFrontier[static_cast<size_t>(n)] = true;
+            m_frontier.emplace_back(n);
+        }
+    }
+}
 } // evoplex
 REGISTER_PLUGIN(PopulationGrowth)
 #include "plugin.moc"
@@ -9,6 +9,7 @@
 #ifndef POPULATION_GROWTH_H
 #define POPULATION_GROWTH_H
 
+#include <vector>
 #include <plugininterface.h>
 
 namespace evoplex {
@@ -16,11 +17,33 @@ class PopulationGrowth: public AbstractModel
 {
 public:
     bool init() override;
+    void beforeLoop() override;
     bool algorithmStep() override;
+    void saveState(QDataStream& out) const override;
+    bool loadState(QDataStream& in) override;
 
 private:
     int m_infectedAttrId;   // the id of the 'infected' node's attribute
     double m_prob;          // probability of a node becoming infected
+    NodeColumn<bool>* m_infected; // the (double-buffered) 'infected' states
+
+    // Frontier mode: only the susceptible nodes which have at least one
+    // infected neighbour are visited; the others cannot change their state.
+    bool m_useFrontier;           // model attribute: enables the frontier mode
+    // the susceptible nodes in the frontier; their order defines which
+    // random numbers each node gets, so it is kept in the checkpoints
+    std::vector<int> m_frontier;
+    std::vector<char> m_inFrontier; // true if the node is in m_frontier
+    std::vector<int> m_newlyInfected;
+
+    // visits all nodes
+    void fullStep();
+    // visits the nodes in the frontier; returns false if it is empty
+    bool frontierStep();
+    // returns true if the node 'n' picks its neighbours among infected ones
+    bool hasInfectedNeighbour(const Topology& topology, const bool* infected, int n) const;
+    // adds the susceptible in-neighbours of the 'infected' node to the frontier
+    void expandFrontier(const Topology& topology, const bool* infected, int infectedNode);
 };
 } // evoplex
 #endif // POPULATION_GROWTH_H
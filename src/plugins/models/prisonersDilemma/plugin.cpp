@@ -9,74 +9,64 @@
 
 namespace evoplex {
 
+// payoffs which do not depend on the model attributes
+static constexpr double REWARD = 1.0;       // CC : Reward for mutual cooperation
+static constexpr double SUCKER = 0.0;       // CD : Sucker's payoff
+static constexpr double PUNISHMENT = 0.0;   // DD : Punishment for mutual defection
+
 bool PDGame::init()
 {
     m_temptation = attr("temptation", -1.0).toDouble();
-    return m_temptation >=1.0 && m_temptation <= 2.0;
+    m_payoff[0][0] = REWARD;
+    m_payoff[0][1] = SUCKER;
+    m_payoff[1][0] = m_temptation; // DC : Temptation to defect
+    m_payoff[1][1] = PUNISHMENT;
+
+    // the strategies are updated synchronously, so they are double-buffered
+    m_strategy = nodeBuffer<int>(STRATEGY);
+    m_score = nodeColumn<double>(SCORE);
+    return m_strategy && m_score && m_temptation >=1.0 && m_temptation <= 2.0;
 }
 
 bool PDGame::algorithmStep()
 {
+    const Topology& topology = graph()->topology();
+    Q_ASSERT_X(topology.isValid(), "PDGame", "the graph must be static");
+
+    const int numNodes = m_strategy->size();
+    const int* strategy = m_strategy->constData();
+    double* score = m_score->data();
+
     // 1. each agent accumulates the payoff obtained by playing
-    //    the game with all its neighbours and itself
-    for (Node node : nodes()) {
-        const int sX = node.attr(STRATEGY).toInt();
-        double score = playGame(sX, sX);
-        for (const Node& neighbour : node.outEdges()) {
-            score += playGame(sX, neighbour.attr(STRATEGY).toInt());
+    //    the game with all its neighbours and itself; as there are only
+    //    two strategies, we just need to count the defectors around it
+    for (int i = 0; i < numNodes; ++i) {
+        const Topology::Span neighbours = topology.outNeighbours(i);
+        int defectors = binarize(strategy[i]);
+        for (int neighbour : neighbours) {
+            defectors += binarize(strategy[neighbour]);
         }
-        node.setAttr(SCORE, score);
+        const int cooperators = neighbours.size() + 1 - defectors;
+        const double* payoff = m_payoff[binarize(strategy[i])];
+        score[i] = payoff[0] * cooperators + payoff[1] * defectors;
     }
 
-    std::vector<char> bestStrategies;
-    bestStrategies.reserve(nodes().size());
-
     // 2. the best agent in the neighbourhood is selected to reproduce
-    for (const Node& node : nodes()) {
-        int bestStrategy = node.attr(STRATEGY).toInt();
-        double highestScore = node.attr(SCORE).toDouble();
-        for (const Node& neighbour : node.outEdges()) {
-            const double neighbourScore = neighbour.attr(SCORE).toDouble();
-            if (neighbourScore > highestScore) {
-                highestScore = neighbourScore;
-                bestStrategy = neighbour.attr(STRATEGY).toInt();
-            }
+    // 3. and the next generation is prepared
+    int* nextStrategy = m_strategy->nextData();
+    for (int i = 0; i < numNodes; ++i) {
+        int best = i;
+        for (int neighbour : topology.outNeighbours(i)) {
+            best = score[neighbour] > score[best] ? neighbour : best;
         }
-        bestStrategies.emplace_back(binarize(bestStrategy));
-    }
-
-    // 3. prepare the next generation
-    size_t i = 0;
-    for (Node node : nodes()) {
-        int s = binarize(node.attr(STRATEGY).toInt());
-        s = (s == bestStrategies.at(i)) ? s : bestStrategies.at(i) + 2;
-        node.setAttr(STRATEGY, s);
-        ++i;
+        const int bestStrategy = binarize(strategy[best]);
+        const int s = binarize(strategy[i]);
+        nextStrategy[i] = (s == bestStrategy) ? s : bestStrategy + 2;
     }
 
     return true;
 }
 
-// 0) cooperator; 1) new cooperator
-// 2) defector;   3) new defector
-double PDGame::playGame(const int sX, const int sY) const
-{
-    switch (binarize(sX) * 2 + binarize(sY)) {
-    case 0: return 1.0;             // CC : Reward for mutual cooperation
-    case 1: return 0.0;             // CD : Sucker's payoff
-    case 2: return m_temptation;    // DC : Temptation to defect
-    case 3: return 0.0;             // DD : Punishment for mutual defection
-    default: qFatal("Error! strategy should be 0 or 1!");
-    }
-}
-
-// transform from 0|2 -> 0 (cooperator)
-//                1|3 -> 1 (defector)
-int PDGame::binarize(const int strategy) const
-{
-    return (strategy < 2) ? strategy : strategy - 2;
-}
-
 } // evoplex
 REGISTER_PLUGIN(PDGame)
 #include "plugin.moc"
@@ -21,9 +21,17 @@ private:
     enum NodeAttr { STRATEGY, SCORE };
 
     double m_temptation;
+    NodeColumn<int>* m_strategy; // double-buffered
+    NodeColumn<double>* m_score;
 
-    double playGame(const int sX, const int sY) const;
-    int binarize(const int strategy) const;
+    // payoff of a player with the (binarized) strategy X
+    // against a player with the (binarized) strategy Y
+    double m_payoff[2][2];
+
+    // 0) cooperator; 1) defector; 2) new cooperator; 3) new defector
+    // transform from 0|2 -> 0 (cooperator)
+    //                1|3 -> 1 (defector)
+    static constexpr int binarize(const int strategy) { return strategy & 1; }
 };
 } // evoplex
 #endif
@@ -36,6 +36,9 @@ private slots:
     void tst_replace();
     void tst_push_back();
     void tst_setValue();
+    void tst_schema();
+    void tst_copyOnWrite();
+    void tst_build();
 
 private: // auxiliary functions
     void _tst_empty(Attributes a);
@@ -364,5 +367,108 @@ void TestAttributes::tst_setValue()
     _tst_empty(a5);
 }
 
+// Tests if the 'AttributesSchema' is shared and detached as expected.
+void TestAttributes::tst_schema()
+{
+    auto schema = std::make_shared<AttributesSchema>(std::vector<QString>({"a", "b", "a"}));
+    QCOMPARE(schema->size(), 3);
+    QCOMPARE(schema->indexOf("a"), 0); // first occurrence
+    QCOMPARE(schema->indexOf("b"), 1);
+    QCOMPARE(schema->indexOf("c"), -1);
+
+    Attributes a1(schema);
+    QCOMPARE(a1.size(), 3);
+    QCOMPARE(a1.name(2), QString("a"));
+    for (const Value& value : a1.values()) {
+        QVERIFY(!value.isValid());
+    }
+
+    // copies and values changes keep the schema shared
+    Attributes a2(a1);
+    a2.setValue(1, Value(123));
+    a2.replace(0, "a", Value(234));
+    QCOMPARE(a2.schema().get(), schema.get());
+    QCOMPARE(a2.value("b"), Value(123));
+    QVERIFY(!a1.value(1).isValid());
+
+    // renaming an attribute detaches the container from the schema
+    a2.replace(1, "c", Value(345));
+    QVERIFY(a2.schema().get() != schema.get());
+    QCOMPARE(a2.indexOf("c"), 1);
+    QCOMPARE(a2.value(0), Value(234));
+    QCOMPARE(a1.schema().get(), schema.get());
+    QCOMPARE(a1.indexOf("c"), -1);
+    QCOMPARE(a1.name(1), QString("b"));
+}
+
+void TestAttributes::tst_copyOnWrite()
+{
+    Attributes a1(3);
+    a1.setValue(0, Value(1));
+
+    // copies share the values until one of them changes
+    Attributes a2(a1);
+    Attributes a3(a1);
+    QCOMPARE(&a2.values(), &a1.values());
+    QCOMPARE(&a3.values(), &a1.values());
+
+    a2.setValue(0, Value(2));
+    QVERIFY(&a2.values() != &a1.values());
+    QCOMPARE(&a3.values(), &a1.values());
+    QCOMPARE(a1.value(0), Value(1));
+    QCOMPARE(a2.value(0), Value(2));
+    QCOMPARE(a3.value(0), Value(1));
+
+    // a container which is not shared is changed in place
+    const std::vector<Value>* values = &a2.values();
+    a2.setValue(1, Value(3));
+    QCOMPARE(&a2.values(), values);
+
+    a3.push_back("d", Value(4));
+    QCOMPARE(a3.size(), 4);
+    QCOMPARE(a1.size(), 3);
+    QVERIFY_EXCEPTION_THROWN(a1.setValue(3, Value(5)), std::out_of_range);
+}
+
+// Tests if building a container changes its own schema in place.
+void TestAttributes::tst_build()
+{
+    Attributes a1;
+    a1.reserve(100);
+    const AttributesSchema* schema = a1.schema().get();
+    QVERIFY(schema != AttributesSchema::emptySchema().get());
+    QCOMPARE(AttributesSchema::emptySchema()->size(), 0);
+    for (int i = 0; i < 100; ++i) {
+        a1.push_back(QString::number(i % 50), Value(i));
+    }
+    QCOMPARE(a1.schema().get(), schema);
+    QCOMPARE(a1.size(), 100);
+    QCOMPARE(a1.indexOf("7"), 7); // first occurrence
+    QCOMPARE(a1.value("49"), Value(49));
+
+    // a copy shares the schema, so renaming detaches it again
+    Attributes a2(a1);
+    a2.replace(7, "x", Value(0));
+    QVERIFY(a2.schema().get() != schema);
+    QCOMPARE(a2.indexOf("7"), 57);
+    QCOMPARE(a2.indexOf("x"), 7);
+    QCOMPARE(a1.indexOf("7"), 7);
+    QCOMPARE(a1.indexOf("x"), -1);
+
+    // renames and resizes keep the ids of the first occurrences
+    const AttributesSchema* schema2 = a2.schema().get();
+    a2.replace(2, "x", Value(0));
+    QCOMPARE(a2.indexOf("x"), 2);
+    a2.replace(2, "2", Value(0));
+    QCOMPARE(a2.indexOf("x"), 7);
+    a2.resize(55);
+    QCOMPARE(a2.indexOf("7"), -1);
+    QCOMPARE(a2.indexOf("4"), 4);
+    a2.resize(57);
+    QCOMPARE(a2.indexOf(""), 55);
+    QCOMPARE(a2.schema().get(), schema2);
+    QCOMPARE(a2.names().size(), size_t(57));
+}
+
 QTEST_MAIN(TestAttributes)
 #include "tst_attributes.moc"
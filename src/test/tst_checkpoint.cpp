@@ -0,0 +1,275 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <vector>
+
+#include <core/checkpoint.h>
+#include <core/experiment.h>
+#include <core/expinputs.h>
+#include <core/nodes_p.h>
+#include <core/project.h>
+#include <core/trial.h>
+#include <core/include/abstractgraph.h>
+#include <core/include/abstractmodel.h>
+
+namespace evoplex {
+
+// node i is linked to i+1 and i+3
+class CkptGraph: public AbstractGraph
+{
+public:
+    CkptGraph(Trial* trial, const Nodes& nodes)
+    { m_trial = trial; m_nodes = nodes; }
+
+    bool reset() override {
+        const int n = numNodes();
+        for (int i = 0; i < n; ++i) {
+            link(i, (i + 1) % n);
+            link(i, (i + 3) % n);
+        }
+        return true;
+    }
+
+    // the edges hold the number of edges when they were added
+    Edge link(int originId, int neighbourId) {
+        Attributes* attrs = new Attributes(1);
+        attrs->replace(0, "w", Value(numEdges()));
+        return addEdge(originId, neighbourId, attrs);
+    }
+};
+
+// a model with its own state
+class CkptModel: public AbstractModel
+{
+public:
+    std::vector<int> visited;
+
+    explicit CkptModel(Trial* trial) { m_trial = trial; }
+
+    bool algorithmStep() override { return true; }
+    void saveState(QDataStream& out) const override
+    {
+        out << static_cast<quint32>(visited.size());
+        for (int v : visited) out << static_cast<qint32>(v);
+    }
+    bool loadState(QDataStream& in) override
+    {
+        quint32 size;
+        in >> size;
+        visited.resize(size);
+        for (int& v : visited) { qint32 v32; in >> v32; v = v32; }
+        return in.status() == QDataStream::Ok;
+    }
+};
+
+class TestCheckpoint: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void tst_roundTrip();
+    void tst_fingerprint();
+
+private:
+    ExperimentPtr m_exp;
+    QString m_path;
+
+    // the trial owns the graph, the model and the PRG
+    void newTrial(Trial& trial, const Nodes& nodes, int seed);
+    void roundTrip(GraphType type);
+    // the nodes, the edges and the order of the neighbours must be the same
+    void compare(AbstractGraph* a, AbstractGraph* b);
+};
+
+void TestCheckpoint::initTestCase()
+{
+    // the fingerprint is made of the experiment's inputs
+    m_exp = std::make_shared<Experiment>(nullptr, 0, std::make_shared<Project>(nullptr, 0));
+    Attributes* general = new Attributes(1);
+    general->replace(0, GENERAL_ATTR_SEED, Value(123));
+    m_exp->m_inputs = new ExpInputs(nullptr, nullptr, general,
+                                    new Attributes(), new Attributes(), {});
+    m_path = QDir::tempPath() + "/tst_checkpoint.ckpt";
+}
+
+void TestCheckpoint::cleanupTestCase()
+{
+    QFile::remove(m_path);
+}
+
+void TestCheckpoint::newTrial(Trial& trial, const Nodes& nodes, int seed)
+{
+    trial.m_prg = new PRG(seed);
+    auto graph = new CkptGraph(&trial, nodes);
+    graph->m_lastNodeId = static_cast<int>(nodes.size());
+    trial.m_graph = graph;
+    trial.m_model = new CkptModel(&trial);
+}
+
+void TestCheckpoint::tst_roundTrip()
+{
+    roundTrip(GraphType::Undirected);
+    roundTrip(GraphType::Directed);
+}
+
+void TestCheckpoint::roundTrip(GraphType type)
+{
+    m_exp->m_graphType = type;
+    AttributesScope attrsScope;
+    attrsScope.insert("state", AttributeRange::parse(0, "state", "int[0,100]"));
+    QString error;
+    Nodes nodes = NodesPrivate::fromCmd("*10;min", attrsScope, type, error);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node node = nodes.atIndex(static_cast<int>(i));
+        node.setAttr(0, Value(static_cast<int>(i) * 7));
+    }
+
+    Trial trial(0, m_exp);
+    newTrial(trial, nodes, 123);
+    auto graph = static_cast<CkptGraph*>(trial.m_graph);
+    QVERIFY(graph->reset());
+
+    // removes and adds nodes and edges, so that the ids have gaps and the
+    // adjacency lists are no longer in the order the edges were added
+    graph->removeNode(graph->node(2));
+    Edge edge = graph->edge(9);
+    graph->removeEdge(edge);
+    edge = graph->edge(0);
+    graph->removeEdge(edge);
+    Node added = graph->addNode(graph->node(0).attrs(), 1.f, 2.f);
+    graph->link(added.id(), 5);
+    graph->link(6, added.id());
+    Node removed = graph->addNode(graph->node(0).attrs());
+    edge = graph->link(3, removed.id());
+    graph->removeEdge(edge);
+    graph->removeNode(removed);
+
+    // the state of the PRG and of the model
+    for (int i = 0; i < 5; ++i) {
+        trial.m_prg->uniform();
+    }
+    auto model = static_cast<CkptModel*>(trial.m_model);
+    model->visited = {4, 8, 15, 16, 23, 42};
+    model->m_time = 3.5;
+    trial.m_step = 7;
+
+    QVERIFY(Checkpoint::write(m_path, Checkpoint::save(&trial, 1234)));
+
+    // resumes in a trial with a different seed
+    auto checkpoint = Checkpoint::open(m_path, Checkpoint::fingerprint(m_exp.get(), 0), error);
+    QVERIFY(checkpoint);
+    QCOMPARE(checkpoint->step(), 7);
+    QCOMPARE(checkpoint->outputSize(), qint64(1234));
+    Nodes resumedNodes = checkpoint->readNodes(type, error);
+    QVERIFY(error.isEmpty());
+    Trial resumed(0, m_exp);
+    newTrial(resumed, resumedNodes, 999);
+    QVERIFY(checkpoint->readState(resumed.m_graph, resumed.m_prg, resumed.m_model, error));
+    QVERIFY(error.isEmpty());
+
+    compare(graph, resumed.m_graph);
+    auto resumedModel = static_cast<CkptModel*>(resumed.m_model);
+    QCOMPARE(resumedModel->visited, model->visited);
+    QCOMPARE(resumedModel->m_time, 3.5);
+
+    // both carry on in the same way
+    for (int i = 0; i < 100; ++i) {
+        const int idx = i % graph->numNodes();
+        QCOMPARE(graph->nodes().atIndex(idx).randNeighbour(trial.m_prg).id(),
+                 resumed.m_graph->nodes().atIndex(idx).randNeighbour(resumed.m_prg).id());
+        QCOMPARE(trial.m_prg->uniform(), resumed.m_prg->uniform());
+    }
+
+    // and the new nodes and edges get the same (unused) ids
+    const int numNodes = graph->numNodes();
+    Node a = graph->addNode(graph->node(0).attrs());
+    Node b = resumed.m_graph->addNode(graph->node(0).attrs());
+    QCOMPARE(a.id(), b.id());
+    QCOMPARE(resumed.m_graph->numNodes(), numNodes + 1);
+    auto resumedGraph = static_cast<CkptGraph*>(resumed.m_graph);
+    QCOMPARE(graph->link(a.id(), 0).id(), resumedGraph->link(b.id(), 0).id());
+    compare(graph, resumed.m_graph);
+}
+
+void TestCheckpoint::compare(AbstractGraph* a, AbstractGraph* b)
+{
+    QCOMPARE(b->numNodes(), a->numNodes());
+    for (int i = 0; i < a->numNodes(); ++i) {
+        const Node& na = a->nodes().atIndex(i);
+        const Node& nb = b->nodes().atIndex(i);
+        QCOMPARE(nb.id(), na.id());
+        QCOMPARE(nb.x(), na.x());
+        QCOMPARE(nb.y(), na.y());
+        QCOMPARE(nb.attrs().values(), na.attrs().values());
+    }
+
+    QCOMPARE(b->numEdges(), a->numEdges());
+    for (auto const& p : a->edges()) {
+        const Edge& eb = b->edge(p.first);
+        QCOMPARE(eb.origin().id(), p.second.origin().id());
+        QCOMPARE(eb.neighbour().id(), p.second.neighbour().id());
+        QCOMPARE(eb.attrs()->values(), p.second.attrs()->values());
+    }
+
+    // the CSR view follows the order of the neighbours of each node
+    a->freezeTopology();
+    b->freezeTopology();
+    for (int i = 0; i < a->numNodes(); ++i) {
+        const auto outA = a->topology().outNeighbours(i);
+        const auto outB = b->topology().outNeighbours(i);
+        QCOMPARE(std::vector<int>(outB.begin(), outB.end()),
+                 std::vector<int>(outA.begin(), outA.end()));
+        if (a->isDirected()) {
+            const auto inA = a->topology().inNeighbours(i);
+            const auto inB = b->topology().inNeighbours(i);
+            QCOMPARE(std::vector<int>(inB.begin(), inB.end()),
+                     std::vector<int>(inA.begin(), inA.end()));
+        }
+    }
+}
+
+void TestCheckpoint::tst_fingerprint()
+{
+    m_exp->m_graphType = GraphType::Undirected;
+    QString error;
+    Nodes nodes = NodesPrivate::fromCmd("*4;min", AttributesScope(), GraphType::Undirected, error);
+    Trial trial(0, m_exp);
+    newTrial(trial, nodes, 123);
+    QVERIFY(trial.m_graph->reset());
+    QVERIFY(Checkpoint::write(m_path, Checkpoint::save(&trial, 0)));
+
+    // a checkpoint is only resumed by the same trial
+    QVERIFY(!Checkpoint::open(m_path, Checkpoint::fingerprint(m_exp.get(), 1), error));
+    QVERIFY(!error.isEmpty());
+    error.clear();
+    QVERIFY(Checkpoint::open(m_path, Checkpoint::fingerprint(m_exp.get(), 0), error));
+    QVERIFY(error.isEmpty());
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestCheckpoint)
+#include "tst_checkpoint.moc"
@@ -0,0 +1,297 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <core/compactedges.h>
+#include <core/experiment.h>
+#include <core/nodes_p.h>
+#include <core/project.h>
+#include <core/sharedtopology.h>
+#include <core/trial.h>
+#include <core/include/abstractgraph.h>
+
+namespace evoplex {
+
+// node i is linked to i+1 and i+3; node 0 has a self-loop and
+// there are two edges from 1 to 2; the edges have no attributes
+class PlainGraph: public AbstractGraph
+{
+public:
+    PlainGraph(Trial* trial, GraphType type)
+    {
+        QString error;
+        m_trial = trial;
+        m_nodes = NodesPrivate::fromCmd("*8;min", AttributesScope(), type, error);
+    }
+
+    bool reset() override {
+        const int n = numNodes();
+        for (int i = 0; i < n; ++i) {
+            addEdge(i, (i + 1) % n);
+            addEdge(i, (i + 3) % n);
+        }
+        addEdge(0, 0);
+        addEdge(1, 2);
+        return true;
+    }
+};
+
+class TestCompactEdges: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() {}
+    void tst_views();
+    void tst_thaw();
+    void tst_shared();
+
+private:
+    ExperimentPtr m_exp;
+
+    // resets and compacts the graph
+    void init(AbstractGraph& graph);
+    void views(GraphType type);
+    void thaw(GraphType type);
+    // the edges (origin, neighbour) of the graph, sorted by id
+    std::vector<std::pair<int, int>> edges(const AbstractGraph& graph);
+    std::vector<int> span(Topology::Span s);
+};
+
+void TestCompactEdges::initTestCase()
+{
+    // the graphs only need a trial to belong to
+    m_exp = std::make_shared<Experiment>(nullptr, 0, std::make_shared<Project>(nullptr, 0));
+}
+
+void TestCompactEdges::init(AbstractGraph& graph)
+{
+    QVERIFY(graph.reset());
+    graph.freezeTopology();
+    graph.compactEdges();
+    QVERIFY(graph.m_compactEdges);
+}
+
+std::vector<std::pair<int, int>> TestCompactEdges::edges(const AbstractGraph& graph)
+{
+    std::vector<std::pair<int, int>> edges;
+    for (auto const& p : graph.edges()) {
+        // they are listed by id
+        const int id = static_cast<int>(edges.size());
+        if (p.first != id) {
+            return {};
+        }
+        edges.emplace_back(p.second.origin().id(), p.second.neighbour().id());
+    }
+    return edges;
+}
+
+std::vector<int> TestCompactEdges::span(Topology::Span s)
+{
+    return std::vector<int>(s.begin(), s.end());
+}
+
+void TestCompactEdges::tst_views()
+{
+    views(GraphType::Undirected);
+    views(GraphType::Directed);
+}
+
+void TestCompactEdges::views(GraphType type)
+{
+    m_exp->m_graphType = type;
+    Trial trial(0, m_exp);
+    PlainGraph graph(&trial, type);
+    QVERIFY(graph.reset());
+    graph.freezeTopology();
+
+    // the same edges, but numbered following the CSR view
+    std::multiset<std::pair<int, int>> expected;
+    for (auto const& p : graph.edges()) {
+        int a = p.second.origin().id();
+        int b = p.second.neighbour().id();
+        if (graph.isUndirected() && a > b) {
+            std::swap(a, b);
+        }
+        expected.insert({a, b});
+    }
+    const Topology* topology = &graph.topology();
+
+    graph.compactEdges();
+    QVERIFY(graph.m_compactEdges);
+    QCOMPARE(&graph.topology(), topology);
+    QCOMPARE(graph.numEdges(), static_cast<int>(expected.size()));
+    const std::vector<std::pair<int, int>> compact = edges(graph);
+    QCOMPARE(compact.size(), expected.size());
+    const std::multiset<std::pair<int, int>> compactSet(compact.begin(), compact.end());
+    QCOMPARE(compactSet, expected);
+    QVERIFY_EXCEPTION_THROWN(graph.edge(graph.numEdges()), std::out_of_range);
+
+    // the nodes list their neighbours as in the CSR view
+    std::map<int, int> listed; // edge id -> times
+    const Nodes& nodes = graph.nodes();
+    for (int i = 0; i < graph.numNodes(); ++i) {
+        const Node& node = nodes.atIndex(i);
+        auto check = [&](const Edges& nodeEdges, Topology::Span s, bool out) {
+            QCOMPARE(static_cast<int>(nodeEdges.size()), s.size());
+            int pos = 0;
+            for (const Edge& e : nodeEdges) {
+                QCOMPARE(e.origin().id(), node.id());
+                QCOMPARE(e.neighbour().id(), nodes.atIndex(s[pos++]).id());
+                QCOMPARE(nodeEdges.at(e.id()).id(), e.id());
+                // the graph lists each edge in its original direction
+                const Edge& ge = graph.edge(e.id());
+                if (graph.isDirected() && !out) {
+                    QCOMPARE(ge.origin().id(), e.neighbour().id());
+                    QCOMPARE(ge.neighbour().id(), e.origin().id());
+                } else if (ge.origin().id() != e.origin().id()) {
+                    QVERIFY(graph.isUndirected());
+                    QCOMPARE(ge.origin().id(), e.neighbour().id());
+                    QCOMPARE(ge.neighbour().id(), e.origin().id());
+                } else {
+                    QCOMPARE(ge.neighbour().id(), e.neighbour().id());
+                }
+                ++listed[e.id()];
+            }
+            QCOMPARE(pos, s.size());
+        };
+        check(node.outEdges(), graph.topology().outNeighbours(i), true);
+        if (graph.isDirected()) {
+            check(node.inEdges(), graph.topology().inNeighbours(i), false);
+        }
+    }
+
+    // each edge is in both nodes, but a self-loop is listed
+    // only once by an undirected node
+    QCOMPARE(static_cast<int>(listed.size()), graph.numEdges());
+    for (auto const& p : listed) {
+        const Edge e = graph.edge(p.first);
+        const bool once = graph.isUndirected() && e.origin().id() == e.neighbour().id();
+        QCOMPARE(p.second, once ? 1 : 2);
+    }
+}
+
+void TestCompactEdges::tst_thaw()
+{
+    thaw(GraphType::Undirected);
+    thaw(GraphType::Directed);
+}
+
+void TestCompactEdges::thaw(GraphType type)
+{
+    m_exp->m_graphType = type;
+    Trial trial(0, m_exp);
+    PlainGraph graph(&trial, type);
+    init(graph);
+
+    std::vector<std::vector<int>> outs, ins;
+    for (int i = 0; i < graph.numNodes(); ++i) {
+        outs.emplace_back(span(graph.topology().outNeighbours(i)));
+        ins.emplace_back(span(graph.topology().inNeighbours(i)));
+    }
+    const std::vector<std::pair<int, int>> compact = edges(graph);
+    std::vector<int> randNeighbours;
+    PRG prg(123);
+    for (int i = 0; i < 50; ++i) {
+        randNeighbours.emplace_back(graph.nodes().atIndex(i % 8).randNeighbour(&prg).id());
+    }
+
+    // the edges are recreated with the same ids and in the same order
+    graph.thawEdges(true);
+    QVERIFY(!graph.m_compactEdges);
+    QCOMPARE(graph.numEdges(), static_cast<int>(compact.size()));
+    for (size_t id = 0; id < compact.size(); ++id) {
+        const Edge& e = graph.edge(static_cast<int>(id));
+        QCOMPARE(e.origin().id(), compact[id].first);
+        QCOMPARE(e.neighbour().id(), compact[id].second);
+    }
+    graph.freezeTopology();
+    for (int i = 0; i < graph.numNodes(); ++i) {
+        QCOMPARE(span(graph.topology().outNeighbours(i)), outs[static_cast<size_t>(i)]);
+        QCOMPARE(span(graph.topology().inNeighbours(i)), ins[static_cast<size_t>(i)]);
+    }
+    PRG prg2(123);
+    for (int i = 0; i < 50; ++i) {
+        QCOMPARE(graph.nodes().atIndex(i % 8).randNeighbour(&prg2).id(),
+                 randNeighbours[static_cast<size_t>(i)]);
+    }
+
+    // changing a compact graph recreates the edges first
+    graph.compactEdges();
+    QVERIFY(graph.m_compactEdges);
+    const Node origin = graph.node(compact[3].first);
+    const int degree = origin.outDegree();
+    graph.removeEdge(graph.edge(3));
+    QVERIFY(!graph.m_compactEdges);
+    QVERIFY(!graph.topology().isValid());
+    QCOMPARE(graph.numEdges(), static_cast<int>(compact.size()) - 1);
+    QCOMPARE(origin.outDegree(), degree - 1);
+    QVERIFY_EXCEPTION_THROWN(graph.edge(3), std::out_of_range);
+    QCOMPARE(graph.edge(4).origin().id(), compact[4].first);
+
+    // and the new edges get new ids
+    QCOMPARE(graph.addEdge(0, 1).id(), static_cast<int>(compact.size()));
+
+    // there is nothing to recreate if all edges are removed
+    graph.freezeTopology();
+    graph.compactEdges();
+    graph.removeAllEdges();
+    QVERIFY(!graph.m_compactEdges);
+    QCOMPARE(graph.numEdges(), 0);
+    QCOMPARE(origin.outDegree(), 0);
+}
+
+void TestCompactEdges::tst_shared()
+{
+    m_exp->m_graphType = GraphType::Undirected;
+    Trial trial(0, m_exp);
+    PlainGraph first(&trial, GraphType::Undirected);
+    init(first);
+    SharedTopologyPtr shared = SharedTopology::capture(&first);
+    QVERIFY(shared);
+
+    // the other trials get views of the same CSR view
+    PlainGraph restored(&trial, GraphType::Undirected);
+    QVERIFY(shared->restore(&restored));
+    QVERIFY(restored.m_compactEdges);
+    QCOMPARE(&restored.topology(), &first.topology());
+    QCOMPARE(edges(restored), edges(first));
+    for (int i = 0; i < restored.numNodes(); ++i) {
+        const Node& node = restored.nodes().atIndex(i);
+        const Edge e = node.outEdges().begin()->second;
+        QCOMPARE(&e.origin(), &restored.nodes().at(node.id()));
+    }
+
+    // a trial which changes the graph gets its own edges
+    restored.removeEdge(restored.edge(0));
+    QVERIFY(!restored.m_compactEdges);
+    QVERIFY(first.m_compactEdges);
+    QVERIFY(first.topology().isValid());
+    QCOMPARE(restored.numEdges(), first.numEdges() - 1);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestCompactEdges)
+#include "tst_compactedges.moc"
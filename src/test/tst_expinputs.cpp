@@ -0,0 +1,133 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <QDir>
+#include <QStringList>
+
+#include <core/include/constants.h>
+#include <core/expinputs.h>
+#include <core/mainapp.h>
+#include <core/modelplugin.h>
+
+namespace evoplex {
+
+// Reads the inputs of experiments saved by older versions of the plugins.
+class TestExpInputs: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() { delete m_mainApp; }
+    void tst_pluginDefaults();
+    void tst_binaryOutput();
+
+private:
+    MainApp* m_mainApp;
+};
+
+void TestExpInputs::initTestCase()
+{
+    // the paths of the built-in plugins are set by cmake
+    m_mainApp = new MainApp();
+    QString error;
+    if (!m_mainApp->graphs().contains("cycle")) {
+        QVERIFY(m_mainApp->loadPlugin(PLUGIN_CYCLE, error, false));
+    }
+    if (!m_mainApp->models().contains("populationGrowth")) {
+        QVERIFY(m_mainApp->loadPlugin(PLUGIN_POPULATIONGROWTH, error, false));
+    }
+}
+
+void TestExpInputs::tst_pluginDefaults()
+{
+    // a row of a project saved with 'populationGrowth' v1, i.e., without
+    // the 'frontier' attribute and the newer general attributes
+    const QStringList header = {
+        "id", "nodes", "graphId", "modelId", "graphVersion", "modelVersion",
+        "seed", "stopAt", "trials", "autoDelete", "graphType", "edgeAttrs",
+        "outputDirectory", "outputHeader", "populationGrowth_prob" };
+    QStringList values = {
+        "0", "*10;min", "cycle", "populationGrowth", "1", "1",
+        "0", "10", "1", "true", "undirected", "",
+        "", "", "0.5" };
+
+    QString error;
+    ExpInputsPtr inputs = ExpInputs::parse(m_mainApp, header, values, error);
+    QVERIFY(inputs);
+    QVERIFY(!error.contains("missing or invalid"));
+    QCOMPARE(inputs->modelPlugin()->version(), quint16(2));
+    QCOMPARE(inputs->general(GENERAL_ATTR_MODELVS), Value(2));
+    QCOMPARE(inputs->model("prob"), Value(0.5));
+    QCOMPARE(inputs->model("frontier"), Value(false));
+    QCOMPARE(inputs->general(GENERAL_ATTR_CYCLEPERIOD), Value(0));
+
+    // the attributes without a default value are still required
+    values[header.indexOf("populationGrowth_prob")] = "";
+    error.clear();
+    inputs = ExpInputs::parse(m_mainApp, header, values, error);
+    QVERIFY(inputs);
+    QVERIFY(error.contains("missing or invalid"));
+    QVERIFY(error.contains("prob"));
+    QVERIFY(!error.contains("frontier"));
+}
+
+void TestExpInputs::tst_binaryOutput()
+{
+    const QStringList header = {
+        "id", "nodes", "graphId", "modelId", "graphVersion", "modelVersion",
+        "seed", "stopAt", "trials", "autoDelete", "graphType", "edgeAttrs",
+        "outputDirectory", "outputHeader", "outputFormat",
+        "populationGrowth_prob", "populationGrowth_frontier" };
+    QStringList values = {
+        "0", "*10;min", "cycle", "populationGrowth", "1", "2",
+        "0", "10", "1", "true", "undirected", "",
+        QDir::tempPath(), "count_nodes_infected_true", "binary",
+        "0.5", "false" };
+    const int outputHeader = header.indexOf("outputHeader");
+    const int outputFormat = header.indexOf("outputFormat");
+
+    // the built-in functions are always numeric
+    QString error;
+    ExpInputsPtr inputs = ExpInputs::parse(m_mainApp, header, values, error);
+    QVERIFY(inputs);
+    QVERIFY(!error.contains("missing or invalid"));
+    QCOMPARE(inputs->fileCaches().size(), size_t(1));
+
+    // but the custom outputs might not be
+    values[outputHeader] = "count_nodes_infected_true;custom_infected";
+    error.clear();
+    inputs = ExpInputs::parse(m_mainApp, header, values, error);
+    QVERIFY(inputs);
+    QVERIFY(error.contains("binary"));
+    QVERIFY(error.contains(OUTPUT_FORMAT));
+
+    values[outputFormat] = "csv";
+    error.clear();
+    inputs = ExpInputs::parse(m_mainApp, header, values, error);
+    QVERIFY(inputs);
+    QVERIFY(!error.contains("missing or invalid"));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestExpInputs)
+#include "tst_expinputs.moc"
@@ -0,0 +1,110 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <vector>
+
+#include <core/memorybudget.h>
+
+namespace evoplex {
+class TestMemoryBudget: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_noLimit();
+    void tst_reserveCommitRelease();
+    void tst_residentSetSize();
+
+private:
+    // allocates and touches 'kbytes', so that they become resident
+    std::vector<char> allocate(qint64 kbytes) const
+    { return std::vector<char>(static_cast<size_t>(kbytes * 1024), 1); }
+};
+
+void TestMemoryBudget::tst_noLimit()
+{
+    MemoryBudget budget;
+    QCOMPARE(budget.limit(), qint64(0));
+    QVERIFY(budget.tryReserve(1 << 30, false));
+    QVERIFY(budget.tryReserve(1 << 30, false));
+    QCOMPARE(budget.numReservations(), 2);
+
+    budget.setLimit(-1);
+    QCOMPARE(budget.limit(), qint64(0));
+}
+
+void TestMemoryBudget::tst_reserveCommitRelease()
+{
+    // the limit is relative to the memory already in use (if it's known),
+    // leaving room for 100MB of trials
+    const qint64 base = qMax<qint64>(0, MemoryBudget::residentSetSize());
+    MemoryBudget budget;
+    budget.setLimit(base + 100000);
+
+    // the reservations are accounted until they are committed or cancelled
+    QVERIFY(budget.tryReserve(60000, false));
+    QCOMPARE(budget.numReservations(), 1);
+    QVERIFY(!budget.tryReserve(60000, false));
+    QCOMPARE(budget.numReservations(), 1);
+    QVERIFY(budget.tryReserve(60000, true)); // forced
+    QCOMPARE(budget.numReservations(), 2);
+    budget.unreserve(60000);
+    QCOMPARE(budget.numReservations(), 1);
+
+    // the committed memory is accounted until it is released
+    std::vector<char> trial = allocate(30000);
+    budget.commit(60000, 30000);
+    QCOMPARE(budget.numReservations(), 0);
+    QVERIFY(budget.tryReserve(60000, false));
+    QVERIFY(!budget.tryReserve(20000, false));
+
+    budget.release(30000);
+    std::vector<char>().swap(trial);
+    budget.unreserve(60000);
+    QCOMPARE(budget.numReservations(), 0);
+    QVERIFY(budget.tryReserve(90000, false));
+}
+
+void TestMemoryBudget::tst_residentSetSize()
+{
+    if (MemoryBudget::residentSetSize() <= 0) {
+        QSKIP("the resident set size is unknown in this platform");
+    }
+
+    const qint64 base = MemoryBudget::residentSetSize();
+    MemoryBudget budget;
+    budget.setLimit(base + 100000);
+    QVERIFY(budget.tryReserve(10000, false));
+
+    // the trial uses three times its estimate, so the new reservation
+    // is scaled up as well: 30MB + 3 * 30MB does not fit
+    std::vector<char> trial = allocate(30000);
+    budget.commit(10000, 10000);
+    QVERIFY(!budget.tryReserve(30000, false));
+    QVERIFY(budget.tryReserve(10000, false));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestMemoryBudget)
+#include "tst_memorybudget.moc"
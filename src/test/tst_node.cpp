@@ -22,7 +22,10 @@
 #include <QtTest>
 #include <QStringList>
 
+#include <set>
+
 #include <core/include/node.h>
+#include <core/edge_p.h>
 #include <core/node_p.h>
 
 namespace evoplex {
@@ -34,6 +37,7 @@ private slots:
     void initTestCase() {}
     void cleanupTestCase() {}
     void tst_Node();
+    void tst_randNeighbour();
 
 private:
     BaseNode::constructor_key key;
@@ -132,6 +136,44 @@ void TestNode::tst_Node()
     tests(dnode.get());
 }
 
+void TestNode::tst_randNeighbour()
+{
+    auto prg = std::unique_ptr<PRG>(new PRG(0));
+    auto tests = [this, &prg](NodePtr origin) {
+        Node originNode(origin);
+        std::vector<Node> neighbours;
+        neighbours.reserve(5); // the edges hold references to these nodes
+        BaseEdge::constructor_key ek;
+        for (int i = 1; i <= 5; ++i) {
+            neighbours.emplace_back(NodePtr(std::make_shared<UNode>(key, i, Attributes())));
+            const Node& n = neighbours.back();
+            static_cast<NodeInterface*>(origin.get())->addOutEdge(
+                    Edge(std::make_shared<BaseEdge>(ek, i, originNode, n)));
+        }
+        QCOMPARE(origin->outDegree(), 5);
+
+        // removing edges must keep the remaining neighbours reachable
+        static_cast<NodeInterface*>(origin.get())->removeOutEdge(2);
+        static_cast<NodeInterface*>(origin.get())->removeOutEdge(4);
+        QCOMPARE(origin->outDegree(), 3);
+
+        std::set<int> picked;
+        for (int i = 0; i < 100; ++i) {
+            Node n = origin->randNeighbour(prg.get());
+            QVERIFY(!n.isNull());
+            picked.insert(n.id());
+        }
+        QVERIFY(picked == std::set<int>({1, 3, 5}));
+
+        static_cast<NodeInterface*>(origin.get())->clearOutEdges();
+        QCOMPARE(origin->outDegree(), 0);
+        QVERIFY(origin->randNeighbour(prg.get()).isNull());
+    };
+
+    tests(std::make_shared<UNode>(key, 0, Attributes()));
+    tests(std::make_shared<DNode>(key, 0, Attributes()));
+}
+
 } // evoplex
 QTEST_MAIN(evoplex::TestNode)
 #include "tst_node.moc"
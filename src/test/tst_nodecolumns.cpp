@@ -0,0 +1,209 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include <core/include/attributerange.h>
+#include <core/include/nodecolumns.h>
+#include <core/include/stats.h>
+#include <core/nodes_p.h>
+
+namespace evoplex {
+class TestNodeColumns: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() {}
+    void tst_get();
+    void tst_sync();
+    void tst_count();
+    void tst_buffers();
+    void tst_invalidate();
+
+private:
+    AttributesScope m_attrsScope;
+    Nodes m_nodes;
+};
+
+void TestNodeColumns::initTestCase()
+{
+    auto a = AttributeRange::parse(0, "a", "int[0,10]");
+    auto b = AttributeRange::parse(1, "b", "double[0,1]");
+    auto c = AttributeRange::parse(2, "c", "bool");
+    m_attrsScope.insert(a->attrName(), a);
+    m_attrsScope.insert(b->attrName(), b);
+    m_attrsScope.insert(c->attrName(), c);
+
+    QString error;
+    m_nodes = NodesPrivate::fromCmd("*10;max", m_attrsScope, GraphType::Undirected, error);
+    QCOMPARE(m_nodes.size(), size_t(10));
+}
+
+void TestNodeColumns::tst_get()
+{
+    NodeColumns columns;
+    QVERIFY(columns.empty());
+    QVERIFY(!columns.find(0));
+
+    // invalid attribute id or type
+    QVERIFY(!columns.get<int>(m_nodes, -1));
+    QVERIFY(!columns.get<int>(m_nodes, 3));
+    QVERIFY(!columns.get<double>(m_nodes, 0));
+    QVERIFY(!columns.get<int>(Nodes(), 0));
+    QVERIFY(columns.empty());
+
+    NodeColumn<int>* colA = columns.get<int>(m_nodes, 0);
+    QVERIFY(colA);
+    QCOMPARE(colA->attrId(), 0);
+    QCOMPARE(colA->size(), 10);
+    QCOMPARE(colA->type(), Value::INT);
+    QVERIFY(!colA->isModified());
+    for (int i = 0; i < colA->size(); ++i) {
+        QCOMPARE(colA->get(i), 10);
+    }
+
+    // the same column is returned; but not for another type
+    QCOMPARE(columns.get<int>(m_nodes, 0), colA);
+    QCOMPARE(columns.find(0), colA);
+    QVERIFY(!columns.get<bool>(m_nodes, 0));
+
+    NodeColumn<double>* colB = columns.get<double>(m_nodes, 1);
+    QVERIFY(colB);
+    QCOMPARE(colB->constData()[9], 1.0);
+}
+
+void TestNodeColumns::tst_sync()
+{
+    Nodes nodes = NodesPrivate::clone(m_nodes);
+    NodeColumns columns;
+    NodeColumn<int>* colA = columns.get<int>(nodes, 0);
+    NodeColumn<bool>* colC = columns.get<bool>(nodes, 2);
+    QVERIFY(colA && colC);
+
+    colA->set(3, 7);
+    QVERIFY(colA->isModified());
+    QVERIFY(!colC->isModified());
+    QCOMPARE(nodes.atIndex(3).attr(0), Value(10)); // not synced yet
+
+    columns.sync(nodes);
+    QVERIFY(!colA->isModified());
+    QCOMPARE(nodes.atIndex(3).attr(0), Value(7));
+    QCOMPARE(nodes.atIndex(2).attr(0), Value(10));
+
+    bool* data = colC->data();
+    QVERIFY(colC->isModified());
+    data[0] = false;
+    columns.sync(nodes);
+    QCOMPARE(nodes.atIndex(0).attr(2), Value(false));
+
+    // changes made directly to the nodes are seen after reloading
+    Node n = nodes.atIndex(5);
+    n.setAttr(0, Value(1));
+    QCOMPARE(colA->get(5), 10);
+    columns.reload(nodes);
+    QCOMPARE(colA->get(5), 1);
+    QCOMPARE(colA->get(3), 7);
+
+    // the original nodes are not affected
+    QCOMPARE(m_nodes.atIndex(3).attr(0), Value(10));
+}
+
+void TestNodeColumns::tst_count()
+{
+    NodeColumns columns;
+    NodeColumn<int>* colA = columns.get<int>(m_nodes, 0);
+    QVERIFY(colA);
+    colA->set(0, 2);
+    colA->set(1, 2);
+    colA->set(2, 5);
+
+    std::vector<Value> header = { Value(2), Value(10), Value(3), Value(5.0) };
+    std::vector<Value> expected = { Value(2), Value(7), Value(0), Value(0) };
+    QVERIFY(Stats::count(*colA, header) == expected);
+}
+
+void TestNodeColumns::tst_buffers()
+{
+    Nodes nodes = NodesPrivate::clone(m_nodes);
+    NodeColumns columns;
+    NodeColumn<int>* colA = columns.get<int>(nodes, 0);
+    QVERIFY(colA && !colA->isDoubleBuffered());
+    QCOMPARE(columns.getBuffered<int>(nodes, 0), colA);
+    QVERIFY(colA->isDoubleBuffered());
+
+    // nothing is swapped if the next values were not written
+    const int* current = colA->constData();
+    columns.swapBuffers();
+    QCOMPARE(colA->constData(), current);
+    QVERIFY(!colA->isModified());
+
+    int* next = colA->nextData();
+    for (int i = 0; i < colA->size(); ++i) {
+        next[i] = i;
+    }
+    QCOMPARE(colA->get(4), 10);
+    columns.swapBuffers();
+    QCOMPARE(colA->constData(), next);
+    QVERIFY(colA->isModified());
+    QCOMPARE(colA->get(4), 4);
+
+    colA->setNext(4, 5);
+    columns.swapBuffers();
+    QCOMPARE(colA->constData(), current);
+    QCOMPARE(colA->get(4), 5);
+
+    columns.sync(nodes);
+    QCOMPARE(nodes.atIndex(4).attr(0), Value(5));
+}
+
+void TestNodeColumns::tst_invalidate()
+{
+    Nodes nodes = NodesPrivate::clone(m_nodes);
+    NodeColumns columns;
+    NodeColumn<int>* colA = columns.get<int>(nodes, 0);
+    QVERIFY(colA && !columns.isStale());
+    colA->set(9, 3);
+
+    // the changes are written back before the set of nodes changes
+    columns.invalidate(nodes);
+    QVERIFY(columns.isStale());
+    QCOMPARE(nodes.atIndex(9).attr(0), Value(3));
+    QVERIFY(!columns.find(0));
+    colA->set(9, 4);
+    columns.invalidate(nodes); // no-op
+    columns.swapBuffers(); // no-op
+    columns.sync(nodes); // no-op
+    QCOMPARE(nodes.atIndex(9).attr(0), Value(3));
+
+    // reloaded on demand (e.g., from a smaller set of nodes)
+    QString error;
+    Nodes fewer = NodesPrivate::fromCmd("*9;min", m_attrsScope, GraphType::Undirected, error);
+    QCOMPARE(columns.get<int>(fewer, 0), colA);
+    QVERIFY(!columns.isStale());
+    QCOMPARE(colA->size(), 9);
+    QCOMPARE(columns.find(0), colA);
+    QCOMPARE(colA->get(8), 0);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestNodeColumns)
+#include "tst_nodecolumns.moc"
@@ -19,6 +19,7 @@
  */
 
 #include <QtTest>
+#include <QDataStream>
 #include <QDir>
 #include <QStringList>
 
@@ -43,6 +44,10 @@ private slots:
     void tst_saveToFile_no_attrs();
     // saving a set of nodes with attributes
     void tst_saveToFile_with_attrs();
+    // writing/reading a set of nodes to/from a binary stream
+    void tst_writeNodes();
+    // the clones share the attributes' values until they are changed
+    void tst_clone();
 
     // file with valid attributes, file without 2d coordinates
     void tst_fromFile_nodes_no_xy();
@@ -556,6 +561,79 @@ void TestNodes::tst_saveToFile_with_attrs()
     QVERIFY(nodesOfSameType<DNode>(nodesFromFile));
 }
 
+void TestNodes::tst_writeNodes()
+{
+    QString errorMsg;
+    AttributesScope attrsScope;
+    auto col0 = AttributeRange::parse(0, "test0", "int[0,1000]");
+    attrsScope.insert(col0->attrName(), col0);
+    auto col1 = AttributeRange::parse(1, "test1", "double[0,1]");
+    attrsScope.insert(col1->attrName(), col1);
+
+    for (GraphType graphType : { GraphType::Undirected, GraphType::Directed }) {
+        Nodes nodes = NodesPrivate::fromCmd("*10;rand_123", attrsScope, graphType, errorMsg);
+        nodes.at(3).setCoords(1.5f, -2.f);
+
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        NodesPrivate::writeNodes(nodes, out);
+
+        QDataStream in(data);
+        Nodes nodesFromStream = NodesPrivate::readNodes(in, graphType, errorMsg);
+        QVERIFY(errorMsg.isEmpty());
+        _compare_nodes(nodes, nodesFromStream);
+        // the nodes must be in the same order
+        for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+            QCOMPARE(nodesFromStream.atIndex(i).id(), nodes.atIndex(i).id());
+        }
+        if (graphType == GraphType::Undirected) {
+            QVERIFY(nodesOfSameType<UNode>(nodesFromStream));
+        } else {
+            QVERIFY(nodesOfSameType<DNode>(nodesFromStream));
+        }
+
+        // a truncated stream must fail
+        QDataStream truncated(data.left(data.size() / 2));
+        QVERIFY(NodesPrivate::readNodes(truncated, graphType, errorMsg).empty());
+        QVERIFY(!errorMsg.isEmpty());
+        errorMsg.clear();
+    }
+}
+
+void TestNodes::tst_clone()
+{
+    QString errorMsg;
+    AttributesScope attrsScope;
+    auto col0 = AttributeRange::parse(0, "test0", "int[0,1000]");
+    attrsScope.insert(col0->attrName(), col0);
+
+    for (GraphType graphType : { GraphType::Undirected, GraphType::Directed }) {
+        Nodes nodes = NodesPrivate::fromCmd("*10;rand_123", attrsScope, graphType, errorMsg);
+        Nodes clones = NodesPrivate::clone(nodes);
+        _compare_nodes(nodes, clones);
+        if (graphType == GraphType::Undirected) {
+            QVERIFY(nodesOfSameType<UNode>(clones));
+        } else {
+            QVERIFY(nodesOfSameType<DNode>(clones));
+        }
+        for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+            QCOMPARE(clones.atIndex(i).id(), nodes.atIndex(i).id());
+            QVERIFY(clones.atIndex(i).m_ptr != nodes.atIndex(i).m_ptr);
+            QCOMPARE(&clones.atIndex(i).attrs().values(), &nodes.atIndex(i).attrs().values());
+        }
+
+        const Value original = nodes.at(2).attr(0);
+        clones.at(2).setAttr(0, Value(1001));
+        QCOMPARE(nodes.at(2).attr(0), original);
+        QCOMPARE(clones.at(2).attr(0), Value(1001));
+        QVERIFY(&clones.at(2).attrs().values() != &nodes.at(2).attrs().values());
+
+        // the clones outlive the original nodes
+        nodes = Nodes();
+        QCOMPARE(clones.at(2).attr(0), Value(1001));
+    }
+}
+
 void TestNodes::_compare_nodes(const Nodes& a, const Nodes& b) const
 {
     QCOMPARE(a.size(), b.size());
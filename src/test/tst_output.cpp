@@ -0,0 +1,181 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+
+#include <core/output.h>
+
+namespace evoplex {
+
+// an output whose values are given by the test
+class TestingOutput : public Output
+{
+public:
+    void doOperation(const Trial*) override {}
+    bool operator==(const OutputPtr) const override { return false; }
+    void push(int trialId, int step, const Values& allValues)
+    { updateCaches(trialId, step, allValues); }
+};
+
+class TestOutput: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_cache();
+    void tst_cacheBlocks();
+    void tst_cacheCapacity();
+
+private:
+    // pushes 'n' rows to the trial 0, with the step 's' holding 's' and '-s'
+    void push(TestingOutput* output, int first, int n);
+};
+
+void TestOutput::push(TestingOutput* output, int first, int n)
+{
+    for (int step = first; step < first + n; ++step) {
+        // the inputs are sorted: -1 ("a") and 1 ("b")
+        output->push(0, step, {Value(-step), Value(step)});
+    }
+}
+
+void TestOutput::tst_cache()
+{
+    auto output = std::make_shared<TestingOutput>();
+    Cache* cache = output->addCache({Value(1)}, {0});
+    Cache* both = output->addCache({Value(1), Value(-1)}, {0});
+    QCOMPARE(output->allInputs(), Values({Value(-1), Value(1)}));
+    QVERIFY(cache->isEmpty(0));
+    QVERIFY(!cache->isEmpty(1)); // no such trial
+
+    // spans a few blocks, and the reads interleave with the writes
+    int next = 0;
+    for (int round = 0; round < 4; ++round) {
+        push(output.get(), round * 300, 300);
+        while (!cache->isEmpty(0)) {
+            QCOMPARE(cache->frontStep(0), next);
+            QCOMPARE(cache->frontValue(0, 0), Value(next));
+            Values row;
+            both->readFrontRow(0, row);
+            QCOMPARE(row, Values({Value(next), Value(-next)}));
+            cache->flushFrontRow(0);
+            both->flushFrontRow(0);
+            ++next;
+        }
+    }
+    QCOMPARE(next, 1200);
+    QVERIFY(both->isEmpty(0));
+
+    push(output.get(), 0, 10);
+    output->flushAll();
+    QVERIFY(cache->isEmpty(0));
+    QVERIFY(both->isEmpty(0));
+}
+
+void TestOutput::tst_cacheBlocks()
+{
+    auto output = std::make_shared<TestingOutput>();
+    Cache* cache = output->addCache({Value(-1), Value(1)}, {0});
+    const Cache::Data* data = cache->m_trials.at(0);
+    const int n = Cache::BLOCK_ROWS;
+
+    // a full block and the first row of the next one
+    push(output.get(), 0, n);
+    const Cache::Block* first = data->tail;
+    QCOMPARE(data->head, first);
+    push(output.get(), n, 1);
+    const Cache::Block* second = data->tail;
+    QVERIFY(second != first);
+    QCOMPARE(data->head, first);
+    QVERIFY(!data->spare.load());
+
+    // the first block is kept once it has been read
+    int next = 0;
+    for (; next <= n; ++next) {
+        QCOMPARE(cache->frontStep(0), next);
+        QCOMPARE(cache->frontValue(0, 1), Value(next));
+        cache->flushFrontRow(0);
+    }
+    QVERIFY(cache->isEmpty(0));
+    QCOMPARE(data->head, second);
+    QCOMPARE(data->spare.load(), first);
+
+    // and reused when the second one is full
+    push(output.get(), n + 1, n - 1);
+    QCOMPARE(data->tail, second);
+    push(output.get(), 2 * n, 1);
+    QCOMPARE(data->tail, first);
+    QVERIFY(!data->spare.load());
+
+    // so, as long as the rows are read, no other block is allocated
+    for (int round = 0; round < 16; ++round) {
+        push(output.get(), 2 * n + 1 + round * n / 2, n / 2);
+        while (!cache->isEmpty(0)) {
+            QCOMPARE(cache->frontStep(0), next);
+            Values row;
+            cache->readFrontRow(0, row);
+            QCOMPARE(row, Values({Value(-next), Value(next)}));
+            cache->flushFrontRow(0);
+            QVERIFY(data->head == first || data->head == second);
+            ++next;
+        }
+        QVERIFY(data->tail == first || data->tail == second);
+    }
+    QCOMPARE(next, 10 * n + 1);
+}
+
+void TestOutput::tst_cacheCapacity()
+{
+    auto output = std::make_shared<TestingOutput>();
+    Cache* cache = output->addCache({Value(-1), Value(1)}, {0});
+    cache->setCapacity(5);
+    QCOMPARE(cache->capacity(), 5);
+
+    // only the last 5 rows are kept
+    push(output.get(), 0, 12);
+    for (int step = 7; step < 12; ++step) {
+        QVERIFY(!cache->isEmpty(0));
+        QCOMPARE(cache->frontStep(0), step);
+        Values row;
+        cache->readFrontRow(0, row);
+        QCOMPARE(row, Values({Value(-step), Value(step)}));
+        cache->flushFrontRow(0);
+    }
+    QVERIFY(cache->isEmpty(0));
+
+    // partially read, then wraps around a few times
+    push(output.get(), 12, 3);
+    QCOMPARE(cache->frontStep(0), 12);
+    cache->flushFrontRow(0);
+    push(output.get(), 15, 8);
+    for (int step = 18; step < 23; ++step) {
+        QCOMPARE(cache->frontStep(0), step);
+        QCOMPARE(cache->frontValue(0, 1), Value(step));
+        cache->flushFrontRow(0);
+    }
+    QVERIFY(cache->isEmpty(0));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestOutput)
+#include "tst_output.moc"
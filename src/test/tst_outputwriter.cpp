@@ -0,0 +1,247 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <core/binaryoutput.h>
+#include <core/boundedqueue.h>
+#include <core/outputwriter.h>
+
+namespace evoplex {
+class TestOutputWriter: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_boundedQueue();
+    void tst_concurrentQueue();
+    void tst_write();
+    void tst_writeError();
+    void tst_binaryOutput();
+};
+
+void TestOutputWriter::tst_boundedQueue()
+{
+    BoundedQueue<int> queue(5);
+    QCOMPARE(queue.capacity(), size_t(8)); // rounded up
+
+    int v = -1;
+    QVERIFY(!queue.tryPop(v));
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(queue.tryPush(i));
+    }
+    QVERIFY(!queue.tryPush(8)); // full
+
+    // FIFO, also across the laps of the ring buffer
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(queue.tryPop(v));
+        QCOMPARE(v, i);
+        QVERIFY(queue.tryPush(i + 8));
+    }
+}
+
+void TestOutputWriter::tst_concurrentQueue()
+{
+    class Producer : public QThread
+    {
+    public:
+        Producer(BoundedQueue<int>* q, int first, int n) : m_q(q), m_first(first), m_n(n) {}
+    protected:
+        void run() override {
+            for (int i = m_first; i < m_first + m_n; ++i) {
+                while (!m_q->tryPush(i)) { QThread::yieldCurrentThread(); }
+            }
+        }
+    private:
+        BoundedQueue<int>* m_q;
+        const int m_first;
+        const int m_n;
+    };
+
+    const int numProducers = 4;
+    const int n = 10000;
+    BoundedQueue<int> queue(64);
+    std::vector<std::unique_ptr<Producer>> producers;
+    for (int p = 0; p < numProducers; ++p) {
+        producers.emplace_back(new Producer(&queue, p * n, n));
+        producers.back()->start();
+    }
+
+    // each value must be popped exactly once, and the values
+    // of each producer must come out in the same order
+    std::vector<int> last(numProducers, -1);
+    std::vector<bool> seen(numProducers * n, false);
+    for (int count = 0; count < numProducers * n;) {
+        int v;
+        if (!queue.tryPop(v)) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        QVERIFY(!seen[v]);
+        seen[v] = true;
+        QVERIFY(v > last[v / n]);
+        last[v / n] = v;
+        ++count;
+    }
+
+    for (auto& p : producers) {
+        p->wait();
+    }
+    int v;
+    QVERIFY(!queue.tryPop(v));
+}
+
+void TestOutputWriter::tst_write()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    OutputWriter writer(2);
+    std::vector<OutputWriter::FilePtr> files;
+    for (int f = 0; f < 4; ++f) {
+        const QString path = dir.filePath(QString("trial_%1.csv").arg(f));
+        QFile file(path);
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write("a,b,c\n");
+        file.close();
+        files.emplace_back(writer.open(path));
+    }
+
+    QByteArray expected("a,b,c\n");
+    for (int batch = 0; batch < 50; ++batch) {
+        for (auto const& file : files) {
+            std::vector<Values> rows;
+            rows.push_back({Value(batch), Value(0.5), Value(true)});
+            rows.push_back({Value(batch + 1), Value(1.5), Value("s")});
+            writer.write(file, rows);
+        }
+        expected += QString("%1,0.5,1\n%2,1.5,s\n").arg(batch).arg(batch + 1).toUtf8();
+    }
+
+    for (auto const& file : files) {
+        QVERIFY(writer.flush(file));
+        QFile f(file->path());
+        QVERIFY(f.open(QFile::ReadOnly));
+        QCOMPARE(f.readAll(), expected);
+        QVERIFY(writer.close(file));
+    }
+}
+
+void TestOutputWriter::tst_writeError()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    OutputWriter writer(1);
+    auto file = writer.open(dir.filePath("missing/trial.csv"));
+    QVERIFY(!file->hasError());
+    writer.write(file, {{Value(1)}});
+    QVERIFY(!writer.flush(file));
+    QVERIFY(file->hasError());
+    QVERIFY(!writer.close(file));
+}
+
+void TestOutputWriter::tst_binaryOutput()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("trial.bin");
+    QFile file(path);
+    QVERIFY(file.open(QFile::WriteOnly));
+    file.write(BinaryOutput::header({"a", "b", "c"}));
+    file.close();
+
+    QString csv("a,b,c\n");
+    auto writeRows = [&csv](OutputWriter& writer, const OutputWriter::FilePtr& f,
+                            int first, int last) {
+        for (int batch = first; batch < last; batch += 100) {
+            std::vector<Values> rows;
+            std::vector<int> steps;
+            for (int i = batch; i < batch + 100; ++i) {
+                rows.push_back({Value(i), Value(i * 0.5), Value(i % 3 == 0)});
+                steps.emplace_back(i * 2);
+                csv += QString("%1,%2,%3\n").arg(rows.back()[0].toQString(),
+                        rows.back()[1].toQString(), rows.back()[2].toQString());
+            }
+            writer.write(f, rows, steps);
+        }
+    };
+
+    // the second writer appends to the blocks flushed by the first one,
+    // as when a trial is resumed
+    {
+        OutputWriter writer(1);
+        auto f = writer.open(path, OutputWriter::Binary);
+        writeRows(writer, f, 0, 5000);
+        QVERIFY(writer.flush(f));
+    }
+    {
+        OutputWriter writer(1);
+        auto f = writer.open(path, OutputWriter::Binary);
+        writeRows(writer, f, 5000, 10000);
+        QVERIFY(writer.close(f));
+    }
+
+    QString error;
+    BinaryOutputReader reader;
+    QVERIFY(reader.open(path, error));
+    QCOMPARE(reader.header(), QStringList({"a", "b", "c"}));
+    QCOMPARE(reader.numRows(), qint64(10000));
+    QVERIFY(reader.blocks().size() > 1);
+    QCOMPARE(reader.step(9999), qint64(19998));
+    QCOMPARE(reader.rowOfStep(2468), qint64(1234));
+    QCOMPARE(reader.rowOfStep(2469), qint64(-1));
+    QCOMPARE(reader.rowOfStep(-2), qint64(-1));
+    QCOMPARE(reader.value(1234, 0), Value(1234));
+    QCOMPARE(reader.value(1234, 1), Value(617.0));
+    QCOMPARE(reader.value(1234, 2), Value(false));
+
+    const QString csvPath = dir.filePath("trial.csv");
+    QVERIFY(reader.toCsv(csvPath, error));
+    QFile csvFile(csvPath);
+    QVERIFY(csvFile.open(QFile::ReadOnly));
+    QCOMPARE(QString::fromUtf8(csvFile.readAll()), csv);
+    csvFile.close();
+
+    // without the index (e.g., a crash), the complete blocks are still there
+    const qint64 lastBlock = reader.blocks().back().offset;
+    reader.close();
+    QVERIFY(QFile::resize(path, lastBlock + 100));
+    QVERIFY(reader.open(path, error));
+    QCOMPARE(reader.dataEnd(), lastBlock);
+    QVERIFY(reader.numRows() < 10000);
+    QCOMPARE(reader.step(reader.numRows() - 1), qint64(2 * (reader.numRows() - 1)));
+    reader.close();
+
+    // the binary format only takes numbers
+    OutputWriter writer(1);
+    auto f = writer.open(path, OutputWriter::Binary);
+    writer.write(f, {{Value("s"), Value(1), Value(2)}}, {0});
+    QVERIFY(!writer.flush(f));
+    QVERIFY(!reader.open(dir.filePath("trial.csv"), error));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestOutputWriter)
+#include "tst_outputwriter.moc"
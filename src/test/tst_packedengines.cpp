@@ -0,0 +1,165 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <vector>
+
+#include <core/include/prg.h>
+#include <plugins/models/cellularAutomata1D/packedrule.h>
+#include <plugins/models/gameOfLife/packedlattice.h>
+
+namespace evoplex {
+
+// The bit-packed engines of the gameOfLife and cellularAutomata1D models
+// must give exactly the same results as the rules applied cell by cell.
+class TestPackedEngines: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_lattice();
+    void tst_rule();
+
+private:
+    void _tst_lattice(int width, int height, bool periodic);
+    void _tst_rule(int width, bool toroidal);
+
+    using Grid = std::vector<std::vector<bool>>;
+
+    // one generation of the Game of Life, cell by cell
+    static Grid lifeStep(const Grid& grid, bool periodic);
+    // the next row of an elementary cellular automaton, cell by cell
+    static std::vector<bool> ruleStep(int rule, const std::vector<bool>& row, bool toroidal);
+};
+
+TestPackedEngines::Grid TestPackedEngines::lifeStep(const Grid& grid, bool periodic)
+{
+    const int height = static_cast<int>(grid.size());
+    const int width = static_cast<int>(grid[0].size());
+    Grid next(grid.size(), std::vector<bool>(grid[0].size()));
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            int live = 0;
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    int nr = r + dr;
+                    int nc = c + dc;
+                    if ((dr == 0 && dc == 0) || (!periodic && (nr < 0 || nr >= height
+                            || nc < 0 || nc >= width))) {
+                        continue;
+                    }
+                    nr = (nr + height) % height;
+                    nc = (nc + width) % width;
+                    live += grid[nr][nc];
+                }
+            }
+            next[r][c] = live == 3 || (live == 2 && grid[r][c]);
+        }
+    }
+    return next;
+}
+
+std::vector<bool> TestPackedEngines::ruleStep(int rule, const std::vector<bool>& row, bool toroidal)
+{
+    const int width = static_cast<int>(row.size());
+    std::vector<bool> next(row.size());
+    for (int c = 0; c < width; ++c) {
+        bool left = c > 0 ? row[c-1] : toroidal && row[width-1];
+        bool right = c < width - 1 ? row[c+1] : toroidal && row[0];
+        const int p = (left << 2) | (row[c] << 1) | right;
+        next[c] = (rule >> p) & 1;
+    }
+    return next;
+}
+
+void TestPackedEngines::tst_lattice()
+{
+    // most widths are not multiples of 64, so the last word is partial
+    _tst_lattice(100, 30, false);
+    _tst_lattice(100, 30, true);
+    _tst_lattice(3, 3, false);
+    _tst_lattice(130, 5, true);
+    _tst_lattice(64, 8, true);
+}
+
+void TestPackedEngines::_tst_lattice(int width, int height, bool periodic)
+{
+    PRG prg(123);
+    Grid grid(static_cast<size_t>(height), std::vector<bool>(static_cast<size_t>(width)));
+    PackedLattice lattice;
+    lattice.reset(width, height, periodic);
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            grid[r][c] = prg.bernoulli(0.4);
+            lattice.set(r, c, grid[r][c]);
+        }
+    }
+
+    for (int step = 0; step < 50; ++step) {
+        grid = lifeStep(grid, periodic);
+        lattice.step();
+        for (int r = 0; r < height; ++r) {
+            for (int c = 0; c < width; ++c) {
+                QCOMPARE(lattice.get(r, c), static_cast<bool>(grid[r][c]));
+            }
+        }
+    }
+}
+
+void TestPackedEngines::tst_rule()
+{
+    _tst_rule(100, false);
+    _tst_rule(100, true);
+    _tst_rule(130, true);
+    _tst_rule(3, false);
+}
+
+void TestPackedEngines::_tst_rule(int width, bool toroidal)
+{
+    PRG prg(123);
+    for (int rule = 0; rule < 256; ++rule) {
+        std::vector<bool> row(static_cast<size_t>(width));
+        PackedRule packedRule;
+        packedRule.reset(rule, width, toroidal);
+        std::vector<quint64> packed(static_cast<size_t>(packedRule.words()), 0);
+        std::vector<quint64> next(packed.size(), 0);
+        for (int c = 0; c < width; ++c) {
+            row[c] = prg.bernoulli(0.5);
+            packed[static_cast<size_t>(c / 64)] |= quint64(row[c]) << (c % 64);
+        }
+
+        for (int step = 0; step < 20; ++step) {
+            row = ruleStep(rule, row, toroidal);
+            packedRule.apply(packed, next);
+            packed.swap(next);
+            for (int c = 0; c < width; ++c) {
+                QCOMPARE(static_cast<bool>((packed[c / 64] >> (c % 64)) & 1),
+                         static_cast<bool>(row[c]));
+            }
+        }
+    }
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestPackedEngines)
+#include "tst_packedengines.moc"
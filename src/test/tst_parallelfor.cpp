@@ -0,0 +1,272 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <vector>
+
+#include <core/experiment.h>
+#include <core/experimentsmgr.h>
+#include <core/mainapp.h>
+#include <core/nodes_p.h>
+#include <core/parallelfor.h>
+#include <core/project.h>
+#include <core/trial.h>
+#include <core/include/abstractgraph.h>
+#include <core/include/abstractmodel.h>
+
+namespace evoplex {
+
+// node i is linked to i+1 and i+7
+class PFGraph: public AbstractGraph
+{
+public:
+    PFGraph(Trial* trial, const Nodes& nodes)
+    { m_trial = trial; m_nodes = nodes; }
+
+    bool reset() override {
+        const int n = numNodes();
+        for (int i = 0; i < n; ++i) {
+            addEdge(i, (i + 1) % n);
+            addEdge(i, (i + 7) % n);
+        }
+        return true;
+    }
+};
+
+class PFModel: public AbstractModel
+{
+public:
+    explicit PFModel(Trial* trial) { m_trial = trial; }
+    bool algorithmStep() override { return true; }
+};
+
+// keeps a thread of the pool busy until it is released
+class Blocker: public QRunnable
+{
+public:
+    QSemaphore started;
+    QSemaphore release;
+    Blocker() { setAutoDelete(false); }
+    void run() override { started.release(); release.acquire(); }
+};
+
+class TestParallelFor: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void tst_chunks();
+    void tst_exactlyOnce();
+    void tst_deterministic();
+
+private:
+    MainApp* m_mainApp;
+    ExperimentPtr m_exp;
+
+    // the chunks must cover [0, size) once, in ranges of grainSize indexes
+    void chunks(QThreadPool* pool, int size, int grainSize);
+    // the trial owns the graph, the model and the PRG
+    PFModel* newTrial(Trial& trial, int numNodes);
+    // the numbers drawn for each index, node and edge, in this order
+    std::vector<int> draws(const PFModel* model, int grainSize);
+};
+
+void TestParallelFor::initTestCase()
+{
+    // the models borrow the threads of the experiments' pool
+    m_mainApp = new MainApp();
+    m_exp = std::make_shared<Experiment>(m_mainApp, 0, std::make_shared<Project>(m_mainApp, 0));
+}
+
+void TestParallelFor::cleanupTestCase()
+{
+    m_exp.reset();
+    delete m_mainApp;
+}
+
+PFModel* TestParallelFor::newTrial(Trial& trial, int numNodes)
+{
+    QString error;
+    const QString cmd = QString("*%1;min").arg(numNodes);
+    Nodes nodes = NodesPrivate::fromCmd(cmd, AttributesScope(), GraphType::Directed, error);
+    trial.m_prg = new PRG(123);
+    trial.m_graph = new PFGraph(&trial, nodes);
+    trial.m_graph->reset();
+    trial.m_graph->freezeTopology();
+    auto model = new PFModel(&trial);
+    trial.m_model = model;
+    trial.m_step = 0;
+    return model;
+}
+
+void TestParallelFor::tst_chunks()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    for (int size : {0, 1, 100, 1000}) {
+        for (int grainSize : {-5, 0, 1, 2, 3, 7, 64, size - 1, size, size + 1}) {
+            chunks(nullptr, size, grainSize);
+            chunks(&pool, size, grainSize);
+        }
+    }
+}
+
+void TestParallelFor::chunks(QThreadPool* pool, int size, int grainSize)
+{
+    const int grain = qMax(1, grainSize);
+    const int numChunks = size < 1 ? 0 : (size + grain - 1) / grain;
+
+    std::vector<QAtomicInt> visits(static_cast<size_t>(qMax(0, size)));
+    std::vector<QAtomicInt> chunkCalls(static_cast<size_t>(numChunks));
+    std::vector<std::pair<int, int>> ranges(static_cast<size_t>(numChunks));
+    QAtomicInt invalidChunks(0);
+    ParallelFor::run(pool, size, grainSize, [&](int begin, int end, int chunk) {
+        if (chunk < 0 || chunk >= numChunks || begin < 0 || end > size) {
+            invalidChunks.ref();
+            return;
+        }
+        chunkCalls[static_cast<size_t>(chunk)].ref();
+        ranges[static_cast<size_t>(chunk)] = std::make_pair(begin, end);
+        for (int i = begin; i < end; ++i) {
+            visits[static_cast<size_t>(i)].ref();
+        }
+    });
+
+    QCOMPARE(invalidChunks.load(), 0);
+    for (int c = 0; c < numChunks; ++c) {
+        QCOMPARE(chunkCalls[static_cast<size_t>(c)].load(), 1);
+        // the chunking depends only on the size and on the grain size
+        const std::pair<int, int>& range = ranges[static_cast<size_t>(c)];
+        QCOMPARE(range.first, c * grain);
+        QCOMPARE(range.second, qMin((c + 1) * grain, size));
+    }
+    for (const QAtomicInt& v : visits) {
+        QCOMPARE(v.load(), 1);
+    }
+}
+
+void TestParallelFor::tst_exactlyOnce()
+{
+    m_exp->m_graphType = GraphType::Directed;
+    Trial trial(0, m_exp);
+    const PFModel* model = newTrial(trial, 500);
+    const int numNodes = model->graph()->numNodes();
+    const int numEdges = model->graph()->numEdges();
+    m_mainApp->expMgr()->m_threadPool.setMaxThreadCount(4);
+
+    for (int grainSize : {1, 7, 64, 4096}) {
+        std::vector<QAtomicInt> indexes(1234);
+        model->parallelFor(static_cast<int>(indexes.size()), [&indexes](int i, PRG*) {
+            indexes[static_cast<size_t>(i)].ref();
+        }, grainSize);
+        for (const QAtomicInt& v : indexes) {
+            QCOMPARE(v.load(), 1);
+        }
+
+        std::vector<QAtomicInt> nodes(static_cast<size_t>(numNodes));
+        model->parallelForNodes([&nodes](const Node& node, PRG*) {
+            nodes[static_cast<size_t>(node.id())].ref();
+        }, grainSize);
+        for (const QAtomicInt& v : nodes) {
+            QCOMPARE(v.load(), 1);
+        }
+
+        std::vector<QAtomicInt> edges(static_cast<size_t>(numEdges));
+        model->parallelForEdges([&edges](const Edge& edge, PRG*) {
+            edges[static_cast<size_t>(edge.id())].ref();
+        }, grainSize);
+        for (const QAtomicInt& v : edges) {
+            QCOMPARE(v.load(), 1);
+        }
+    }
+}
+
+std::vector<int> TestParallelFor::draws(const PFModel* model, int grainSize)
+{
+    const int size = 777;
+    const int numNodes = model->graph()->numNodes();
+    const int numEdges = model->graph()->numEdges();
+    std::vector<int> ret(static_cast<size_t>(size + numNodes + numEdges), -1);
+
+    // a few numbers per item, so that the whole stream of each chunk is used
+    auto draw = [](PRG* prg) {
+        int v = 0;
+        for (int i = 0; i < 3; ++i) {
+            v = v * 31 + prg->uniform(1000000);
+        }
+        return v;
+    };
+    model->parallelFor(size, [&](int i, PRG* prg) {
+        ret[static_cast<size_t>(i)] = draw(prg);
+    }, grainSize);
+    model->parallelForNodes([&](const Node& node, PRG* prg) {
+        ret[static_cast<size_t>(size + node.id())] = draw(prg);
+    }, grainSize);
+    model->parallelForEdges([&](const Edge& edge, PRG* prg) {
+        ret[static_cast<size_t>(size + numNodes + edge.id())] = draw(prg);
+    }, grainSize);
+    return ret;
+}
+
+void TestParallelFor::tst_deterministic()
+{
+    m_exp->m_graphType = GraphType::Directed;
+    Trial trial(0, m_exp);
+    const PFModel* model = newTrial(trial, 300);
+    QThreadPool& pool = m_mainApp->expMgr()->m_threadPool;
+
+    for (int grainSize : {1, 5, 64, 4096}) {
+        // a single thread: the only thread of the pool is busy, so the
+        // calling thread processes all chunks
+        pool.setMaxThreadCount(1);
+        Blocker blocker;
+        pool.start(&blocker);
+        blocker.started.acquire();
+        const std::vector<int> single = draws(model, grainSize);
+        blocker.release.release();
+        pool.waitForDone();
+
+        // many threads
+        pool.setMaxThreadCount(8);
+        const std::vector<int> multi = draws(model, grainSize);
+        QCOMPARE(multi, single);
+        for (int v : single) {
+            QVERIFY(v >= 0);
+        }
+
+        // the streams depend on the step, but not on the previous calls
+        QCOMPARE(draws(model, grainSize), single);
+        trial.m_step = 1;
+        QVERIFY(draws(model, grainSize) != single);
+        trial.m_step = 0;
+    }
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestParallelFor)
+#include "tst_parallelfor.moc"
@@ -0,0 +1,121 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include <core/include/prg.h>
+#include <core/include/ratetree.h>
+
+namespace evoplex {
+class TestRateTree: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_empty();
+    void tst_setRate();
+    void tst_find();
+    void tst_distribution();
+};
+
+void TestRateTree::tst_empty()
+{
+    RateTree tree;
+    QCOMPARE(tree.size(), 0);
+    QCOMPARE(tree.total(), 0.0);
+    QCOMPARE(tree.find(0.0), -1);
+
+    tree.reset(5);
+    QCOMPARE(tree.size(), 5);
+    QCOMPARE(tree.total(), 0.0);
+    QCOMPARE(tree.find(0.5), -1);
+}
+
+void TestRateTree::tst_setRate()
+{
+    RateTree tree(7);
+    for (int i = 0; i < 7; ++i) {
+        tree.setRate(i, i + 1.0);
+    }
+    QCOMPARE(tree.total(), 28.0);
+    QCOMPARE(tree.rate(3), 4.0);
+
+    tree.setRate(3, 0.5);
+    QCOMPARE(tree.rate(3), 0.5);
+    QCOMPARE(tree.total(), 24.5);
+
+    tree.setRate(6, 0.0);
+    QCOMPARE(tree.total(), 17.5);
+
+    // reset clears all the rates
+    tree.reset(3);
+    QCOMPARE(tree.size(), 3);
+    QCOMPARE(tree.total(), 0.0);
+}
+
+void TestRateTree::tst_find()
+{
+    // rates: 1, 0, 2, 0, 3 -> cumulative ranges [0,1) [1,3) [3,6)
+    RateTree tree(5);
+    tree.setRate(0, 1.0);
+    tree.setRate(2, 2.0);
+    tree.setRate(4, 3.0);
+
+    QCOMPARE(tree.find(0.0), 0);
+    QCOMPARE(tree.find(0.99), 0);
+    QCOMPARE(tree.find(1.0), 2);
+    QCOMPARE(tree.find(2.99), 2);
+    QCOMPARE(tree.find(3.0), 4);
+    QCOMPARE(tree.find(5.99), 4);
+
+    // out of range values (e.g., rounding errors) never pick an empty item
+    QCOMPARE(tree.find(6.0), 4);
+    QCOMPARE(tree.find(100.0), 4);
+    tree.setRate(4, 0.0);
+    QCOMPARE(tree.find(100.0), 2);
+}
+
+void TestRateTree::tst_distribution()
+{
+    const int n = 10;
+    RateTree tree(n);
+    for (int i = 0; i < n; ++i) {
+        tree.setRate(i, i % 2 ? 0.0 : i + 1.0); // 1, 3, 5, 7, 9
+    }
+
+    PRG prg(0);
+    const int samples = 250000;
+    std::vector<int> hits(n, 0);
+    for (int i = 0; i < samples; ++i) {
+        ++hits[static_cast<size_t>(tree.find(prg.uniform(tree.total())))];
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const double expected = tree.rate(i) / tree.total();
+        const double actual = hits[static_cast<size_t>(i)] / static_cast<double>(samples);
+        QVERIFY(std::abs(actual - expected) < 0.01);
+    }
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestRateTree)
+#include "tst_ratetree.moc"
@@ -0,0 +1,166 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+
+#include <core/experiment.h>
+#include <core/nodes_p.h>
+#include <core/project.h>
+#include <core/sharedtopology.h>
+#include <core/trial.h>
+#include <core/include/abstractgraph.h>
+
+namespace evoplex {
+
+// a deterministic graph: each node is linked to the next
+// one and to the node 3*i+1, with the edge's index as attribute
+class RingGraph: public AbstractGraph
+{
+public:
+    RingGraph(Trial* trial, int numNodes=10);
+    bool reset() override;
+};
+
+class TestSharedTopology: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() {}
+    void tst_restore();
+    void tst_mismatch();
+
+private:
+    ExperimentPtr m_exp;
+
+    void compare(const AbstractGraph& graph, const AbstractGraph& expected);
+};
+
+RingGraph::RingGraph(Trial* trial, int numNodes)
+{
+    QString error;
+    m_trial = trial;
+    m_nodes = NodesPrivate::fromCmd(QString("*%1;min").arg(numNodes), AttributesScope(),
+                                    GraphType::Undirected, error);
+}
+
+bool RingGraph::reset()
+{
+    const int n = numNodes();
+    int idx = 0;
+    for (int i = 0; i < n; ++i) {
+        for (int j : {(i + 1) % n, (3 * i + 1) % n}) {
+            if (j != i) {
+                Attributes* attrs = new Attributes();
+                attrs->push_back("idx", Value(idx++));
+                addEdge(i, j, attrs);
+            }
+        }
+        node(i).setCoords(i, 2 * i);
+    }
+    return true;
+}
+
+void TestSharedTopology::initTestCase()
+{
+    // the graphs only need a trial to belong to
+    m_exp = std::make_shared<Experiment>(nullptr, 0, std::make_shared<Project>(nullptr, 0));
+}
+
+void TestSharedTopology::compare(const AbstractGraph& graph, const AbstractGraph& expected)
+{
+    // the same CSR view
+    const Topology& t = graph.topology();
+    const Topology& e = expected.topology();
+    QVERIFY(t.isValid());
+    QCOMPARE(t.numNodes(), e.numNodes());
+    for (int i = 0; i < e.numNodes(); ++i) {
+        QCOMPARE(std::vector<int>(t.outNeighbours(i).begin(), t.outNeighbours(i).end()),
+                 std::vector<int>(e.outNeighbours(i).begin(), e.outNeighbours(i).end()));
+        QCOMPARE(std::vector<int>(t.inNeighbours(i).begin(), t.inNeighbours(i).end()),
+                 std::vector<int>(e.inNeighbours(i).begin(), e.inNeighbours(i).end()));
+        QCOMPARE(graph.nodes().atIndex(i).x(), expected.nodes().atIndex(i).x());
+        QCOMPARE(graph.nodes().atIndex(i).y(), expected.nodes().atIndex(i).y());
+    }
+
+    // and the same edges
+    QCOMPARE(graph.numEdges(), expected.numEdges());
+    for (auto const& p : expected.edges()) {
+        const Edge& edge = graph.edge(p.first);
+        QCOMPARE(edge.origin().id(), p.second.origin().id());
+        QCOMPARE(edge.neighbour().id(), p.second.neighbour().id());
+        QCOMPARE(edge.attr(0), p.second.attr(0));
+    }
+}
+
+void TestSharedTopology::tst_restore()
+{
+    Trial trial(0, m_exp);
+
+    RingGraph first(&trial);
+    QVERIFY(first.reset());
+    first.freezeTopology();
+    SharedTopologyPtr shared = SharedTopology::capture(&first);
+    QVERIFY(shared);
+
+    RingGraph restored(&trial);
+    QVERIFY(shared->restore(&restored));
+    // the CSR view is shared as is
+    QCOMPARE(&restored.topology(), &first.topology());
+
+    RingGraph reset(&trial);
+    QVERIFY(reset.reset());
+    reset.freezeTopology();
+    compare(restored, reset);
+
+    // a trial which changes the graph gets its own CSR view
+    restored.removeEdge(restored.edge(0));
+    QVERIFY(!restored.topology().isValid());
+    QVERIFY(first.topology().isValid());
+    restored.freezeTopology();
+    QVERIFY(&restored.topology() != &first.topology());
+    QCOMPARE(restored.numEdges(), reset.numEdges() - 1);
+    compare(first, reset);
+}
+
+void TestSharedTopology::tst_mismatch()
+{
+    Trial trial(0, m_exp);
+
+    RingGraph first(&trial);
+    QVERIFY(first.reset());
+    first.freezeTopology();
+    SharedTopologyPtr shared = SharedTopology::capture(&first);
+
+    // the graph must have no edges
+    RingGraph other(&trial);
+    QVERIFY(other.reset());
+    QVERIFY(!shared->restore(&other));
+
+    // and the same nodes
+    RingGraph fewer(&trial, 9);
+    QVERIFY(!shared->restore(&fewer));
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestSharedTopology)
+#include "tst_sharedtopology.moc"
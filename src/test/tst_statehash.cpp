@@ -0,0 +1,239 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include <core/nodes_p.h>
+#include <core/statehash.h>
+
+namespace evoplex {
+class TestStateHash: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_stateHash();
+    void tst_columns();
+    void tst_hashedColumns();
+    void tst_cycleDetector();
+
+private:
+    Nodes newNodes(const std::vector<int>& states);
+};
+
+Nodes TestStateHash::newNodes(const std::vector<int>& states)
+{
+    AttributesScope attrsScope;
+    attrsScope.insert("state", AttributeRange::parse(0, "state", "int[0,10]"));
+    QString error;
+    Nodes nodes = NodesPrivate::fromCmd(QString("*%1;min").arg(states.size()),
+                                        attrsScope, GraphType::Undirected, error);
+    for (size_t i = 0; i < states.size(); ++i) {
+        nodes.at(static_cast<int>(i)).setAttr(0, Value(states[i]));
+    }
+    return nodes;
+}
+
+void TestStateHash::tst_stateHash()
+{
+    Nodes nodes = newNodes({0, 1, 2, 3});
+    StateHash hash;
+    hash.attach(nodes);
+    const quint64 initial = hash.value();
+
+    // the same state gives the same hash
+    StateHash other;
+    Nodes sameNodes = newNodes({0, 1, 2, 3});
+    other.attach(sameNodes);
+    QCOMPARE(other.value(), initial);
+
+    // changes are tracked incrementally
+    nodes.at(1).setAttr(0, Value(5));
+    QVERIFY(hash.value() != initial);
+    StateHash fresh;
+    Nodes changedNodes = newNodes({0, 5, 2, 3});
+    fresh.attach(changedNodes);
+    QCOMPARE(hash.value(), fresh.value());
+
+    // the hash depends on which node holds each value
+    Nodes swapped = newNodes({1, 0, 2, 3});
+    other.attach(swapped);
+    QVERIFY(other.value() != initial);
+
+    // undoing the change restores the hash
+    nodes.at(1).setAttr(0, Value(1));
+    QCOMPARE(hash.value(), initial);
+
+    // writing the same value does not change it
+    nodes.at(2).setAttr(0, Value(2));
+    QCOMPARE(hash.value(), initial);
+
+    // detached nodes are not tracked
+    hash.detach(nodes);
+    nodes.at(3).setAttr(0, Value(7));
+    QCOMPARE(hash.value(), initial);
+}
+
+void TestStateHash::tst_columns()
+{
+    Nodes nodes = newNodes({0, 1, 2, 3});
+    StateHash hash;
+    hash.attach(nodes);
+    const quint64 initial = hash.value();
+
+    NodeColumns columns;
+    NodeColumn<int>* col = columns.get<int>(nodes, 0);
+    QVERIFY(col);
+    QCOMPARE(hash.value(nodes, columns), initial);
+
+    // the changes in the column are seen before the nodes are synced
+    col->set(1, 5);
+    const quint64 changed = hash.value(nodes, columns);
+    QVERIFY(changed != initial);
+    QCOMPARE(hash.value(), initial);
+    columns.sync(nodes);
+    QCOMPARE(hash.value(), changed);
+    QCOMPARE(hash.value(nodes, columns), changed);
+
+    // and undone after being synced
+    col->set(1, 1);
+    col->set(3, 7);
+    QVERIFY(hash.value(nodes, columns) != changed);
+    col->set(3, 3);
+    QCOMPARE(hash.value(nodes, columns), initial);
+    columns.sync(nodes);
+    QCOMPARE(hash.value(), initial);
+
+    // the same as the hash of the nodes with the same state
+    col->set(0, 9);
+    col->set(2, 8);
+    StateHash other;
+    Nodes sameNodes = newNodes({9, 1, 8, 3});
+    other.attach(sameNodes);
+    QCOMPARE(hash.value(nodes, columns), other.value());
+    columns.sync(nodes);
+    QCOMPARE(hash.value(), other.value());
+    hash.detach(nodes);
+}
+
+void TestStateHash::tst_hashedColumns()
+{
+    Nodes nodes = newNodes({0, 1, 2, 3});
+    Nodes plainNodes = newNodes({0, 1, 2, 3});
+    StateHash hash, plainHash;
+    hash.attach(nodes);
+    plainHash.attach(plainNodes);
+    const quint64 initial = hash.value();
+
+    // the hashed columns must give the same values as the ones
+    // which scan all nodes
+    NodeColumns columns, plainColumns;
+    columns.setHashed(nodes, true);
+    NodeColumn<int>* col = columns.getBuffered<int>(nodes, 0);
+    NodeColumn<int>* plainCol = plainColumns.getBuffered<int>(plainNodes, 0);
+    QVERIFY(col && col->isHashed());
+    QVERIFY(plainCol && !plainCol->isHashed());
+    QCOMPARE(hash.value(nodes, columns), plainHash.value(plainNodes, plainColumns));
+
+    // the column is hashed once after being loaded, and then
+    // set() updates the hash without scanning the column
+    col->set(1, 5);
+    plainCol->set(1, 5);
+    QCOMPARE(hash.value(nodes, columns), plainHash.value(plainNodes, plainColumns));
+    col->set(1, 1);
+    plainCol->set(1, 1);
+    QVERIFY(col->m_hashValid);
+    QCOMPARE(hash.value(nodes, columns), plainHash.value(plainNodes, plainColumns));
+
+    // and so do the next values, once they are swapped
+    for (int i = 0; i < 4; ++i) {
+        col->setNext(i, 9 - i);
+        plainCol->setNext(i, 9 - i);
+    }
+    columns.swapBuffers();
+    plainColumns.swapBuffers();
+    QVERIFY(col->m_hashValid);
+    QCOMPARE(hash.value(nodes, columns), plainHash.value(plainNodes, plainColumns));
+    columns.sync(nodes);
+    plainColumns.sync(plainNodes);
+    QCOMPARE(hash.value(), plainHash.value());
+
+    // the values written through a pointer are hashed again
+    int* next = col->nextData();
+    int* plainNext = plainCol->nextData();
+    for (int i = 0; i < 4; ++i) {
+        next[i] = plainNext[i] = i % 2;
+    }
+    columns.swapBuffers();
+    plainColumns.swapBuffers();
+    QVERIFY(!col->m_hashValid);
+    QCOMPARE(hash.value(nodes, columns), plainHash.value(plainNodes, plainColumns));
+    col->data()[2] = 7;
+    plainCol->data()[2] = 7;
+    col->set(3, 4);
+    plainCol->set(3, 4);
+    QCOMPARE(hash.value(nodes, columns), plainHash.value(plainNodes, plainColumns));
+    QVERIFY(col->m_hashValid);
+
+    // the same state is found again
+    for (int i = 0; i < 4; ++i) {
+        col->set(i, i);
+    }
+    QCOMPARE(hash.value(nodes, columns), initial);
+    hash.detach(nodes);
+    plainHash.detach(plainNodes);
+}
+
+void TestStateHash::tst_cycleDetector()
+{
+    // fixed point
+    CycleDetector fixedPoint(1);
+    QCOMPARE(fixedPoint.push(0, 10), 0);
+    QCOMPARE(fixedPoint.push(1, 11), 0);
+    QCOMPARE(fixedPoint.push(2, 11), 1);
+
+    // a cycle of period 3 is not found when the max period is 2
+    CycleDetector shortWindow(2);
+    for (int step = 0; step < 12; ++step) {
+        QCOMPARE(shortWindow.push(step, static_cast<quint64>(step % 3)), 0);
+    }
+
+    // but it is found after three steps otherwise
+    CycleDetector detector(3);
+    QCOMPARE(detector.push(0, 100), 0);
+    QCOMPARE(detector.push(1, 0), 0);
+    QCOMPARE(detector.push(2, 1), 0);
+    QCOMPARE(detector.push(3, 2), 0);
+    QCOMPARE(detector.push(4, 0), 3);
+
+    // states older than the max period are forgotten
+    CycleDetector window(2);
+    QCOMPARE(window.push(0, 7), 0);
+    QCOMPARE(window.push(1, 8), 0);
+    QCOMPARE(window.push(2, 9), 0);
+    QCOMPARE(window.push(3, 7), 0);
+    QCOMPARE(window.push(4, 9), 2);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestStateHash)
+#include "tst_statehash.moc"
@@ -0,0 +1,125 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+
+#include <core/include/topology.h>
+#include <core/edge_p.h>
+#include <core/node_p.h>
+#include <core/nodes_p.h>
+
+namespace evoplex {
+class TestTopology: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_undirected();
+    void tst_directed();
+
+private:
+    void addEdge(int id, const Node& origin, const Node& neighbour);
+    void compare(Topology::Span span, const Nodes& nodes, std::vector<int> ids);
+};
+
+void TestTopology::addEdge(int id, const Node& origin, const Node& neighbour)
+{
+    BaseEdge::constructor_key k;
+    Attributes* attrs = new Attributes();
+    Edge out(std::make_shared<BaseEdge>(k, id, origin, neighbour, attrs, true));
+    Edge in(std::make_shared<BaseEdge>(k, id, neighbour, origin, attrs, false));
+    static_cast<NodeInterface*>(origin.m_ptr.get())->addOutEdge(out);
+    static_cast<NodeInterface*>(neighbour.m_ptr.get())->addInEdge(in);
+}
+
+void TestTopology::compare(Topology::Span span, const Nodes& nodes, std::vector<int> ids)
+{
+    QCOMPARE(span.size(), static_cast<int>(ids.size()));
+    for (int i = 0; i < span.size(); ++i) {
+        QCOMPARE(nodes.atIndex(span[i]).id(), ids[static_cast<size_t>(i)]);
+    }
+}
+
+void TestTopology::tst_undirected()
+{
+    QString error;
+    Nodes nodes = NodesPrivate::fromCmd("*4;min", AttributesScope(), GraphType::Undirected, error);
+    QCOMPARE(nodes.size(), size_t(4));
+
+    Topology topology;
+    QVERIFY(!topology.isValid());
+    QCOMPARE(topology.numNodes(), 0);
+
+    // 0-1, 0-2, 2-3
+    addEdge(0, nodes.at(0), nodes.at(1));
+    addEdge(1, nodes.at(0), nodes.at(2));
+    addEdge(2, nodes.at(2), nodes.at(3));
+
+    topology.build(nodes, false);
+    QVERIFY(topology.isValid());
+    QCOMPARE(topology.numNodes(), 4);
+    for (int i = 0; i < 4; ++i) {
+        const Node& node = nodes.atIndex(i);
+        QCOMPARE(topology.outNeighbours(i).size(), node.outDegree());
+        QCOMPARE(topology.inNeighbours(i).begin(), topology.outNeighbours(i).begin());
+    }
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(0))), nodes, {1, 2});
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(1))), nodes, {0});
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(2))), nodes, {0, 3});
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(3))), nodes, {2});
+
+    topology.clear();
+    QVERIFY(!topology.isValid());
+    QCOMPARE(topology.numNodes(), 0);
+}
+
+void TestTopology::tst_directed()
+{
+    QString error;
+    Nodes nodes = NodesPrivate::fromCmd("*4;min", AttributesScope(), GraphType::Directed, error);
+    QCOMPARE(nodes.size(), size_t(4));
+
+    // 0->1, 0->2, 2->0, 3->2
+    addEdge(0, nodes.at(0), nodes.at(1));
+    addEdge(1, nodes.at(0), nodes.at(2));
+    addEdge(2, nodes.at(2), nodes.at(0));
+    addEdge(3, nodes.at(3), nodes.at(2));
+
+    Topology topology;
+    topology.build(nodes, true);
+    QVERIFY(topology.isValid());
+    QCOMPARE(topology.numNodes(), 4);
+
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(0))), nodes, {1, 2});
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(1))), nodes, {});
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(2))), nodes, {0});
+    compare(topology.outNeighbours(nodes.indexOf(nodes.at(3))), nodes, {2});
+
+    compare(topology.inNeighbours(nodes.indexOf(nodes.at(0))), nodes, {2});
+    compare(topology.inNeighbours(nodes.indexOf(nodes.at(1))), nodes, {0});
+    compare(topology.inNeighbours(nodes.indexOf(nodes.at(2))), nodes, {0, 3});
+    compare(topology.inNeighbours(nodes.indexOf(nodes.at(3))), nodes, {});
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestTopology)
+#include "tst_topology.moc"
@@ -0,0 +1,143 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <core/trialsaggregator.h>
+
+namespace evoplex {
+class TestTrialsAggregator: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {}
+    void cleanupTestCase() {}
+    void tst_stats();
+    void tst_concurrentTrials();
+    void tst_save();
+};
+
+void TestTrialsAggregator::tst_stats()
+{
+    TrialsAggregator::Stats s;
+    QCOMPARE(s.variance(), 0.);
+
+    // large offset to make sure the variance is computed in a stable way
+    const double offset = 1e9;
+    for (double x : {4., 7., 13., 16.}) {
+        s.add(offset + x);
+    }
+    QCOMPARE(s.count, quint32(4));
+    QCOMPARE(s.mean, offset + 10.);
+    QCOMPARE(s.variance(), 30.);
+    QCOMPARE(s.min, offset + 4.);
+    QCOMPARE(s.max, offset + 16.);
+}
+
+void TestTrialsAggregator::tst_concurrentTrials()
+{
+    class TrialThread : public QThread
+    {
+    public:
+        TrialThread(TrialsAggregator* a, int trialId, int numSteps)
+            : m_a(a), m_trialId(trialId), m_numSteps(numSteps) {}
+    protected:
+        void run() override {
+            // a trial hands its rows over in batches
+            for (int first = 0; first < m_numSteps; first += 10) {
+                std::vector<int> steps;
+                std::vector<Values> rows;
+                for (int step = first; step < first + 10 && step < m_numSteps; ++step) {
+                    steps.emplace_back(step);
+                    rows.push_back({Value(m_trialId), Value(step * 0.5), Value("s")});
+                }
+                m_a->add(steps, rows);
+            }
+        }
+    private:
+        TrialsAggregator* m_a;
+        const int m_trialId;
+        const int m_numSteps;
+    };
+
+    // the trial 'i' finishes at step 100+i
+    const int numTrials = 8;
+    TrialsAggregator a("", {"id", "half", "str"});
+    std::vector<std::unique_ptr<TrialThread>> trials;
+    for (int i = 0; i < numTrials; ++i) {
+        trials.emplace_back(new TrialThread(&a, i, 100 + i));
+        trials.back()->start();
+    }
+    for (auto& t : trials) {
+        t->wait();
+    }
+
+    QCOMPARE(a.numTrials(0), numTrials);
+    QCOMPARE(a.numTrials(99), numTrials);
+    QCOMPARE(a.numTrials(104), 3);
+    QCOMPARE(a.numTrials(200), 0);
+
+    const TrialsAggregator::Stats id = a.stats(50, 0);
+    QCOMPARE(id.count, quint32(numTrials));
+    QCOMPARE(id.mean, 3.5);
+    QCOMPARE(id.variance(), 6.0);
+    QCOMPARE(id.min, 0.);
+    QCOMPARE(id.max, 7.);
+
+    const TrialsAggregator::Stats half = a.stats(50, 1);
+    QCOMPARE(half.mean, 25.);
+    QCOMPARE(half.variance(), 0.);
+
+    // non-numeric values are ignored
+    QCOMPARE(a.stats(50, 2).count, quint32(0));
+}
+
+void TestTrialsAggregator::tst_save()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TrialsAggregator a(dir.filePath("avg.csv"), {"x"});
+    a.add({0, 1}, {{Value(1)}, {Value(2)}});
+    a.add({0}, {{Value(3)}});
+
+    QString error;
+    QVERIFY(a.save(error));
+    QFile f(a.filePath());
+    QVERIFY(f.open(QFile::ReadOnly));
+    QCOMPARE(QString::fromUtf8(f.readAll()),
+             QString("step,trials,x_mean,x_var,x_min,x_max\n0,2,2,2,1,3\n1,1,2,0,2,2\n"));
+    f.close();
+
+    a.clear();
+    QCOMPARE(a.numTrials(0), 0);
+
+    TrialsAggregator invalid(dir.filePath("missing/avg.csv"), {"x"});
+    QVERIFY(!invalid.save(error));
+    QVERIFY(!error.isEmpty());
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestTrialsAggregator)
+#include "tst_trialsaggregator.moc"
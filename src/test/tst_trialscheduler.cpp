@@ -0,0 +1,247 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <vector>
+
+#include <core/experiment.h>
+#include <core/project.h>
+#include <core/trial.h>
+#include <core/trialscheduler.h>
+
+namespace evoplex {
+class TestTrialScheduler: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void tst_fifo();
+    void tst_roundRobin();
+    void tst_shortestJobFirst();
+    void tst_setPolicy();
+    void tst_remove();
+    void tst_requeue();
+
+private:
+    ProjectPtr m_project;
+    std::vector<ExperimentPtr> m_exps;
+    std::vector<Trial*> m_trials; // i*10+j: the trial j of the experiment i
+
+    inline Trial* trial(int exp, int id) const
+    { return m_trials[static_cast<size_t>(exp * 10 + id)]; }
+
+    // runs the 'trials' with a single worker and returns the order
+    // they have been run; the gate trial blocks the worker until
+    // all trials are submitted
+    std::vector<Trial*> run(TrialScheduler::Policy policy, const std::vector<Trial*>& trials);
+};
+
+void TestTrialScheduler::initTestCase()
+{
+    // the experiments are only used to group the trials, and their
+    // stopAt (i.e., the trials' cost) is 30, 10 and 20 steps
+    m_project = std::make_shared<Project>(nullptr, 0);
+    for (int e = 0; e < 3; ++e) {
+        auto exp = std::make_shared<Experiment>(nullptr, e, m_project);
+        exp->setStopAt(e == 0 ? 30 : e * 10);
+        for (int t = 0; t < 10; ++t) {
+            m_trials.emplace_back(new Trial(static_cast<quint16>(t), exp));
+        }
+        m_exps.emplace_back(exp);
+    }
+}
+
+void TestTrialScheduler::cleanupTestCase()
+{
+    for (Trial* t : m_trials) {
+        delete t;
+    }
+}
+
+std::vector<Trial*> TestTrialScheduler::run(TrialScheduler::Policy policy,
+                                            const std::vector<Trial*>& trials)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+
+    Trial* gate = trial(2, 9);
+    QSemaphore started;
+    QSemaphore proceed;
+    std::vector<Trial*> order;
+    TrialScheduler scheduler(&pool, 1, [&](Trial* t) {
+        if (t == gate) {
+            started.release();
+            proceed.acquire();
+        } else {
+            order.emplace_back(t);
+        }
+        return false;
+    });
+    scheduler.setPolicy(policy);
+
+    scheduler.submit({gate});
+    started.acquire();
+    scheduler.submit(trials);
+    proceed.release();
+    pool.waitForDone();
+    return order;
+}
+
+void TestTrialScheduler::tst_fifo()
+{
+    const std::vector<Trial*> trials = {
+        trial(0,0), trial(1,0), trial(0,1), trial(2,0), trial(0,2), trial(1,1) };
+    QCOMPARE(run(TrialScheduler::Policy::FIFO, trials), trials);
+}
+
+void TestTrialScheduler::tst_roundRobin()
+{
+    // one trial of each experiment in turn, starting from the first submitted
+    const std::vector<Trial*> trials = {
+        trial(1,0), trial(0,0), trial(0,1), trial(0,2), trial(1,1), trial(2,0) };
+    const std::vector<Trial*> expected = {
+        trial(1,0), trial(0,0), trial(2,0), trial(1,1), trial(0,1), trial(0,2) };
+    QCOMPARE(run(TrialScheduler::Policy::RoundRobin, trials), expected);
+}
+
+void TestTrialScheduler::tst_shortestJobFirst()
+{
+    // the trials with the same cost keep their order
+    const std::vector<Trial*> trials = {
+        trial(0,0), trial(1,0), trial(0,1), trial(2,0), trial(1,1), trial(2,1) };
+    const std::vector<Trial*> expected = {
+        trial(1,0), trial(1,1), trial(2,0), trial(2,1), trial(0,0), trial(0,1) };
+    QCOMPARE(run(TrialScheduler::Policy::ShortestJobFirst, trials), expected);
+}
+
+void TestTrialScheduler::tst_setPolicy()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+
+    Trial* gate = trial(2, 9);
+    QSemaphore started;
+    QSemaphore proceed;
+    std::vector<Trial*> order;
+    TrialScheduler scheduler(&pool, 1, [&](Trial* t) {
+        if (t == gate) {
+            started.release();
+            proceed.acquire();
+        } else {
+            order.emplace_back(t);
+        }
+        return false;
+    });
+
+    // the queued trials are re-ordered by the new policy
+    scheduler.submit({gate});
+    started.acquire();
+    scheduler.submit({trial(0,0), trial(2,0), trial(1,0)});
+    scheduler.setPolicy(TrialScheduler::Policy::ShortestJobFirst);
+    QCOMPARE(scheduler.policy(), TrialScheduler::Policy::ShortestJobFirst);
+    proceed.release();
+    pool.waitForDone();
+
+    const std::vector<Trial*> expected = {trial(1,0), trial(2,0), trial(0,0)};
+    QCOMPARE(order, expected);
+}
+
+void TestTrialScheduler::tst_remove()
+{
+    for (auto policy : {TrialScheduler::Policy::FIFO,
+                        TrialScheduler::Policy::RoundRobin,
+                        TrialScheduler::Policy::ShortestJobFirst}) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(1);
+
+        Trial* gate = trial(2, 9);
+        QSemaphore started;
+        QSemaphore proceed;
+        std::vector<Trial*> order;
+        TrialScheduler scheduler(&pool, 1, [&](Trial* t) {
+            if (t == gate) {
+                started.release();
+                proceed.acquire();
+            } else {
+                order.emplace_back(t);
+            }
+            return false;
+        });
+        scheduler.setPolicy(policy);
+
+        scheduler.submit({gate});
+        started.acquire();
+        scheduler.submit({trial(0,0), trial(1,0), trial(0,1), trial(1,1), trial(0,2)});
+
+        // only the queued trials of the experiment are removed
+        QCOMPARE(scheduler.remove(m_exps[0].get()), 3);
+        QCOMPARE(scheduler.remove(m_exps[0].get()), 0);
+        QCOMPARE(scheduler.remove(m_exps[2].get()), 0); // the gate is running
+        proceed.release();
+        pool.waitForDone();
+
+        const std::vector<Trial*> expected = {trial(1,0), trial(1,1)};
+        QCOMPARE(order, expected);
+    }
+
+    // the deferred trials are removed as well
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    std::vector<Trial*> order;
+    TrialScheduler scheduler(&pool, 1,
+        [&order](Trial* t) { order.emplace_back(t); return false; },
+        [this](Trial* t) { return t != trial(1,0); });
+    scheduler.submit({trial(0,0), trial(1,0), trial(0,1)});
+    pool.waitForDone();
+    QCOMPARE(order, std::vector<Trial*>({trial(0,0), trial(0,1)}));
+    QCOMPARE(scheduler.remove(m_exps[1].get()), 1);
+    scheduler.wakeUp();
+    pool.waitForDone();
+    QCOMPARE(order.size(), size_t(2));
+}
+
+void TestTrialScheduler::tst_requeue()
+{
+    // a trial which yields goes back to the injection queue,
+    // i.e., after the other trials in the FIFO policy
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    std::vector<Trial*> order;
+    int slices = 0;
+    TrialScheduler scheduler(&pool, 1, [&](Trial* t) {
+        order.emplace_back(t);
+        return t == trial(0,0) && ++slices < 3;
+    });
+    scheduler.submit({trial(0,0), trial(0,1), trial(1,0)});
+    pool.waitForDone();
+
+    const std::vector<Trial*> expected = {
+        trial(0,0), trial(0,1), trial(1,0), trial(0,0), trial(0,0) };
+    QCOMPARE(order, expected);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestTrialScheduler)
+#include "tst_trialscheduler.moc"
@@ -0,0 +1,235 @@
+/**
+ *  This file is part of Evoplex.
+ *
+ *  Evoplex is a multi-agent system for networks.
+ *  Copyright (C) 2018 - Marcos Cardinot <marcos@cardinot.net>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtTest>
+#include <QThread>
+#include <vector>
+
+#include <core/experiment.h>
+#include <core/mainapp.h>
+#include <core/nodes_p.h>
+#include <core/project.h>
+#include <core/trial.h>
+#include <core/include/abstractgraph.h>
+#include <core/include/abstractmodel.h>
+
+namespace evoplex {
+
+// a graph with the nodes given by the test
+class UpdatesGraph: public AbstractGraph
+{
+public:
+    UpdatesGraph(Trial* trial, const Nodes& nodes)
+    { m_trial = trial; m_nodes = nodes; }
+    bool reset() override { return true; }
+};
+
+// records the events of each node
+class UpdatesModel: public AbstractModel
+{
+public:
+    std::vector<double> rates;
+    std::vector<int> events;
+    int numSteps = 0;
+    int numLoops = 0; // calls to beforeLoop()
+    int numLoopsEnded = 0; // calls to afterLoop()
+    unsigned long stepTime = 0; // msecs
+
+    UpdatesModel(Trial* trial, UpdateMode mode, const std::vector<double>& r)
+        : rates(r), events(r.size(), 0)
+    { m_trial = trial; setUpdateMode(mode); }
+
+    void beforeLoop() override { ++numLoops; }
+    void afterLoop() override { ++numLoopsEnded; }
+    bool algorithmStep() override
+    { ++numSteps; QThread::msleep(stepTime); return true; }
+    double nodeRate(int nodeIdx) const override
+    { return rates[static_cast<size_t>(nodeIdx)]; }
+    void nodeEvent(int nodeIdx) override
+    { ++events[static_cast<size_t>(nodeIdx)]; }
+};
+
+class TestUpdateModes: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void tst_randomSequential();
+    void tst_gillespie();
+    void tst_gillespieNoEvents();
+    void tst_slices();
+
+private:
+    MainApp* m_mainApp;
+    ExperimentPtr m_exp;
+
+    // the trial owns the graph, the model and the PRG
+    UpdatesModel* newTrial(Trial& trial, UpdateMode mode, const std::vector<double>& rates);
+};
+
+void TestUpdateModes::initTestCase()
+{
+    // the trials only need an experiment to belong to
+    m_mainApp = new MainApp();
+    m_exp = std::make_shared<Experiment>(m_mainApp, 0, std::make_shared<Project>(m_mainApp, 0));
+}
+
+void TestUpdateModes::cleanupTestCase()
+{
+    m_exp.reset();
+    delete m_mainApp;
+}
+
+UpdatesModel* TestUpdateModes::newTrial(Trial& trial, UpdateMode mode,
+                                        const std::vector<double>& rates)
+{
+    QString error;
+    const QString cmd = QString("*%1;min").arg(rates.size());
+    Nodes nodes = NodesPrivate::fromCmd(cmd, AttributesScope(), GraphType::Undirected, error);
+    trial.m_prg = new PRG(123);
+    trial.m_graph = new UpdatesGraph(&trial, nodes);
+    trial.m_graph->freezeTopology();
+    auto model = new UpdatesModel(&trial, mode, rates);
+    trial.m_model = model;
+    trial.m_step = 0;
+    return model;
+}
+
+void TestUpdateModes::tst_randomSequential()
+{
+    Trial trial(0, m_exp);
+    UpdatesModel* model = newTrial(trial, UpdateMode::RandomSequential,
+                                   std::vector<double>(10, 1.0));
+    model->initUpdates();
+
+    // one sweep per step: N events on nodes picked at random
+    int total = 0;
+    for (int step = 1; step <= 100; ++step) {
+        QVERIFY(model->runStep());
+        trial.m_step = step;
+        total = 0;
+        for (int e : model->events) {
+            total += e;
+        }
+        QCOMPARE(total, step * 10);
+        QCOMPARE(model->numSteps, step);
+        QCOMPARE(model->time(), static_cast<double>(step));
+    }
+    // all nodes are picked
+    for (int e : model->events) {
+        QVERIFY(e > 0);
+    }
+}
+
+void TestUpdateModes::tst_gillespie()
+{
+    Trial trial(0, m_exp);
+    const std::vector<double> rates = {1.0, 2.0, 3.0, 4.0, 0.0};
+    UpdatesModel* model = newTrial(trial, UpdateMode::Gillespie, rates);
+    model->initUpdates();
+
+    // each step covers one unit of time
+    const int numSteps = 2000;
+    for (int step = 0; step < numSteps; ++step) {
+        QVERIFY(model->runStep());
+        QCOMPARE(model->m_time, static_cast<double>(step + 1));
+        QCOMPARE(model->numSteps, step + 1);
+        trial.m_step = step + 1;
+    }
+
+    // the number of events is a Poisson process with rate 10 (sd ~141)
+    int total = 0;
+    for (int e : model->events) {
+        total += e;
+    }
+    QVERIFY(std::abs(total - 10 * numSteps) < 5 * 141);
+
+    // and the nodes are picked in proportion to their rates
+    for (size_t i = 0; i < rates.size(); ++i) {
+        const double freq = model->events[i] / static_cast<double>(total);
+        QVERIFY(std::abs(freq - rates[i] / 10.0) < 0.01);
+    }
+    QCOMPARE(model->events.back(), 0);
+}
+
+void TestUpdateModes::tst_gillespieNoEvents()
+{
+    Trial trial(0, m_exp);
+    UpdatesModel* model = newTrial(trial, UpdateMode::Gillespie, std::vector<double>(3, 0.0));
+    model->initUpdates();
+
+    // nothing can happen, so it stops at the end of the step
+    QVERIFY(!model->runStep());
+    QCOMPARE(model->m_time, 1.0);
+    QCOMPARE(model->numSteps, 1);
+    QCOMPARE(model->events, std::vector<int>(3, 0));
+}
+
+void TestUpdateModes::tst_slices()
+{
+    const int numSteps = 20;
+    m_exp->setStopAt(numSteps);
+    m_exp->setPauseAt(numSteps);
+
+    // the whole loop in a single run
+    Trial whole(0, m_exp);
+    UpdatesModel* wholeModel = newTrial(whole, UpdateMode::RandomSequential,
+                                        std::vector<double>(10, 1.0));
+    wholeModel->stepTime = 2;
+    whole.m_status = Status::Running;
+    QVERIFY(whole.runSteps(0));
+    QVERIFY(whole.m_status == Status::Running);
+    QCOMPARE(whole.m_step, numSteps);
+
+    // the same loop yielding every msec; the trial keeps its state
+    // between the slices, so it ends up exactly where the whole run did
+    Trial sliced(0, m_exp);
+    UpdatesModel* model = newTrial(sliced, UpdateMode::RandomSequential,
+                                   std::vector<double>(10, 1.0));
+    model->stepTime = 2;
+    int slices = 0;
+    int lastStep = sliced.m_step;
+    do {
+        sliced.m_status = Status::Running;
+        QVERIFY(sliced.runSteps(1));
+        ++slices;
+        QVERIFY(sliced.m_step > lastStep);
+        lastStep = sliced.m_step;
+        QCOMPARE(model->numSteps, sliced.m_step);
+        QCOMPARE(sliced.m_inLoop, sliced.m_status == Status::Queued);
+    } while (sliced.m_status == Status::Queued);
+
+    QVERIFY(slices > 1);
+    QCOMPARE(sliced.m_step, numSteps);
+    QCOMPARE(model->events, wholeModel->events);
+
+    // the loop spans all the slices
+    QCOMPARE(model->numLoops, 1);
+    QCOMPARE(model->numLoopsEnded, 1);
+    QCOMPARE(wholeModel->numLoops, 1);
+    QCOMPARE(wholeModel->numLoopsEnded, 1);
+}
+
+} // evoplex
+QTEST_MAIN(evoplex::TestUpdateModes)
+#include "tst_updatemodes.moc"
@@ -38,6 +38,7 @@ private slots:
     void tst_valueInt();
     void tst_valueChar();
     void tst_valueString();
+    void tst_valueStream();
 };
 
 void TestValue::tst_valueInvalid()
@@ -339,5 +340,38 @@ void TestValue::tst_valueString()
     QCOMPARE(vCopy2, Value(""));
 }
 
+void TestValue::tst_valueStream()
+{
+    const std::vector<Value> values = { Value(), Value(true), Value(false),
+        Value(1.23456789012345), Value(-7), Value('x'), Value("abc£ãã&"), Value("") };
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    for (const Value& v : values) {
+        out << v;
+    }
+
+    QDataStream in(data);
+    for (const Value& v : values) {
+        Value read;
+        in >> read;
+        QCOMPARE(read.type(), v.type());
+        if (v.isValid()) {
+            QCOMPARE(read, v);
+        }
+    }
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QVERIFY(in.atEnd());
+
+    // unknown type
+    QByteArray corrupted;
+    QDataStream out2(&corrupted, QIODevice::WriteOnly);
+    out2 << static_cast<quint8>(255);
+    QDataStream in2(corrupted);
+    Value read;
+    in2 >> read;
+    QCOMPARE(in2.status(), QDataStream::ReadCorruptData);
+}
+
 QTEST_MAIN(TestValue)
 #include "tst_value.moc"